@@ -0,0 +1,315 @@
+// benchmark.cpp
+// OOP in c++ project: Logic Circuits
+// Dominic Bradley (last modified: 18/10/26)
+// Times the main circuit operations on generated circuits, so performance can be compared between versions.
+// Each benchmark builds its circuit with add_element, then times changing inputs, generating output formulae,
+// printing the truth table (with printing discarded) and destroying the circuit.
+// changing inputs is also timed while a waveform of every signal is recorded, and while the values
+// are published to a value_reader, to show their overheads.
+// Every measurement is repeated, after one untimed warm-up run, and the median is reported.
+// The static_circuit checks are run first, as timings of a simulator giving wrong answers mean nothing.
+//
+// usage: logic_circuit_benchmark [--repetitions n] [--seed n] [--filter text] [--csv file] [--label text]
+
+#include <string>
+#include <memory>
+#include <iostream>
+#include <fstream>
+#include <iomanip>
+#include <vector>
+#include <functional>
+#include <algorithm>
+#include <chrono>
+#include <random>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include "circuit.h"
+#include "elements.h"
+#include "vcd_writer.h"
+#include "value_buffers.h"
+#include "circuit_generators.h"
+#include "static_circuit_checks.h"
+
+
+// a generated circuit and the operations that are practical on it
+// formulae are only generated for circuits whose formulae stay small (they grow exponentially
+// with reconvergent fanout), and truth tables only for circuits with few inputs
+struct benchmark_case
+{
+    std::string name;
+    std::function<void(circuit&, const std::uint32_t&)> generate;
+    int number_of_input_changes;
+    bool has_formula;
+    bool has_truth_table;
+    bool has_waveform;      // also times changing inputs while recording a waveform and publishing values
+};
+
+// file the waveform benchmarks write to, deleted after each run
+const char* const waveform_file_name{ "benchmark_waveform.vcd" };
+
+
+// timings of one operation over every repetition
+struct measurement
+{
+    std::string operation;
+    double operations;          // operations done per repetition, eg. elements added or inputs changed
+    std::vector<double> seconds;
+};
+
+
+// discards everything written to it, so printing can be timed without filling the terminal
+class null_buffer : public std::streambuf
+{
+protected:
+    int overflow(int character) override { return character; }
+    std::streamsize xsputn(const char*, std::streamsize count) override { return count; }
+};
+
+
+std::vector<benchmark_case> get_benchmark_cases()
+{
+    return {
+        { "ripple_adder_6", [](circuit& c, const std::uint32_t& s) { generate_ripple_carry_adder(c, 6, s); }, 2000, true, true, false },
+        { "ripple_adder_256", [](circuit& c, const std::uint32_t& s) { generate_ripple_carry_adder(c, 256, s); }, 2000, true, false, true },
+        { "lookahead_adder_6", [](circuit& c, const std::uint32_t& s) { generate_carry_lookahead_adder(c, 6, s); }, 2000, true, true, false },
+        { "lookahead_adder_256", [](circuit& c, const std::uint32_t& s) { generate_carry_lookahead_adder(c, 256, s); }, 2000, true, false, false },
+        { "array_multiplier_4", [](circuit& c, const std::uint32_t& s) { generate_array_multiplier(c, 4, s); }, 2000, true, true, false },
+        { "array_multiplier_32", [](circuit& c, const std::uint32_t& s) { generate_array_multiplier(c, 32, s); }, 500, false, false, false },
+        { "parity_tree_14", [](circuit& c, const std::uint32_t& s) { generate_parity_tree(c, 14, s); }, 2000, true, true, false },
+        { "parity_tree_65536", [](circuit& c, const std::uint32_t& s) { generate_parity_tree(c, 65536, s); }, 2000, true, false, false },
+        { "multiplexer_3", [](circuit& c, const std::uint32_t& s) { generate_multiplexer(c, 3, s); }, 2000, true, true, false },
+        { "multiplexer_16", [](circuit& c, const std::uint32_t& s) { generate_multiplexer(c, 16, s); }, 2000, true, false, false },
+        { "random_dag_10k_depth_20", [](circuit& c, const std::uint32_t& s) { generate_random_dag(c, 64, 10000, 20, s); }, 200, false, false, true },
+        { "random_dag_200k_depth_200", [](circuit& c, const std::uint32_t& s) { generate_random_dag(c, 256, 200000, 200, s); }, 20, false, false, true },
+    };
+}
+
+
+// runs one benchmark case repetitions + 1 times (the first run is not timed)
+std::vector<measurement> run_benchmark(const benchmark_case& test_case, const int& repetitions, const std::uint32_t& seed)
+{
+    using clock = std::chrono::steady_clock;
+    auto seconds_since = [](const clock::time_point& start_time) {
+        return std::chrono::duration<double>(clock::now() - start_time).count();
+    };
+
+    std::vector<measurement> measurements{ { "construct", 0, {} }, { "change_input", 0, {} } };
+    if (test_case.has_waveform) {
+        measurements.push_back({ "change_input_vcd", 0, {} });
+        measurements.push_back({ "change_input_reader", 0, {} });
+    }
+    if (test_case.has_formula) {
+        measurements.push_back({ "formula", 0, {} });
+    }
+    if (test_case.has_truth_table) {
+        measurements.push_back({ "truth_table", 0, {} });
+    }
+    measurements.push_back({ "teardown", 0, {} });
+
+    null_buffer discarded_output;
+    std::streambuf* console_output{ std::cout.rdbuf() };
+
+    for (int repetition{ -1 }; repetition < repetitions; repetition++) {
+        std::vector<double> run_seconds;
+        std::unique_ptr<circuit> test_circuit(new circuit);
+
+        clock::time_point start_time{ clock::now() };
+        test_case.generate(*test_circuit, seed);
+        run_seconds.push_back(seconds_since(start_time));
+        int number_of_elements{ test_circuit->get_circuit_size() };
+
+        // the same inputs are changed in every repetition
+        std::vector<int> input_positions{ test_circuit->get_input_positions() };
+        std::mt19937 generator(seed);
+        std::vector<int> changed_inputs;
+        for (int i{}; i < test_case.number_of_input_changes; i++) {
+            changed_inputs.push_back(input_positions[generator() % input_positions.size()]);
+        }
+        start_time = clock::now();
+        for (const int& position : changed_inputs) {
+            test_circuit->change_input(position);
+        }
+        run_seconds.push_back(seconds_since(start_time));
+
+        // the same changes again, dumping after each one, with the file written by a background thread
+        if (test_case.has_waveform) {
+            start_time = clock::now();
+            vcd_writer waveform;
+            waveform.open(waveform_file_name, *test_circuit, {}, true);
+            for (size_t i{}; i < changed_inputs.size(); i++) {
+                test_circuit->change_input(changed_inputs[i]);
+                waveform.dump(i + 1);
+            }
+            waveform.close();
+            run_seconds.push_back(seconds_since(start_time));
+            std::remove(waveform_file_name);
+
+            // and with a reader taking a snapshot of the published values after each one
+            start_time = clock::now();
+            value_reader reader(*test_circuit);
+            for (const int& position : changed_inputs) {
+                test_circuit->change_input(position);
+                reader.take_snapshot();
+            }
+            run_seconds.push_back(seconds_since(start_time));
+        }
+
+        std::cout.rdbuf(&discarded_output);
+        if (test_case.has_formula) {
+            start_time = clock::now();
+            test_circuit->circuit_formula();
+            run_seconds.push_back(seconds_since(start_time));
+        }
+        if (test_case.has_truth_table) {
+            start_time = clock::now();
+            test_circuit->circuit_truth_table();
+            run_seconds.push_back(seconds_since(start_time));
+        }
+        std::cout.rdbuf(console_output);
+
+        start_time = clock::now();
+        test_circuit.reset();
+        run_seconds.push_back(seconds_since(start_time));
+
+        // operations counted: elements added, inputs changed, elements covered by the formulae,
+        // truth table rows and elements destroyed
+        std::vector<double> operations{ static_cast<double>(number_of_elements),
+            static_cast<double>(changed_inputs.size()) };
+        if (test_case.has_waveform) {
+            operations.push_back(static_cast<double>(changed_inputs.size()));
+            operations.push_back(static_cast<double>(changed_inputs.size()));
+        }
+        if (test_case.has_formula) {
+            operations.push_back(static_cast<double>(number_of_elements));
+        }
+        if (test_case.has_truth_table) {
+            operations.push_back(std::pow(2.0, static_cast<double>(input_positions.size())));
+        }
+        operations.push_back(static_cast<double>(number_of_elements));
+
+        if (repetition >= 0) {
+            for (size_t i{}; i < measurements.size(); i++) {
+                measurements[i].operations = operations[i];
+                measurements[i].seconds.push_back(run_seconds[i]);
+            }
+        }
+    }
+    return measurements;
+}
+
+
+double get_median(std::vector<double> values)
+{
+    std::sort(values.begin(), values.end());
+    size_t middle{ values.size() / 2 };
+    return values.size() % 2 == 1 ? values[middle] : (values[middle - 1] + values[middle]) / 2;
+}
+
+double get_mean(const std::vector<double>& values)
+{
+    double sum{};
+    for (const double& value : values) {
+        sum += value;
+    }
+    return sum / values.size();
+}
+
+double get_standard_deviation(const std::vector<double>& values)
+{
+    double mean{ get_mean(values) };
+    double sum_of_squares{};
+    for (const double& value : values) {
+        sum_of_squares += (value - mean) * (value - mean);
+    }
+    return values.size() > 1 ? std::sqrt(sum_of_squares / (values.size() - 1)) : 0;
+}
+
+
+int main(int argc, char* argv[])
+{
+    int repetitions{ 5 };
+    std::uint32_t seed{ 1 };
+    std::string filter;
+    std::string csv_file_name;
+    std::string label{ "current" };
+
+    for (int i{ 1 }; i < argc; i++) {
+        std::string argument{ argv[i] };
+        bool has_value{ i + 1 < argc };
+
+        if (argument == "--repetitions" && has_value) {
+            repetitions = std::max(1, std::stoi(argv[++i]));
+        }
+        else if (argument == "--seed" && has_value) {
+            seed = static_cast<std::uint32_t>(std::stoul(argv[++i]));
+        }
+        else if (argument == "--filter" && has_value) {
+            filter = argv[++i];
+        }
+        else if (argument == "--csv" && has_value) {
+            csv_file_name = argv[++i];
+        }
+        else if (argument == "--label" && has_value) {
+            label = argv[++i];
+        }
+        else {
+            std::cerr << "\nError: unknown argument '" << argument << "'\n"
+                << "usage: logic_circuit_benchmark [--repetitions n] [--seed n] [--filter text]"
+                << " [--csv file] [--label text]\n";
+            return 1;
+        }
+    }
+
+    // rows are appended, so results from several versions can be kept in one file
+    std::ofstream csv_file;
+    if (!csv_file_name.empty()) {
+        bool is_new_file{ !std::ifstream(csv_file_name) };
+        csv_file.open(csv_file_name, std::ios::app);
+        if (!csv_file) {
+            std::cerr << "\nError: could not write to '" << csv_file_name << "'\n";
+            return 1;
+        }
+        if (is_new_file) {
+            csv_file << "label,benchmark,operation,operations,repetitions,median_seconds,min_seconds,"
+                << "mean_seconds,standard_deviation_seconds,operations_per_second\n";
+        }
+    }
+
+    circuit_element::show_destruction_messages(false);
+    if (!check_static_circuits()) {
+        return 1;
+    }
+    std::cout << "Logic Circuit Simulator benchmarks (" << repetitions << " repetitions, seed " << seed << ")\n\n"
+        << std::left << std::setw(28) << "benchmark" << std::setw(21) << "operation"
+        << std::right << std::setw(12) << "median ms" << std::setw(12) << "min ms"
+        << std::setw(9) << "+/- %" << std::setw(16) << "ops/sec" << "\n";
+
+    for (const benchmark_case& test_case : get_benchmark_cases()) {
+        if (test_case.name.find(filter) == std::string::npos) {
+            continue;
+        }
+
+        for (const measurement& result : run_benchmark(test_case, repetitions, seed)) {
+            double median{ get_median(result.seconds) };
+            double minimum{ *std::min_element(result.seconds.begin(), result.seconds.end()) };
+            double mean{ get_mean(result.seconds) };
+            double standard_deviation{ get_standard_deviation(result.seconds) };
+            double operations_per_second{ median > 0 ? result.operations / median : 0 };
+
+            std::cout << std::left << std::setw(28) << test_case.name << std::setw(21) << result.operation
+                << std::right << std::fixed << std::setprecision(3)
+                << std::setw(12) << median * 1000 << std::setw(12) << minimum * 1000
+                << std::setprecision(1) << std::setw(9) << (mean > 0 ? 100 * standard_deviation / mean : 0)
+                << std::setprecision(0) << std::setw(16) << operations_per_second << "\n";
+
+            if (csv_file.is_open()) {
+                csv_file << label << "," << test_case.name << "," << result.operation << ","
+                    << std::setprecision(0) << std::fixed << result.operations << "," << repetitions << ","
+                    << std::setprecision(9) << median << "," << minimum << "," << mean << "," << standard_deviation << ","
+                    << std::setprecision(1) << operations_per_second << "\n";
+            }
+        }
+    }
+    return 0;
+}
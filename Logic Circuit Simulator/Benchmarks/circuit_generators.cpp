@@ -0,0 +1,237 @@
+// circuit_generators.cpp (last modified: 18/10/26)
+// Contains definition of the circuit generators declared in circuit_generators.h
+
+#include <vector>
+#include <string>
+#include <random>
+#include <algorithm>
+#include <cstdint>
+#include "circuit_generators.h"
+#include "circuit.h"
+
+
+// a missing signal (eg. the carry into the first bit of a sum), treated as a constant 0
+const int no_signal{ -1 };
+
+
+// adds number_of_inputs inputs with random values and returns their positions
+static std::vector<int> add_inputs(circuit& target, const int& number_of_inputs, std::mt19937& generator)
+{
+    std::vector<int> positions;
+    for (int i{}; i < number_of_inputs; i++) {
+        target.add_element((generator() & 1) != 0);
+        positions.push_back(target.get_circuit_size() - 1);
+    }
+    return positions;
+}
+
+static int add_gate(circuit& target, const std::string& gate_type, const int& input)
+{
+    target.add_element(gate_type, input);
+    return target.get_circuit_size() - 1;
+}
+
+static int add_gate(circuit& target, const std::string& gate_type, const int& input1, const int& input2)
+{
+    target.add_element(gate_type, input1, input2);
+    return target.get_circuit_size() - 1;
+}
+
+// and/or gate over any number of inputs: one input needs no gate, two use a binary gate
+// and more use a wide gate such as AND4
+static int add_wide_gate(circuit& target, const std::string& base_type, const std::vector<int>& inputs)
+{
+    if (inputs.size() == 1) {
+        return inputs[0];
+    }
+    if (inputs.size() == 2) {
+        return add_gate(target, base_type, inputs[0], inputs[1]);
+    }
+    target.add_element(base_type + std::to_string(inputs.size()), inputs);
+    return target.get_circuit_size() - 1;
+}
+
+
+// adds bit1 + bit2 + carry_in, where any of bit2 and carry_in can be no_signal
+// a half adder is used when one of them is missing, and no gates when both are
+static void add_bits(circuit& target, const int& bit1, const int& bit2, const int& carry_in,
+    int& sum, int& carry_out)
+{
+    if (bit2 == no_signal && carry_in == no_signal) {
+        sum = bit1;
+        carry_out = no_signal;
+        return;
+    }
+    if (bit2 == no_signal || carry_in == no_signal) {
+        int other_bit{ bit2 == no_signal ? carry_in : bit2 };
+        sum = add_gate(target, "XOR", bit1, other_bit);
+        carry_out = add_gate(target, "AND", bit1, other_bit);
+        return;
+    }
+
+    int half_sum{ add_gate(target, "XOR", bit1, bit2) };
+    sum = add_gate(target, "XOR", half_sum, carry_in);
+    // gates are added in separate statements, as the order arguments are evaluated in
+    // is up to the compiler and would change the element positions
+    int carry_generated{ add_gate(target, "AND", bit1, bit2) };
+    int carry_propagated{ add_gate(target, "AND", half_sum, carry_in) };
+    carry_out = add_gate(target, "OR", carry_generated, carry_propagated);
+}
+
+
+void generate_ripple_carry_adder(circuit& target, const int& bits, const std::uint32_t& seed)
+{
+    std::mt19937 generator(seed);
+    std::vector<int> operand1{ add_inputs(target, bits, generator) };
+    std::vector<int> operand2{ add_inputs(target, bits, generator) };
+    int carry{ add_inputs(target, 1, generator)[0] };
+
+    for (int i{}; i < bits; i++) {
+        int sum{};
+        add_bits(target, operand1[i], operand2[i], carry, sum, carry);
+    }
+}
+
+
+// within a group, the carry into bit j + 1 is
+// g_j OR p_j g_(j-1) OR ... OR p_j ... p_0 c, where g and p are each bit's generate (a AND b)
+// and propagate (a XOR b) signals and c is the carry into the group
+void generate_carry_lookahead_adder(circuit& target, const int& bits, const std::uint32_t& seed)
+{
+    const int group_size{ 4 };
+    std::mt19937 generator(seed);
+    std::vector<int> operand1{ add_inputs(target, bits, generator) };
+    std::vector<int> operand2{ add_inputs(target, bits, generator) };
+    int group_carry{ add_inputs(target, 1, generator)[0] };
+
+    std::vector<int> generates;
+    std::vector<int> propagates;
+    for (int i{}; i < bits; i++) {
+        generates.push_back(add_gate(target, "AND", operand1[i], operand2[i]));
+        propagates.push_back(add_gate(target, "XOR", operand1[i], operand2[i]));
+    }
+
+    for (int group_start{}; group_start < bits; group_start += group_size) {
+        int group_end{ std::min(bits, group_start + group_size) };
+        int carry{ group_carry };
+
+        for (int j{ group_start }; j < group_end; j++) {
+            add_gate(target, "XOR", propagates[j], carry);
+
+            std::vector<int> carry_terms{ generates[j] };
+            for (int k{ j - 1 }; k >= group_start - 1; k--) {
+                std::vector<int> term_inputs(propagates.begin() + k + 1, propagates.begin() + j + 1);
+                term_inputs.push_back(k >= group_start ? generates[k] : group_carry);
+                carry_terms.push_back(add_wide_gate(target, "AND", term_inputs));
+            }
+            carry = add_wide_gate(target, "OR", carry_terms);
+        }
+        group_carry = carry;
+    }
+}
+
+
+// the running sum of the partial product rows so far is kept as bits-wide row plus a carry,
+// with one finished product bit dropping out of the bottom each row
+void generate_array_multiplier(circuit& target, const int& bits, const std::uint32_t& seed)
+{
+    std::mt19937 generator(seed);
+    std::vector<int> operand1{ add_inputs(target, bits, generator) };
+    std::vector<int> operand2{ add_inputs(target, bits, generator) };
+
+    std::vector<int> running_sum;
+    for (int j{}; j < bits; j++) {
+        running_sum.push_back(add_gate(target, "AND", operand1[j], operand2[0]));
+    }
+    int running_carry{ no_signal };
+
+    for (int i{ 1 }; i < bits; i++) {
+        std::vector<int> shifted_sum(running_sum.begin() + 1, running_sum.end());
+        shifted_sum.push_back(running_carry);
+
+        int carry{ no_signal };
+        for (int j{}; j < bits; j++) {
+            int partial_product{ add_gate(target, "AND", operand1[j], operand2[i]) };
+            if (shifted_sum[j] == no_signal) {
+                add_bits(target, partial_product, carry, no_signal, running_sum[j], carry);
+            }
+            else {
+                add_bits(target, shifted_sum[j], partial_product, carry, running_sum[j], carry);
+            }
+        }
+        running_carry = carry;
+    }
+}
+
+
+void generate_parity_tree(circuit& target, const int& number_of_inputs, const std::uint32_t& seed)
+{
+    std::mt19937 generator(seed);
+    std::vector<int> signals{ add_inputs(target, number_of_inputs, generator) };
+
+    while (signals.size() > 1) {
+        std::vector<int> next_signals;
+        for (size_t i{}; i + 1 < signals.size(); i += 2) {
+            next_signals.push_back(add_gate(target, "XOR", signals[i], signals[i + 1]));
+        }
+        if (signals.size() % 2 == 1) {
+            next_signals.push_back(signals.back());
+        }
+        signals = next_signals;
+    }
+}
+
+
+// each 2 to 1 multiplexer is (NOT s AND d0) OR (s AND d1)
+void generate_multiplexer(circuit& target, const int& select_bits, const std::uint32_t& seed)
+{
+    std::mt19937 generator(seed);
+    std::vector<int> signals{ add_inputs(target, 1 << select_bits, generator) };
+    std::vector<int> selects{ add_inputs(target, select_bits, generator) };
+
+    for (const int& select : selects) {
+        int inverted_select{ add_gate(target, "NOT", select) };
+        std::vector<int> next_signals;
+
+        for (size_t i{}; i < signals.size(); i += 2) {
+            int first_choice{ add_gate(target, "AND", inverted_select, signals[i]) };
+            int second_choice{ add_gate(target, "AND", select, signals[i + 1]) };
+            next_signals.push_back(add_gate(target, "OR", first_choice, second_choice));
+        }
+        signals = next_signals;
+    }
+}
+
+
+void generate_random_dag(circuit& target, const int& number_of_inputs, const int& number_of_gates,
+    const int& depth, const std::uint32_t& seed)
+{
+    const std::vector<std::string> gate_types{ "AND", "OR", "NAND", "NOR", "XOR", "XNOR", "NOT" };
+    std::mt19937 generator(seed);
+    add_inputs(target, number_of_inputs, generator);
+
+    // every level needs at least one gate
+    int number_of_levels{ std::min(depth, number_of_gates) };
+
+    // level l is the range of positions [level_starts[l], level_starts[l + 1])
+    std::vector<int> level_starts{ 0, number_of_inputs };
+
+    for (int level{ 1 }; level <= number_of_levels; level++) {
+        int gates_on_level{ number_of_gates * level / number_of_levels - number_of_gates * (level - 1) / number_of_levels };
+        int previous_start{ level_starts[level - 1] };
+        int previous_size{ level_starts[level] - previous_start };
+
+        for (int i{}; i < gates_on_level; i++) {
+            const std::string& gate_type{ gate_types[generator() % gate_types.size()] };
+            int input1{ previous_start + static_cast<int>(generator() % previous_size) };
+
+            if (gate_type == "NOT") {
+                add_gate(target, gate_type, input1);
+            }
+            else {
+                add_gate(target, gate_type, input1, static_cast<int>(generator() % level_starts[level]));
+            }
+        }
+        level_starts.push_back(target.get_circuit_size());
+    }
+}
@@ -0,0 +1,34 @@
+// circuit_generators.h (last modified: 18/10/26)
+// header file for declaration of the functions that build synthetic circuits for benchmarking
+// every generator adds its inputs first, then its gates with add_element, to an empty circuit.
+// input values and any random choices come from the seed, so the same arguments always give
+// exactly the same circuit
+
+#ifndef CIRCUIT_GENERATORS_H
+#define CIRCUIT_GENERATORS_H
+
+#include <cstdint>
+#include "circuit.h"
+
+
+// bits-bit adder (2 * bits + 1 inputs) built from a chain of full adders
+void generate_ripple_carry_adder(circuit& target, const int& bits, const std::uint32_t& seed);
+
+// bits-bit adder whose carries are looked ahead across groups of 4 bits with wide gates
+void generate_carry_lookahead_adder(circuit& target, const int& bits, const std::uint32_t& seed);
+
+// bits x bits multiplier: an array of and gates for the partial products, summed row by row
+void generate_array_multiplier(circuit& target, const int& bits, const std::uint32_t& seed);
+
+// balanced tree of xor gates over number_of_inputs inputs
+void generate_parity_tree(circuit& target, const int& number_of_inputs, const std::uint32_t& seed);
+
+// 2^select_bits to 1 multiplexer, built as a tree of 2 to 1 multiplexers
+void generate_multiplexer(circuit& target, const int& select_bits, const std::uint32_t& seed);
+
+// random gates spread evenly over depth levels; every gate reads one input from the level below it,
+// so the circuit has exactly the given depth (or number_of_gates levels, if that is fewer)
+void generate_random_dag(circuit& target, const int& number_of_inputs, const int& number_of_gates,
+    const int& depth, const std::uint32_t& seed);
+
+#endif
@@ -0,0 +1,62 @@
+// static_circuit_checks.cpp (last modified: 18/10/26)
+// Contains the compile-time checks of static_circuit.h, and definition of check_static_circuits
+
+#include <iostream>
+#include <vector>
+#include "static_circuit.h"
+#include "static_circuit_checks.h"
+
+
+// the full adder of static_circuit.h, and the same adder as two look-up tables
+// (sum is 1 on the rows with an odd number of 1s, carry on the rows with at least two)
+using a_xor_b = static_xor<static_input<0>, static_input<1>>;
+using full_adder = static_circuit<3, static_xor<a_xor_b, static_input<2>>,
+    static_or<static_and<static_input<0>, static_input<1>>, static_and<a_xor_b, static_input<2>>>>;
+using lut_full_adder = static_circuit<3, static_lut<0x96, static_input<0>, static_input<1>, static_input<2>>,
+    static_lut<0xe8, static_input<0>, static_input<1>, static_input<2>>>;
+
+static_assert(full_adder::evaluate(1, 0b011), "0 + 1 + 1 carries");
+static_assert(!full_adder::evaluate(0, 0b011), "0 + 1 + 1 has a sum bit of 0");
+static_assert(full_adder::evaluate(0, 0b111) && full_adder::evaluate(1, 0b111), "1 + 1 + 1 is 11");
+static_assert(full_adder::get_truth_table_word(0, 0) == 0x9696969696969696
+    && full_adder::get_truth_table_word(1, 0) == 0xe8e8e8e8e8e8e8e8,
+    "with 3 inputs the 8 rows repeat through the word, lowest row first");
+static_assert(full_adder::is_equivalent_to<lut_full_adder>(), "the look-up table adder is the same adder");
+static_assert(!full_adder::is_equivalent_to<static_circuit<3, static_xor<a_xor_b, static_input<2>>, a_xor_b>>(),
+    "a different carry is told apart");
+
+// a chain and a tree of the same 8-input and, whose truth tables take more than one word
+using and_chain = static_circuit<8, static_and<static_and<static_and<static_and<static_and<static_and<static_and<
+    static_input<0>, static_input<1>>, static_input<2>>, static_input<3>>, static_input<4>>, static_input<5>>,
+    static_input<6>>, static_input<7>>>;
+using and_tree = static_circuit<8, static_and<static_and<static_and<static_input<0>, static_input<1>>,
+    static_and<static_input<2>, static_input<3>>>, static_and<static_and<static_input<4>, static_input<5>>,
+    static_and<static_input<6>, static_input<7>>>>>;
+
+static_assert(and_chain::get_number_of_truth_table_words() == 4, "256 rows fill 4 words");
+static_assert(and_chain::evaluate(0, 255) && !and_chain::evaluate(0, 254), "only the last row is 1");
+static_assert(and_chain::is_equivalent_to<and_tree>(), "and is associative");
+
+
+// builds each description as a circuit and checks its simulated truth tables against the description's
+bool check_static_circuits()
+{
+    circuit adder;
+    circuit lut_adder;
+    circuit chain;
+    std::vector<int> adder_outputs{ full_adder::build_circuit(adder) };
+    std::vector<int> lut_adder_outputs{ lut_full_adder::build_circuit(lut_adder) };
+    std::vector<int> chain_outputs{ and_chain::build_circuit(chain) };
+
+    if (!full_adder::matches_circuit(adder, adder_outputs) || !full_adder::matches_circuit(lut_adder, lut_adder_outputs)
+            || !and_tree::matches_circuit(chain, chain_outputs)) {
+        std::cerr << "\nError: a circuit built from a static_circuit does not simulate as described\n";
+        return false;
+    }
+    // a description that does not match must be told apart too
+    if (lut_full_adder::matches_circuit(adder, std::vector<int>{ adder_outputs[1], adder_outputs[0] })) {
+        std::cerr << "\nError: matches_circuit accepted a circuit with its outputs swapped\n";
+        return false;
+    }
+    return true;
+}
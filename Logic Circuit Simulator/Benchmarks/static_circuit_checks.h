@@ -0,0 +1,11 @@
+// static_circuit_checks.h (last modified: 18/10/26)
+// header file for the checks of static_circuit.h compiled into the benchmarks
+// the constexpr checks are static_asserts, so a change that breaks them stops the benchmarks building;
+// the rest build each description as a circuit and simulate it, and are run before any benchmark
+
+#ifndef STATIC_CIRCUIT_CHECKS_H
+#define STATIC_CIRCUIT_CHECKS_H
+
+bool check_static_circuits();
+
+#endif
@@ -0,0 +1,277 @@
+// json_message.cpp (last modified: 18/10/26)
+// Contains definition of the json_value member and the functions declared in json_message.h
+
+#include <vector>
+#include <string>
+#include <sstream>
+#include <iomanip>
+#include <cmath>
+#include <cstdlib>
+#include <cstdint>
+#include "json_message.h"
+#include "universal_functions.h"
+
+
+// deeper nesting is refused, so a hostile message cannot exhaust the stack
+const int maximum_json_depth{ 64 };
+
+
+json_value::json_value() : type{ json_type::null_value }, boolean{ false }, number{ 0 }, text{}, items{}, members{} {}
+
+const json_value* json_value::find(const std::string& name) const
+{
+    for (const auto& member : members) {
+        if (member.first == name) {
+            return &member.second;
+        }
+    }
+    return nullptr;
+}
+
+
+// recursive descent over text, starting at position
+class json_parser
+{
+private:
+    const std::string& text;
+    size_t position;
+
+    void skip_spaces()
+    {
+        while (position < text.size() && (text[position] == ' ' || text[position] == '\t'
+                || text[position] == '\n' || text[position] == '\r')) {
+            position++;
+        }
+    }
+
+    bool fail(const std::string& message, std::string& error) const
+    {
+        error = message + " at character " + std::to_string(position + 1);
+        return false;
+    }
+
+    bool parse_literal(const std::string& literal)
+    {
+        if (text.compare(position, literal.size(), literal) != 0) {
+            return false;
+        }
+        position += literal.size();
+        return true;
+    }
+
+    bool parse_string(std::string& result, std::string& error)
+    {
+        position++;
+        while (position < text.size() && text[position] != '"') {
+            char character{ text[position++] };
+            if (character != '\\') {
+                result.push_back(character);
+                continue;
+            }
+            if (position >= text.size()) {
+                break;
+            }
+            char escaped{ text[position++] };
+            const std::string escapes{ "\"\\/bfnrt" };
+            const std::string replacements{ "\"\\/\b\f\n\r\t" };
+            size_t escape{ escapes.find(escaped) };
+
+            if (escape != std::string::npos) {
+                result.push_back(replacements[escape]);
+            }
+            else if (escaped == 'u' && position + 4 <= text.size()) {
+                // characters are written out as UTF-8 (surrogate pairs are not combined)
+                unsigned long code{ std::strtoul(text.substr(position, 4).c_str(), nullptr, 16) };
+                position += 4;
+                if (code < 0x80) {
+                    result.push_back(static_cast<char>(code));
+                }
+                else if (code < 0x800) {
+                    result.push_back(static_cast<char>(0xc0 | (code >> 6)));
+                    result.push_back(static_cast<char>(0x80 | (code & 0x3f)));
+                }
+                else {
+                    result.push_back(static_cast<char>(0xe0 | (code >> 12)));
+                    result.push_back(static_cast<char>(0x80 | ((code >> 6) & 0x3f)));
+                    result.push_back(static_cast<char>(0x80 | (code & 0x3f)));
+                }
+            }
+            else {
+                return fail("bad escape in string", error);
+            }
+        }
+        if (position >= text.size()) {
+            return fail("unterminated string", error);
+        }
+        position++;
+        return true;
+    }
+
+    bool parse_number(json_value& value, std::string& error)
+    {
+        const char* start{ text.c_str() + position };
+        char* end{ nullptr };
+        value.number = std::strtod(start, &end);
+        if (end == start) {
+            return fail("unexpected character", error);
+        }
+        value.type = json_type::number;
+        position += end - start;
+        return true;
+    }
+
+public:
+    json_parser(const std::string& set_text) : text{ set_text }, position{ 0 } {}
+
+    bool parse_value(json_value& value, const int& depth, std::string& error)
+    {
+        if (depth > maximum_json_depth) {
+            return fail("values nested too deeply", error);
+        }
+        skip_spaces();
+        if (position >= text.size()) {
+            return fail("unexpected end of message", error);
+        }
+
+        char first{ text[position] };
+        if (first == '{') {
+            value.type = json_type::object;
+            position++;
+            skip_spaces();
+            if (position < text.size() && text[position] == '}') {
+                position++;
+                return true;
+            }
+            while (true) {
+                skip_spaces();
+                if (position >= text.size() || text[position] != '"') {
+                    return fail("expected a member name", error);
+                }
+                std::string name;
+                if (!parse_string(name, error)) {
+                    return false;
+                }
+                skip_spaces();
+                if (position >= text.size() || text[position] != ':') {
+                    return fail("expected ':'", error);
+                }
+                position++;
+                value.members.push_back({ name, json_value() });
+                if (!parse_value(value.members.back().second, depth + 1, error)) {
+                    return false;
+                }
+                skip_spaces();
+                if (position < text.size() && text[position] == ',') {
+                    position++;
+                }
+                else if (position < text.size() && text[position] == '}') {
+                    position++;
+                    return true;
+                }
+                else {
+                    return fail("expected ',' or '}'", error);
+                }
+            }
+        }
+        if (first == '[') {
+            value.type = json_type::array;
+            position++;
+            skip_spaces();
+            if (position < text.size() && text[position] == ']') {
+                position++;
+                return true;
+            }
+            while (true) {
+                value.items.push_back(json_value());
+                if (!parse_value(value.items.back(), depth + 1, error)) {
+                    return false;
+                }
+                skip_spaces();
+                if (position < text.size() && text[position] == ',') {
+                    position++;
+                }
+                else if (position < text.size() && text[position] == ']') {
+                    position++;
+                    return true;
+                }
+                else {
+                    return fail("expected ',' or ']'", error);
+                }
+            }
+        }
+        if (first == '"') {
+            value.type = json_type::string;
+            return parse_string(value.text, error);
+        }
+        if (parse_literal("true") || parse_literal("false")) {
+            value.type = json_type::boolean;
+            value.boolean = first == 't';
+            return true;
+        }
+        if (parse_literal("null")) {
+            value.type = json_type::null_value;
+            return true;
+        }
+        return parse_number(value, error);
+    }
+
+    bool is_finished()
+    {
+        skip_spaces();
+        return position == text.size();
+    }
+};
+
+
+bool parse_json(const std::string& text, json_value& value, std::string& error)
+{
+    json_parser parser(text);
+    value = json_value();
+
+    if (!parser.parse_value(value, 0, error)) {
+        return false;
+    }
+    if (!parser.is_finished()) {
+        error = "unexpected text after the message";
+        return false;
+    }
+    return true;
+}
+
+
+std::string write_json(const json_value& value)
+{
+    switch (value.type) {
+    case json_type::boolean:
+        return value.boolean ? "true" : "false";
+    case json_type::number: {
+        std::stringstream number;
+        if (std::floor(value.number) == value.number && std::fabs(value.number) < 1e15) {
+            number << static_cast<std::int64_t>(value.number);
+        }
+        else {
+            number << std::setprecision(17) << value.number;
+        }
+        return number.str();
+    }
+    case json_type::string:
+        return get_json_string(value.text);
+    case json_type::array: {
+        std::string json{ "[" };
+        for (size_t i{}; i < value.items.size(); i++) {
+            json += (i > 0 ? "," : "") + write_json(value.items[i]);
+        }
+        return json + "]";
+    }
+    case json_type::object: {
+        std::string json{ "{" };
+        for (size_t i{}; i < value.members.size(); i++) {
+            json += (i > 0 ? "," : "") + get_json_string(value.members[i].first) + ":"
+                + write_json(value.members[i].second);
+        }
+        return json + "}";
+    }
+    default:
+        return "null";
+    }
+}
@@ -0,0 +1,41 @@
+// json_message.h (last modified: 18/10/26)
+// header file for the json_value struct and the functions that read and write JSON messages
+// used by the simulation server, whose requests and responses are one JSON object per line
+
+#ifndef JSON_MESSAGE_H
+#define JSON_MESSAGE_H
+
+#include <vector>
+#include <string>
+#include <utility>
+
+
+enum class json_type
+{
+    null_value, boolean, number, string, array, object
+};
+
+// any JSON value; only the members matching its type are used
+struct json_value
+{
+    json_type type;
+    bool boolean;
+    double number;
+    std::string text;
+    std::vector<json_value> items;
+    std::vector<std::pair<std::string, json_value>> members;
+
+    json_value();
+
+    // the value of an object member, or nullptr if there is no member with that name
+    const json_value* find(const std::string& name) const;
+};
+
+
+// returns false, with a description in error, if text is not exactly one JSON value
+bool parse_json(const std::string& text, json_value& value, std::string& error);
+
+// writes a value as compact JSON text
+std::string write_json(const json_value& value);
+
+#endif
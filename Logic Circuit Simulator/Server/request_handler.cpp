@@ -0,0 +1,345 @@
+// request_handler.cpp (last modified: 18/10/26)
+// Contains definition of the functions declared in request_handler.h
+
+#include <vector>
+#include <string>
+#include <memory>
+#include <sstream>
+#include <fstream>
+#include <algorithm>
+#include "request_handler.h"
+#include "json_message.h"
+#include "circuit.h"
+#include "netlist_reader.h"
+#include "module_definition.h"
+#include "memory_usage.h"
+#include "universal_functions.h"
+
+
+std::string get_request_circuit_name(const json_value& request)
+{
+    const json_value* name{ request.find("circuit") };
+    if (name == nullptr || name->type != json_type::string || name->text.empty()) {
+        return "default";
+    }
+    return name->text;
+}
+
+static std::string get_command(const json_value& request)
+{
+    const json_value* command{ request.find("command") };
+    return command != nullptr && command->type == json_type::string ? command->text : "";
+}
+
+bool is_heavy_request(const json_value& request)
+{
+    std::string command{ get_command(request) };
+    return command == "load" || command == "truth_table" || command == "formula";
+}
+
+
+static std::string get_response_start(const json_value& request, const bool& is_ok)
+{
+    const json_value* id{ request.find("id") };
+    return "{\"id\":" + (id != nullptr ? write_json(*id) : std::string("null"))
+        + ",\"ok\":" + (is_ok ? "true" : "false");
+}
+
+std::string get_error_response(const json_value& request, const std::string& message)
+{
+    return get_response_start(request, false) + ",\"error\":" + get_json_string(message) + "}";
+}
+
+std::string get_success_response(const json_value& request, const std::string& members)
+{
+    return get_response_start(request, true) + members + "}";
+}
+
+
+// the messages the simulator writes as "\nError: ...\n", joined into one line
+static std::string get_error_text(const std::string& printed_errors)
+{
+    std::string message;
+    std::stringstream lines(printed_errors);
+    std::string line;
+    while (std::getline(lines, line)) {
+        if (line.compare(0, 7, "Error: ") == 0) {
+            line.erase(0, 7);
+        }
+        if (!line.empty()) {
+            message += (message.empty() ? "" : "; ") + line;
+        }
+    }
+    return message;
+}
+
+// a JSON array of the names of the given elements
+static std::string get_names_json(const circuit& target, const std::vector<int>& element_positions)
+{
+    std::string json{ "[" };
+    for (size_t i{}; i < element_positions.size(); i++) {
+        json += (i > 0 ? "," : "") + get_json_string(target.get_element_name(element_positions[i]));
+    }
+    return json + "]";
+}
+
+// a JSON object of the values of the given elements, by name
+static std::string get_values_json(const circuit& target, const std::vector<int>& element_positions)
+{
+    std::string json{ "{" };
+    for (size_t i{}; i < element_positions.size(); i++) {
+        json += (i > 0 ? "," : "") + get_json_string(target.get_element_name(element_positions[i]))
+            + (target.get_element_output(element_positions[i]) ? ":1" : ":0");
+    }
+    return json + "}";
+}
+
+// the elements named by the request's "elements" array, or the circuit's outputs if there is none
+// returns false, with a message in error, if a name is not in the circuit
+static bool get_requested_elements(const json_value& request, const circuit& target,
+    std::vector<int>& element_positions, std::string& error)
+{
+    const json_value* names{ request.find("elements") };
+    if (names == nullptr) {
+        element_positions = target.get_output_positions();
+        return true;
+    }
+    if (names->type != json_type::array) {
+        error = "\"elements\" must be an array of element names";
+        return false;
+    }
+
+    element_positions.clear();
+    for (const json_value& name : names->items) {
+        int position{ name.type == json_type::string ? target.find_element(name.text) : -1 };
+        if (position == -1) {
+            error = "there is no element named " + write_json(name);
+            return false;
+        }
+        element_positions.push_back(position);
+    }
+    return true;
+}
+
+// reads a 0/1 or false/true value
+static bool get_bit_value(const json_value& value, bool& bit)
+{
+    if (value.type == json_type::boolean) {
+        bit = value.boolean;
+        return true;
+    }
+    if (value.type == json_type::number && (value.number == 0 || value.number == 1)) {
+        bit = value.number == 1;
+        return true;
+    }
+    return false;
+}
+
+
+// builds a new circuit from a netlist file ("file") or netlist text sent with the request ("netlist")
+// the circuit being replaced is kept if the netlist cannot be read; its memory budget carries over.
+// each circuit has a module library of its own, so clients can define modules of the same name
+static std::string load_circuit(const json_value& request, std::unique_ptr<circuit>& target)
+{
+    const json_value* file_name{ request.find("file") };
+    const json_value* netlist_text{ request.find("netlist") };
+    std::unique_ptr<circuit> loaded_circuit{ new circuit() };
+    loaded_circuit->set_module_library(std::make_shared<module_library>());
+    if (target) {
+        loaded_circuit->set_memory_budget(target->get_memory_budget());
+    }
+
+    std::stringstream errors;
+    bool is_loaded{ false };
+    if (netlist_text != nullptr && netlist_text->type == json_type::string) {
+        std::stringstream netlist(netlist_text->text);
+        is_loaded = read_netlist(netlist, "netlist", *loaded_circuit, errors);
+    }
+    else if (file_name != nullptr && file_name->type == json_type::string) {
+        std::ifstream netlist_file(file_name->text);
+        if (!netlist_file) {
+            return get_error_response(request, "could not open '" + file_name->text + "'");
+        }
+        is_loaded = read_netlist(netlist_file, file_name->text, *loaded_circuit, errors);
+    }
+    else {
+        return get_error_response(request, "load needs a \"file\" name or \"netlist\" text");
+    }
+
+    if (!is_loaded) {
+        std::string message{ get_error_text(errors.str()) };
+        return get_error_response(request, message.empty() ? "the netlist could not be read" : message);
+    }
+    target = std::move(loaded_circuit);
+    target->take_changed_outputs();
+
+    return get_success_response(request, ",\"elements\":" + std::to_string(target->get_circuit_size())
+        + ",\"inputs\":" + get_names_json(*target, target->get_input_positions())
+        + ",\"outputs\":" + get_names_json(*target, target->get_output_positions()));
+}
+
+
+// sets the inputs named in the request's "inputs" object, changing only those whose value differs,
+// and reports the outputs that changed as a result
+static std::string set_inputs(const json_value& request, circuit& target)
+{
+    const json_value* input_values{ request.find("inputs") };
+    if (input_values == nullptr || input_values->type != json_type::object) {
+        return get_error_response(request, "set_inputs needs an \"inputs\" object of input names and values");
+    }
+
+    // every name and value is checked before any input is changed
+    std::vector<int> input_positions{ target.get_input_positions() };
+    std::vector<std::pair<int, bool>> changes;
+    for (const auto& input : input_values->members) {
+        int position{ target.find_element(input.first) };
+        if (std::find(input_positions.begin(), input_positions.end(), position) == input_positions.end()) {
+            return get_error_response(request, "there is no input named " + get_json_string(input.first));
+        }
+        bool value{};
+        if (!get_bit_value(input.second, value)) {
+            return get_error_response(request, "the value of input " + get_json_string(input.first) + " must be 0 or 1");
+        }
+        changes.push_back({ position, value });
+    }
+
+    target.take_changed_outputs();
+    for (const auto& change : changes) {
+        if (target.get_element_output(change.first) != change.second) {
+            target.change_input(change.first);
+        }
+    }
+    return get_success_response(request, ",\"changed\":" + get_values_json(target, target.take_changed_outputs()));
+}
+
+
+// each requested element's truth table column as a string of 0s and 1s, one character per row
+// rows are in counting order, with the first input as the most significant bit
+static std::string get_truth_table(const json_value& request, circuit& target)
+{
+    std::vector<int> element_positions;
+    std::string error;
+    if (!get_requested_elements(request, target, element_positions, error)) {
+        return get_error_response(request, error);
+    }
+    std::vector<int> input_positions{ target.get_input_positions() };
+    if (input_positions.size() > maximum_server_truth_table_inputs) {
+        return get_error_response(request, "the circuit has " + std::to_string(input_positions.size())
+            + " inputs; truth tables are only sent for up to " + std::to_string(maximum_server_truth_table_inputs));
+    }
+
+    std::vector<std::vector<bool>> columns;
+    if (!target.get_truth_table(element_positions, columns)) {
+        return get_error_response(request, "the truth table is too large for the circuit's memory budget or the truth table memory limit");
+    }
+
+    std::string json{ ",\"inputs\":" + get_names_json(target, input_positions) + ",\"columns\":{" };
+    for (size_t i{}; i < element_positions.size(); i++) {
+        std::string column(columns[i].size(), '0');
+        for (size_t row{}; row < columns[i].size(); row++) {
+            if (columns[i][row]) {
+                column[row] = '1';
+            }
+        }
+        json += (i > 0 ? "," : "") + get_json_string(target.get_element_name(element_positions[i]))
+            + ":\"" + column + "\"";
+    }
+    return get_success_response(request, json + "}");
+}
+
+
+static std::string get_formulas(const json_value& request, const circuit& target)
+{
+    std::vector<int> element_positions;
+    std::string error;
+    if (!get_requested_elements(request, target, element_positions, error)) {
+        return get_error_response(request, error);
+    }
+
+    std::string json{ ",\"formulas\":{" };
+    for (size_t i{}; i < element_positions.size(); i++) {
+        json += (i > 0 ? "," : "") + get_json_string(target.get_element_name(element_positions[i])) + ":"
+            + get_json_string(target.get_element_formula(element_positions[i]));
+    }
+    return get_success_response(request, json + "}");
+}
+
+
+std::string handle_circuit_request(const json_value& request, std::unique_ptr<circuit>& target)
+{
+    std::string command{ get_command(request) };
+    if (command == "load") {
+        return load_circuit(request, target);
+    }
+    if (command.empty()) {
+        return get_error_response(request, "requests need a \"command\"");
+    }
+    if (!target) {
+        return get_error_response(request, "no circuit named " + get_json_string(get_request_circuit_name(request))
+            + " is loaded");
+    }
+
+    if (command == "unload") {
+        target.reset();
+        return get_success_response(request, "");
+    }
+
+    // the circuit's module instances are looked up in its own library
+    module_library_scope modules_scope(target->get_module_library());
+    if (command == "describe") {
+        return get_success_response(request, ",\"elements\":" + std::to_string(target->get_circuit_size())
+            + ",\"levels\":" + std::to_string(target->get_number_of_levels())
+            + ",\"inputs\":" + get_names_json(*target, target->get_input_positions())
+            + ",\"outputs\":" + get_names_json(*target, target->get_output_positions()));
+    }
+    if (command == "set_inputs") {
+        return set_inputs(request, *target);
+    }
+    if (command == "change_input") {
+        const json_value* name{ request.find("input") };
+        int position{ name != nullptr && name->type == json_type::string ? target->find_element(name->text) : -1 };
+        std::vector<int> input_positions{ target->get_input_positions() };
+        if (std::find(input_positions.begin(), input_positions.end(), position) == input_positions.end()) {
+            return get_error_response(request, "change_input needs the name of an \"input\"");
+        }
+        target->take_changed_outputs();
+        target->change_input(position);
+        return get_success_response(request, ",\"changed\":" + get_values_json(*target, target->take_changed_outputs()));
+    }
+    if (command == "get_outputs") {
+        return get_success_response(request, ",\"values\":" + get_values_json(*target, target->get_output_positions()));
+    }
+    if (command == "get_values") {
+        std::vector<int> element_positions;
+        std::string error;
+        if (!get_requested_elements(request, *target, element_positions, error)) {
+            return get_error_response(request, error);
+        }
+        return get_success_response(request, ",\"values\":" + get_values_json(*target, element_positions));
+    }
+    if (command == "truth_table") {
+        return get_truth_table(request, *target);
+    }
+    if (command == "formula") {
+        return get_formulas(request, *target);
+    }
+    if (command == "statistics") {
+        // the statistics are written over several lines, but responses must fit on one
+        json_value statistics;
+        std::string error;
+        if (!parse_json(target->get_statistics_json(), statistics, error)) {
+            return get_error_response(request, "the statistics could not be read: " + error);
+        }
+        return get_success_response(request, ",\"statistics\":" + write_json(statistics));
+    }
+    if (command == "set_memory_budget") {
+        const json_value* budget{ request.find("budget") };
+        std::size_t bytes{};
+        if (budget == nullptr || budget->type != json_type::string || !parse_memory_size(budget->text, bytes)) {
+            return get_error_response(request, "set_memory_budget needs a \"budget\" such as \"512M\" (\"0\" for none)");
+        }
+        target->set_memory_budget(bytes);
+        return get_success_response(request, "");
+    }
+    return get_error_response(request, "unknown command " + get_json_string(command));
+}
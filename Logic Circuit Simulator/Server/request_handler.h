@@ -0,0 +1,49 @@
+// request_handler.h (last modified: 18/10/26)
+// header file for the functions that answer the simulation server's requests about a circuit
+// each request is a JSON object with a "command" member, the name of the "circuit" it is about
+// ("default" if left out) and an optional "id", which is copied into the response so clients
+// can match responses to requests. responses have "ok": true, or "ok": false and an "error"
+//     load                {"file": path} or {"netlist": text}; replies with the inputs and outputs
+//     unload, describe
+//     set_inputs          {"inputs": {name: 0 or 1, ...}}; replies with the outputs that changed
+//     change_input        {"input": name}; the same reply
+//     get_outputs         replies with every output's value
+//     get_values          {"elements": [names]}
+//     truth_table         {"elements": [names]} (the outputs if left out); one string of 0s and 1s per element
+//     formula             {"elements": [names]} (the outputs if left out)
+//     statistics          the same object as get_statistics_json
+//     set_memory_budget   {"budget": "512M"}
+// the server itself answers "list", naming every loaded circuit
+
+#ifndef REQUEST_HANDLER_H
+#define REQUEST_HANDLER_H
+
+#include <string>
+#include <memory>
+#include "json_message.h"
+#include "circuit.h"
+
+
+// largest number of inputs of a circuit whose truth table can be asked for
+const int maximum_server_truth_table_inputs{ 20 };
+
+
+// the name of the circuit a request is about
+std::string get_request_circuit_name(const json_value& request);
+
+// whether a request may take long enough that it should be run on a worker thread,
+// so it does not hold up requests about other circuits
+bool is_heavy_request(const json_value& request);
+
+// answers a request about a circuit; target is null if no circuit has been loaded under
+// the request's name, and is replaced by the "load" command or released by "unload"
+// returns the response as one line of JSON, without the newline
+std::string handle_circuit_request(const json_value& request, std::unique_ptr<circuit>& target);
+
+// a response reporting that a request failed
+std::string get_error_response(const json_value& request, const std::string& message);
+
+// a successful response; members are extra JSON object members, each starting with ','
+std::string get_success_response(const json_value& request, const std::string& members);
+
+#endif
@@ -0,0 +1,480 @@
+// server.cpp
+// OOP in c++ project: Logic Circuits
+// Dominic Bradley (last modified: 18/10/26)
+// A resident simulation server, which keeps circuits loaded between requests so tools do not pay
+// for starting the simulator and rebuilding each circuit for every query.
+// Clients connect to a Unix domain socket and send requests as one JSON object per line; each
+// request gets one JSON line in response (see request_handler.h for the commands).
+// One thread waits on every socket with poll(). Quick requests are answered on that thread, while
+// loading netlists, truth tables and formulae are run by a pool of worker threads. Requests about
+// the same circuit are run one at a time in the order they arrived; requests about different
+// circuits run at the same time.
+//
+// usage: logic_circuit_server [--socket path] [--threads n]
+//
+// eg. {"id":1,"command":"load","circuit":"adder","file":"adder.net"}
+//     {"id":2,"command":"set_inputs","circuit":"adder","inputs":{"a":1,"b":0}}
+
+#include <string>
+#include <memory>
+#include <iostream>
+#include <vector>
+#include <deque>
+#include <map>
+#include <functional>
+#include <algorithm>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <cstring>
+#include <cstdlib>
+#include <cerrno>
+#include <csignal>
+#include <poll.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include "circuit.h"
+#include "elements.h"
+#include "json_message.h"
+#include "request_handler.h"
+
+
+// longest request line accepted; a longer one closes the connection
+const std::size_t maximum_request_length{ 64 * 1024 * 1024 };
+
+
+// written to by the signal handler to wake the poll() loop
+static int wake_pipe[2]{ -1, -1 };
+static volatile std::sig_atomic_t is_stopping{ 0 };
+
+static void stop_server(int)
+{
+    is_stopping = 1;
+    char wake{ 's' };
+    ssize_t written{ write(wake_pipe[1], &wake, 1) };
+    (void)written;
+}
+
+static void wake_event_loop()
+{
+    char wake{ 'w' };
+    ssize_t written{ write(wake_pipe[1], &wake, 1) };
+    (void)written;
+}
+
+static bool set_non_blocking(const int& file_descriptor)
+{
+    int flags{ fcntl(file_descriptor, F_GETFL, 0) };
+    return flags != -1 && fcntl(file_descriptor, F_SETFL, flags | O_NONBLOCK) != -1;
+}
+
+
+// runs heavy requests; each finished job leaves its response in finished_jobs and wakes the event loop
+class request_workers
+{
+public:
+    struct finished_job
+    {
+        int client_id;
+        std::string circuit_name;
+        std::string response;
+    };
+
+private:
+    std::vector<std::thread> workers;
+    std::deque<std::function<finished_job()>> waiting_jobs;
+    std::vector<finished_job> finished_jobs;
+    std::mutex job_mutex;
+    std::condition_variable job_signal;
+    bool is_closing;
+
+    void worker_loop()
+    {
+        std::unique_lock<std::mutex> lock(job_mutex);
+        while (true) {
+            job_signal.wait(lock, [this]() { return !waiting_jobs.empty() || is_closing; });
+            if (waiting_jobs.empty()) {
+                return;
+            }
+            std::function<finished_job()> job{ std::move(waiting_jobs.front()) };
+            waiting_jobs.pop_front();
+            lock.unlock();
+
+            finished_job result{ job() };
+
+            lock.lock();
+            finished_jobs.push_back(std::move(result));
+            wake_event_loop();
+        }
+    }
+
+public:
+    request_workers(const int& number_of_workers) : workers{}, waiting_jobs{}, finished_jobs{},
+        job_mutex{}, job_signal{}, is_closing{ false }
+    {
+        for (int i{}; i < number_of_workers; i++) {
+            workers.emplace_back(&request_workers::worker_loop, this);
+        }
+    }
+
+    // finishes every job already given before returning
+    ~request_workers()
+    {
+        {
+            std::lock_guard<std::mutex> lock(job_mutex);
+            is_closing = true;
+        }
+        job_signal.notify_all();
+        for (auto& worker : workers) {
+            worker.join();
+        }
+    }
+
+    void add_job(std::function<finished_job()> job)
+    {
+        {
+            std::lock_guard<std::mutex> lock(job_mutex);
+            waiting_jobs.push_back(std::move(job));
+        }
+        job_signal.notify_one();
+    }
+
+    std::vector<finished_job> take_finished_jobs()
+    {
+        std::lock_guard<std::mutex> lock(job_mutex);
+        std::vector<finished_job> jobs;
+        jobs.swap(finished_jobs);
+        return jobs;
+    }
+};
+
+
+struct client_connection
+{
+    int socket;
+    std::string received_text;
+    std::string response_text;
+    int unanswered_requests;
+    bool has_finished_sending;
+};
+
+struct queued_request
+{
+    int client_id;
+    json_value message;
+};
+
+// a loaded circuit and the requests waiting for it; is_busy while a worker has one of them
+struct resident_circuit
+{
+    std::unique_ptr<circuit> simulation;
+    std::deque<queued_request> waiting_requests;
+    bool is_busy;
+};
+
+
+class simulation_server
+{
+private:
+    int listening_socket;
+    std::map<int, client_connection> clients;
+    std::map<std::string, resident_circuit> circuits;
+    request_workers workers;
+    int next_client_id;
+
+    void send_response(const int& client_id, const std::string& response)
+    {
+        auto client = clients.find(client_id);
+        if (client == clients.end()) {
+            return;
+        }
+        client->second.response_text += response;
+        client->second.response_text.push_back('\n');
+        client->second.unanswered_requests--;
+    }
+
+    // starts the requests waiting for a circuit until one has to wait for a worker
+    void run_waiting_requests(const std::string& circuit_name)
+    {
+        auto entry = circuits.find(circuit_name);
+        resident_circuit& resident{ entry->second };
+
+        while (!resident.is_busy && !resident.waiting_requests.empty()) {
+            queued_request request{ std::move(resident.waiting_requests.front()) };
+            resident.waiting_requests.pop_front();
+
+            if (!is_heavy_request(request.message)) {
+                send_response(request.client_id, handle_circuit_request(request.message, resident.simulation));
+                continue;
+            }
+            // map entries do not move, and this one is not erased while it is busy
+            resident.is_busy = true;
+            std::unique_ptr<circuit>* simulation{ &resident.simulation };
+            auto shared_request = std::make_shared<queued_request>(std::move(request));
+            workers.add_job([simulation, shared_request, circuit_name]() {
+                return request_workers::finished_job{ shared_request->client_id, circuit_name,
+                    handle_circuit_request(shared_request->message, *simulation) };
+            });
+        }
+
+        if (!resident.is_busy && resident.waiting_requests.empty() && !resident.simulation) {
+            circuits.erase(entry);
+        }
+    }
+
+    void handle_request_line(const int& client_id, const std::string& line)
+    {
+        clients[client_id].unanswered_requests++;
+        json_value request;
+        std::string error;
+        if (!parse_json(line, request, error)) {
+            send_response(client_id, get_error_response(json_value(), "the request is not JSON: " + error));
+            return;
+        }
+        if (request.type != json_type::object) {
+            send_response(client_id, get_error_response(json_value(), "requests must be JSON objects"));
+            return;
+        }
+
+        const json_value* command{ request.find("command") };
+        if (command != nullptr && command->type == json_type::string && command->text == "list") {
+            // circuits still being loaded are listed too
+            std::string names;
+            for (const auto& entry : circuits) {
+                if (entry.second.is_busy || entry.second.simulation) {
+                    names += (names.empty() ? "" : ",") + get_json_string(entry.first);
+                }
+            }
+            send_response(client_id, get_success_response(request, ",\"circuits\":[" + names + "]"));
+            return;
+        }
+
+        std::string circuit_name{ get_request_circuit_name(request) };
+        resident_circuit& resident{ circuits[circuit_name] };
+        resident.waiting_requests.push_back({ client_id, std::move(request) });
+        run_waiting_requests(circuit_name);
+    }
+
+    void accept_clients()
+    {
+        while (true) {
+            int client_socket{ accept(listening_socket, nullptr, nullptr) };
+            if (client_socket == -1) {
+                return;
+            }
+            set_non_blocking(client_socket);
+            clients[next_client_id++] = { client_socket, "", "", 0, false };
+        }
+    }
+
+    // reads what the client has sent and handles each complete line
+    // returns false if the connection should be closed
+    bool receive_requests(const int& client_id)
+    {
+        char buffer[65536];
+        while (true) {
+            ssize_t received{ read(clients[client_id].socket, buffer, sizeof(buffer)) };
+            if (received == 0) {
+                clients[client_id].has_finished_sending = true;
+                break;
+            }
+            if (received < 0) {
+                if (errno == EINTR) {
+                    continue;
+                }
+                if (errno == EAGAIN || errno == EWOULDBLOCK) {
+                    break;
+                }
+                return false;
+            }
+            clients[client_id].received_text.append(buffer, received);
+        }
+
+        std::string& text{ clients[client_id].received_text };
+        std::size_t line_start{};
+        std::size_t line_end{ text.find('\n') };
+        while (line_end != std::string::npos) {
+            std::string line{ text.substr(line_start, line_end - line_start) };
+            if (!line.empty() && line.back() == '\r') {
+                line.pop_back();
+            }
+            if (line.find_first_not_of(" \t") != std::string::npos) {
+                handle_request_line(client_id, line);
+            }
+            line_start = line_end + 1;
+            line_end = text.find('\n', line_start);
+        }
+        text.erase(0, line_start);
+
+        if (text.size() > maximum_request_length) {
+            std::cerr << "\nError: client " << client_id << " sent a request longer than "
+                << maximum_request_length << " bytes\n";
+            return false;
+        }
+        return true;
+    }
+
+    // returns false if the connection should be closed
+    bool send_responses(const int& client_id)
+    {
+        client_connection& client{ clients[client_id] };
+        while (!client.response_text.empty()) {
+            ssize_t sent{ write(client.socket, client.response_text.data(), client.response_text.size()) };
+            if (sent < 0) {
+                if (errno == EINTR) {
+                    continue;
+                }
+                return errno == EAGAIN || errno == EWOULDBLOCK;
+            }
+            client.response_text.erase(0, sent);
+        }
+        return true;
+    }
+
+    void close_client(const int& client_id)
+    {
+        close(clients[client_id].socket);
+        clients.erase(client_id);
+    }
+
+public:
+    simulation_server(const int& set_listening_socket, const int& number_of_workers) :
+        listening_socket{ set_listening_socket }, clients{}, circuits{}, workers{ number_of_workers },
+        next_client_id{ 0 } {}
+
+    void run()
+    {
+        while (!is_stopping) {
+            std::vector<pollfd> watched{ { wake_pipe[0], POLLIN, 0 }, { listening_socket, POLLIN, 0 } };
+            std::vector<int> watched_clients;
+            for (const auto& client : clients) {
+                // a client that has stopped sending is only watched while it has responses to take
+                if (client.second.has_finished_sending && client.second.response_text.empty()) {
+                    continue;
+                }
+                short events{ static_cast<short>(client.second.has_finished_sending ? 0 : POLLIN) };
+                if (!client.second.response_text.empty()) {
+                    events |= POLLOUT;
+                }
+                watched.push_back({ client.second.socket, events, 0 });
+                watched_clients.push_back(client.first);
+            }
+
+            if (poll(watched.data(), watched.size(), -1) == -1) {
+                if (errno == EINTR) {
+                    continue;
+                }
+                std::cerr << "\nError: poll failed: " << std::strerror(errno) << "\n";
+                return;
+            }
+
+            if (watched[0].revents & POLLIN) {
+                char wakes[256];
+                while (read(wake_pipe[0], wakes, sizeof(wakes)) > 0) {}
+                for (auto& job : workers.take_finished_jobs()) {
+                    send_response(job.client_id, job.response);
+                    circuits[job.circuit_name].is_busy = false;
+                    run_waiting_requests(job.circuit_name);
+                }
+            }
+            if (watched[1].revents & POLLIN) {
+                accept_clients();
+            }
+
+            for (size_t i{}; i < watched_clients.size(); i++) {
+                int client_id{ watched_clients[i] };
+                short events{ watched[i + 2].revents };
+                bool is_open{ (events & POLLNVAL) == 0 };
+                if (is_open && (events & (POLLIN | POLLHUP | POLLERR))) {
+                    is_open = receive_requests(client_id);
+                }
+                if (is_open) {
+                    is_open = send_responses(client_id);
+                }
+                // a client that has stopped sending is closed once every request it sent is answered
+                const client_connection& client{ clients[client_id] };
+                if (is_open && client.has_finished_sending && client.unanswered_requests == 0
+                        && client.response_text.empty()) {
+                    is_open = false;
+                }
+                if (!is_open) {
+                    close_client(client_id);
+                }
+            }
+        }
+    }
+
+    ~simulation_server()
+    {
+        for (auto& client : clients) {
+            close(client.second.socket);
+        }
+    }
+};
+
+
+static void print_usage()
+{
+    std::cerr << "usage: logic_circuit_server [--socket path] [--threads n]\n";
+}
+
+
+int main(int argc, char* argv[])
+{
+    std::string socket_path{ "logic_circuit_simulator.sock" };
+    int number_of_workers{ static_cast<int>(std::thread::hardware_concurrency()) };
+
+    for (int i{ 1 }; i < argc; i++) {
+        std::string argument{ argv[i] };
+        if (argument == "--socket" && i + 1 < argc) {
+            socket_path = argv[++i];
+        }
+        else if (argument == "--threads" && i + 1 < argc) {
+            number_of_workers = std::atoi(argv[++i]);
+        }
+        else {
+            print_usage();
+            return 1;
+        }
+    }
+    number_of_workers = std::max(number_of_workers, 1);
+
+    sockaddr_un address{};
+    address.sun_family = AF_UNIX;
+    if (socket_path.size() >= sizeof(address.sun_path)) {
+        std::cerr << "\nError: the socket path '" << socket_path << "' is too long\n";
+        return 1;
+    }
+    std::strcpy(address.sun_path, socket_path.c_str());
+
+    int listening_socket{ socket(AF_UNIX, SOCK_STREAM, 0) };
+    unlink(socket_path.c_str());
+    if (listening_socket == -1 || bind(listening_socket, reinterpret_cast<sockaddr*>(&address), sizeof(address)) == -1
+            || listen(listening_socket, 128) == -1 || !set_non_blocking(listening_socket)) {
+        std::cerr << "\nError: could not listen on '" << socket_path << "': " << std::strerror(errno) << "\n";
+        return 1;
+    }
+    if (pipe(wake_pipe) == -1 || !set_non_blocking(wake_pipe[0]) || !set_non_blocking(wake_pipe[1])) {
+        std::cerr << "\nError: could not create the wake pipe: " << std::strerror(errno) << "\n";
+        return 1;
+    }
+
+    // a client that disconnects early must not stop the server
+    std::signal(SIGPIPE, SIG_IGN);
+    std::signal(SIGINT, stop_server);
+    std::signal(SIGTERM, stop_server);
+    circuit_element::show_destruction_messages(false);
+
+    std::cerr << "Serving circuits on '" << socket_path << "' with " << number_of_workers << " worker threads\n";
+    {
+        simulation_server server(listening_socket, number_of_workers);
+        server.run();
+    }
+
+    close(listening_socket);
+    unlink(socket_path.c_str());
+    std::cerr << "Server stopped\n";
+    return 0;
+}
@@ -0,0 +1,264 @@
+// activity_estimation.cpp (last modified: 18/10/26)
+// Contains definition of all activity_estimator class members not defined in activity_estimation.h
+
+#include <iostream>
+#include <fstream>
+#include <vector>
+#include <string>
+#include <random>
+#include <chrono>
+#include <algorithm>
+#include <bitset>
+#include <cmath>
+#include <cstdint>
+#include "activity_estimation.h"
+#include "circuit.h"
+#include "bit_matrix.h"
+#include "tracing.h"
+#include "universal_functions.h"
+
+
+// input probabilities are rounded to a multiple of 1 / 2^probability_bits
+const int probability_bits{ 16 };
+
+// the 95% confidence interval of an estimate is this many standard errors either side of it
+const double confidence_interval_width{ 1.96 };
+
+// convergence is only checked after this many cycles, so rare values have a chance to be seen
+const std::uint64_t minimum_activity_cycles{ 16384 };
+
+// cycles are simulated in batches of at most this many words, over all estimated elements
+const int batch_words{ 1 << 20 };
+const int maximum_batch_cycles{ 65536 };
+
+
+activity_estimator::activity_estimator() : target_error{ 0.001 }, maximum_cycles{ std::uint64_t{ 1 } << 26 },
+    estimated_positions{}, element_names{}, ones_counts{}, toggle_counts{}, last_words{},
+    number_of_cycles{ 0 }, has_converged{ false }, cycles_per_second{ 0 } {}
+
+
+// the largest error (see get_interval) the estimates must reach
+void activity_estimator::set_target_error(const double& error)
+{
+    target_error = error;
+}
+
+double activity_estimator::get_target_error() const
+{
+    return target_error;
+}
+
+void activity_estimator::set_maximum_cycles(const std::uint64_t& cycles)
+{
+    maximum_cycles = cycles;
+}
+
+
+// a word of 64 random bits, each 1 with the given probability (a multiple of 1 / 2^probability_bits).
+// the probability's binary digits are read from the lowest: OR with a fair random word halves the
+// chance of a 0, and AND halves the chance of a 1, so each digit adds half of itself to the chance so far
+static std::uint64_t get_random_word(std::mt19937_64& random_words, const std::uint32_t& probability)
+{
+    if (probability == 0) {
+        return 0;
+    }
+    if (probability >= (std::uint32_t{ 1 } << probability_bits)) {
+        return ~std::uint64_t{ 0 };
+    }
+    int lowest_digit{};
+    while (((probability >> lowest_digit) & 1) == 0) {
+        lowest_digit++;
+    }
+    std::uint64_t word{};
+    for (int digit{ lowest_digit }; digit < probability_bits; digit++) {
+        word = ((probability >> digit) & 1) ? (word | random_words()) : (word & random_words());
+    }
+    return word;
+}
+
+// how far a rate seen count times in trials trials can be from the true rate, with 95% confidence.
+// this is the Wilson score interval, as the usual rate +/- standard errors has no width when count is 0
+// or trials, so a rarely toggling element would seem exact before it had toggled at all. the Wilson
+// interval is not centred on count / trials, so the distance to its farther end is given
+static double get_interval(const std::uint64_t& count, const std::uint64_t& trials)
+{
+    if (trials == 0) {
+        return 1;
+    }
+    double rate{ static_cast<double>(count) / trials };
+    double z_squared{ confidence_interval_width * confidence_interval_width };
+    double centre{ (rate + z_squared / (2.0 * trials)) / (1 + z_squared / trials) };
+    double half_width{ confidence_interval_width / (1 + z_squared / trials)
+        * std::sqrt(rate * (1 - rate) / trials + z_squared / (4.0 * trials * trials)) };
+    return std::max(rate - (centre - half_width), centre + half_width - rate);
+}
+
+
+double activity_estimator::get_largest_error() const
+{
+    double largest_error{};
+    for (std::size_t element{}; element < estimated_positions.size(); element++) {
+        largest_error = std::max(largest_error, get_interval(ones_counts[element], number_of_cycles));
+        largest_error = std::max(largest_error, get_interval(toggle_counts[element], number_of_cycles - 1));
+    }
+    return largest_error;
+}
+
+
+// simulates source on random inputs, input i (in circuit input order) being 1 with input_probabilities[i],
+// until every estimate's confidence interval is within the target error or the maximum cycles are reached.
+// every element is estimated except bus cells and module instances, whose outputs are their bit selects
+// returns false if a probability is missing or not between 0 and 1
+bool activity_estimator::estimate(const circuit& source, const std::vector<double>& input_probabilities)
+{
+    TRACE_SCOPE("activity_estimation");
+    std::vector<int> input_positions{ source.get_input_positions() };
+    if (input_probabilities.size() != input_positions.size()) {
+        std::cerr << "\nError: each of the " << input_positions.size() << " inputs needs a probability\n";
+        return false;
+    }
+    std::vector<std::uint32_t> scaled_probabilities;
+    for (const double& probability : input_probabilities) {
+        if (!(probability >= 0 && probability <= 1)) {
+            std::cerr << "\nError: probabilities must be between 0 and 1\n";
+            return false;
+        }
+        scaled_probabilities.push_back(static_cast<std::uint32_t>(std::lround(probability * (1 << probability_bits))));
+    }
+
+    estimated_positions.clear();
+    element_names.clear();
+    for (int position{}; position < source.get_circuit_size(); position++) {
+        if (!is_multi_output_type(source.get_element_gate_type(position))) {
+            estimated_positions.push_back(position);
+            element_names.push_back(source.get_element_name(position));
+        }
+    }
+    ones_counts.assign(estimated_positions.size(), 0);
+    toggle_counts.assign(estimated_positions.size(), 0);
+    last_words.assign(estimated_positions.size(), 0);
+    number_of_cycles = 0;
+    has_converged = false;
+
+    int words_per_batch{ std::max(1, std::min(maximum_batch_cycles / 64,
+        batch_words / std::max(1, static_cast<int>(estimated_positions.size())))) };
+    std::mt19937_64 random_words{ 2026 };
+    auto start_time = std::chrono::steady_clock::now();
+
+    while (number_of_cycles < maximum_cycles && !has_converged) {
+        std::uint64_t remaining_words{ (maximum_cycles - number_of_cycles + 63) / 64 };
+        int words{ static_cast<int>(std::min<std::uint64_t>(words_per_batch, remaining_words)) };
+        bit_matrix input_vectors(static_cast<int>(input_positions.size()), words * 64);
+        for (int word{}; word < words; word++) {
+            for (std::size_t i{}; i < input_positions.size(); i++) {
+                input_vectors.set_word(static_cast<int>(i), word, get_random_word(random_words, scaled_probabilities[i]));
+            }
+        }
+        bit_matrix element_vectors{ source.evaluate_batch(input_vectors, estimated_positions) };
+
+        // cycle c of a word is bit c, so each bit is compared with the bit below it,
+        // and bit 0 with the top bit of the word before (or itself, for the first cycle)
+        for (std::size_t element{}; element < estimated_positions.size(); element++) {
+            std::uint64_t ones{};
+            std::uint64_t toggles{};
+            std::uint64_t last_word{ last_words[element] };
+            for (int word{}; word < words; word++) {
+                std::uint64_t values{ element_vectors.get_word(static_cast<int>(element), word) };
+                std::uint64_t previous_bit{ number_of_cycles == 0 && word == 0 ? values & 1 : last_word >> 63 };
+                ones += std::bitset<64>(values).count();
+                toggles += std::bitset<64>(values ^ ((values << 1) | previous_bit)).count();
+                last_word = values;
+            }
+            ones_counts[element] += ones;
+            toggle_counts[element] += toggles;
+            last_words[element] = last_word;
+        }
+        number_of_cycles += static_cast<std::uint64_t>(words) * 64;
+        has_converged = number_of_cycles >= minimum_activity_cycles && get_largest_error() <= target_error;
+    }
+
+    double seconds{ std::chrono::duration<double>(std::chrono::steady_clock::now() - start_time).count() };
+    cycles_per_second = seconds > 0 ? number_of_cycles / seconds : 0;
+    return true;
+}
+
+
+int activity_estimator::get_number_of_elements() const
+{
+    return static_cast<int>(estimated_positions.size());
+}
+
+activity_estimator::element_activity activity_estimator::get_activity(const int& element) const
+{
+    std::uint64_t transitions{ number_of_cycles > 0 ? number_of_cycles - 1 : 0 };
+    return element_activity{ estimated_positions[element],
+        number_of_cycles > 0 ? static_cast<double>(ones_counts[element]) / number_of_cycles : 0,
+        get_interval(ones_counts[element], number_of_cycles),
+        transitions > 0 ? static_cast<double>(toggle_counts[element]) / transitions : 0,
+        get_interval(toggle_counts[element], transitions) };
+}
+
+const std::string& activity_estimator::get_element_name(const int& element) const
+{
+    return element_names[element];
+}
+
+std::uint64_t activity_estimator::get_number_of_cycles() const
+{
+    return number_of_cycles;
+}
+
+// false if the maximum cycles were reached before every estimate was within the target error
+bool activity_estimator::is_converged() const
+{
+    return has_converged;
+}
+
+double activity_estimator::get_cycles_per_second() const
+{
+    return cycles_per_second;
+}
+
+
+// prints the estimates of the elements that toggle most, up to maximum_elements of them
+void activity_estimator::print_activity(const int& maximum_elements) const
+{
+    std::vector<int> elements(estimated_positions.size());
+    for (std::size_t element{}; element < elements.size(); element++) {
+        elements[element] = static_cast<int>(element);
+    }
+    std::stable_sort(elements.begin(), elements.end(), [this](const int& a, const int& b) {
+        return toggle_counts[a] > toggle_counts[b];
+    });
+    if (static_cast<int>(elements.size()) > maximum_elements) {
+        elements.resize(maximum_elements);
+        std::cout << "The " << maximum_elements << " most active elements:\n";
+    }
+
+    std::cout << "    element: probability of 1, toggles per cycle\n";
+    for (const int& element : elements) {
+        element_activity activity{ get_activity(element) };
+        std::cout << "    " << element_names[element] << ": " << activity.probability
+            << " (+/- " << activity.probability_error << "), " << activity.toggle_rate
+            << " (+/- " << activity.toggle_rate_error << ")\n";
+    }
+    std::cout << "\n";
+}
+
+// writes every element's estimates as comma-separated values, one element per line, under a header line
+bool activity_estimator::write_activity(const std::string& file_name) const
+{
+    std::ofstream activity_file(file_name);
+    activity_file << "element,probability,probability_error,toggle_rate,toggle_rate_error\n";
+    for (int element{}; element < get_number_of_elements(); element++) {
+        element_activity activity{ get_activity(element) };
+        activity_file << element_names[element] << "," << activity.probability << "," << activity.probability_error
+            << "," << activity.toggle_rate << "," << activity.toggle_rate_error << "\n";
+    }
+
+    if (!activity_file) {
+        std::cerr << "\nError: could not write to '" << file_name << "'\n";
+        return false;
+    }
+    return true;
+}
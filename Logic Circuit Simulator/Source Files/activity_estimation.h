@@ -0,0 +1,64 @@
+// activity_estimation.h (last modified: 18/10/26)
+// header file for the activity_estimator class definition and class member declarations
+// an activity_estimator estimates, for power analysis, how often each element of a circuit is 1
+// (its signal probability) and how often it changes from one clock cycle to the next (its toggle rate).
+// each input is driven by random values that are 1 with a chosen probability, a new value every cycle,
+// and the circuit is simulated 64 cycles to a word until every estimate is close enough to be trusted
+
+#ifndef ACTIVITY_ESTIMATION_H
+#define ACTIVITY_ESTIMATION_H
+
+#include <vector>
+#include <string>
+#include <cstdint>
+#include "circuit.h"
+
+
+class activity_estimator
+{
+public:
+    // estimates for one element, each with how far it may be from the true value (95% confidence, see get_interval)
+    struct element_activity
+    {
+        int position;
+        double probability;
+        double probability_error;
+        double toggle_rate;         // changes per cycle
+        double toggle_rate_error;
+    };
+
+private:
+    double target_error;
+    std::uint64_t maximum_cycles;
+
+    std::vector<int> estimated_positions;
+    std::vector<std::string> element_names;
+    std::vector<std::uint64_t> ones_counts;
+    std::vector<std::uint64_t> toggle_counts;
+    std::vector<std::uint64_t> last_words;      // by element, the word of the cycles simulated last
+    std::uint64_t number_of_cycles;
+    bool has_converged;
+    double cycles_per_second;
+
+    double get_largest_error() const;
+
+public:
+    activity_estimator();
+    ~activity_estimator() {};
+
+    void set_target_error(const double&);
+    double get_target_error() const;
+    void set_maximum_cycles(const std::uint64_t&);
+    bool estimate(const circuit&, const std::vector<double>& input_probabilities);
+
+    int get_number_of_elements() const;
+    element_activity get_activity(const int& element) const;
+    const std::string& get_element_name(const int& element) const;
+    std::uint64_t get_number_of_cycles() const;
+    bool is_converged() const;
+    double get_cycles_per_second() const;
+    void print_activity(const int& maximum_elements) const;
+    bool write_activity(const std::string& file_name) const;
+};
+
+#endif
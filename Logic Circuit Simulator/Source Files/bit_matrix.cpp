@@ -0,0 +1,71 @@
+// bit_matrix.cpp (last modified: 18/10/26)
+// Contains definition of all bit_matrix class members not defined in bit_matrix.h
+
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+#include "bit_matrix.h"
+
+
+bit_matrix::bit_matrix() : number_of_rows{}, number_of_columns{}, words_per_row{}, words{} {}
+
+// all bits start as 0
+bit_matrix::bit_matrix(const int& rows, const int& columns) :
+    number_of_rows{ rows }, number_of_columns{ columns }, words_per_row{ (columns + 63) / 64 },
+    words(static_cast<std::size_t>(rows) * ((columns + 63) / 64), 0) {}
+
+
+int bit_matrix::get_number_of_rows() const
+{
+    return number_of_rows;
+}
+
+int bit_matrix::get_number_of_columns() const
+{
+    return number_of_columns;
+}
+
+int bit_matrix::get_words_per_row() const
+{
+    return words_per_row;
+}
+
+
+bool bit_matrix::get_bit(const int& row, const int& column) const
+{
+    return (words[static_cast<std::size_t>(row) * words_per_row + column / 64] >> (column % 64)) & 1;
+}
+
+void bit_matrix::set_bit(const int& row, const int& column, const bool& value)
+{
+    std::uint64_t& word{ words[static_cast<std::size_t>(row) * words_per_row + column / 64] };
+    std::uint64_t mask{ std::uint64_t{ 1 } << (column % 64) };
+    word = value ? (word | mask) : (word & ~mask);
+}
+
+// column c of a row is bit (c % 64) of word (c / 64)
+std::uint64_t bit_matrix::get_word(const int& row, const int& word) const
+{
+    return words[static_cast<std::size_t>(row) * words_per_row + word];
+}
+
+void bit_matrix::set_word(const int& row, const int& word, const std::uint64_t& value)
+{
+    words[static_cast<std::size_t>(row) * words_per_row + word] = value;
+}
+
+
+// swaps rows and columns, eg. to convert one-row-per-vector data into one-row-per-signal
+bit_matrix bit_matrix::transpose() const
+{
+    bit_matrix transposed(number_of_columns, number_of_rows);
+
+    for (int i{}; i < number_of_rows; i++) {
+        for (int j{}; j < number_of_columns; j++) {
+            if (get_bit(i, j)) {
+                transposed.set_bit(j, i, true);
+            }
+        }
+    }
+    return transposed;
+}
@@ -0,0 +1,37 @@
+// bit_matrix.h (last modified: 18/10/26)
+// header file for the bit_matrix class definition and class member declarations
+// a bit_matrix stores one bit per entry, packed 64 to a word, row by row
+
+#ifndef BIT_MATRIX_H
+#define BIT_MATRIX_H
+
+#include <vector>
+#include <cstdint>
+
+
+class bit_matrix
+{
+private:
+    int number_of_rows;
+    int number_of_columns;
+    int words_per_row;
+    std::vector<std::uint64_t> words;
+
+public:
+    bit_matrix();
+    bit_matrix(const int& rows, const int& columns);
+    ~bit_matrix() {};
+
+    int get_number_of_rows() const;
+    int get_number_of_columns() const;
+    int get_words_per_row() const;
+
+    bool get_bit(const int& row, const int& column) const;
+    void set_bit(const int& row, const int& column, const bool& value);
+    std::uint64_t get_word(const int& row, const int& word) const;
+    void set_word(const int& row, const int& word, const std::uint64_t& value);
+
+    bit_matrix transpose() const;
+};
+
+#endif
@@ -1,4 +1,4 @@
-// circuit.cpp (last modified: 03/07/22)
+// circuit.cpp (last modified: 18/10/26)
 // Contains definition of all circuit class members not defined in circuit.h
 
 #include <iostream>
@@ -7,119 +7,1737 @@
 #include <string>
 #include <memory>
 #include <sstream>
+#include <algorithm>
+#include <cstdint>
+#include <cstddef>
+#include <functional>
+#include <limits>
+#include <set>
 #include "circuit.h"
 #include "elements.h"
 #include "universal_functions.h"
+#include "evaluation_plan.h"
+#include "thread_pool.h"
+#include "bit_matrix.h"
+#include "result_cache.h"
+#include "symbol_table.h"
+#include "instrumentation.h"
+#include "tracing.h"
+#include "memory_usage.h"
+#include "value_buffers.h"
+#include "module_definition.h"
+#include "sop_minimization.h"
 
 
-circuit::circuit() : circuit_elements{}, input_positions{}, number_of_inputs{}, number_of_elements{} {}
+// truth table rows simulated together as one chunk
+const int truth_table_chunk_rows{ 256 };
+
+// rough memory added to the circuit by one new element (the element, its pointer and bookkeeping,
+// its place in the evaluation plan and its name), used to check netlists against the memory budget
+const std::size_t estimated_bytes_per_element{ 256 };
+
+// truth tables with more inputs cannot be stored, as their row numbers would not fit in an int
+const int maximum_stored_truth_table_inputs{ 30 };
+
+// truth tables needing more memory than this are printed a chunk of rows at a time rather than stored,
+// even when no memory budget is set
+const std::size_t maximum_truth_table_memory{ std::size_t{ 256 } << 20 };
+
+// printed minimized formulae are found exactly for cones of up to this many inputs, heuristically for larger ones
+const int maximum_printed_exact_minimization_inputs{ 6 };
+
+
+circuit::circuit() : circuit_elements{}, input_positions{}, number_of_inputs{}, number_of_elements{},
+    element_levels{}, element_fanouts{}, pending_elements{}, is_pending{},
+    cone_hashes{}, is_cone_hash_stale{}, input_set_hash{ 0 }, cached_results{},
+    element_names{}, element_name_ids{}, named_elements{}, pending_netlist{},
+    plan{}, is_plan_current{ false }, worker_pool{}, level_values{},
+    memory_budget{ 0 }, cache_memory_limit{ cached_results.get_memory_limit() }, truth_table_memory_peak{ 0 },
+    element_memory_used{ 0 }, module_memory_used{ 0 }, is_element_memory_current{ true },
+    circuit_outputs{}, output_indices{}, is_output_index_current{ true }, changed_output_bits{}, changed_outputs{},
+    reported_output_values{}, notified_output_values{}, propagation_changes{},
+    output_subscriptions{}, next_subscription_id{ 0 }, change_log{ nullptr }, value_snapshots{ new value_buffers() },
+    counters{}, modules{} {}
 
 // add_element overloaded for different element types
 void circuit::add_element(const bool& input_value)
 {
-    circuit_elements.push_back(std::make_shared<input_element>(input_value));
+    circuit_elements.push_back(std::make_shared<input_element>(get_circuit_size(), input_value));
 
     input_positions.push_back(get_circuit_size());
+    input_set_hash = combine_hash(input_set_hash, get_circuit_size());
     number_of_inputs++;
-    number_of_elements++;
+    connect_element(get_circuit_size());
+}
+
+// the gate element overloads return false, adding nothing, if a gate other than a bit select
+// would read a bus cell or module instance directly
+bool circuit::add_element(const std::string gate_type, const int& input_position)
+{
+    if (!can_use_inputs(gate_type, { input_position })) {
+        return false;
+    }
+    if (get_element_type(gate_type) == "bit") {
+        circuit_elements.push_back(std::make_shared<bit_select_element>
+            (get_circuit_size(), gate_type, circuit_elements[input_position]));
+    }
+    else {
+        circuit_elements.push_back(std::make_shared<unary_gate_element>
+            (get_circuit_size(), gate_type, circuit_elements[input_position]));
+    }
+
+    connect_element(get_circuit_size());
+    return true;
+}
+
+bool circuit::add_element(const std::string gate_type,
+    const int& input1_position, const int& input2_position)
+{
+    if (!can_use_inputs(gate_type, { input1_position, input2_position })) {
+        return false;
+    }
+    circuit_elements.push_back(std::make_shared<binary_gate_element>
+        (get_circuit_size(), gate_type, circuit_elements[input1_position], circuit_elements[input2_position]));
+
+    connect_element(get_circuit_size());
+    return true;
+}
+
+bool circuit::add_element(const std::string gate_type, const std::vector<int>& element_input_positions)
+{
+    if (!can_use_inputs(gate_type, element_input_positions)) {
+        return false;
+    }
+    std::vector<std::shared_ptr<circuit_element>> input_elements;
+    for (const int& input : element_input_positions) {
+        input_elements.push_back(circuit_elements[input]);
+    }
+    if (get_element_type(gate_type) == "bus") {
+        circuit_elements.push_back(std::make_shared<bus_cell_element>
+            (get_circuit_size(), gate_type, input_elements));
+    }
+    else if (get_element_type(gate_type) == "module") {
+        circuit_elements.push_back(std::make_shared<module_instance_element>
+            (get_circuit_size(), gate_type, input_elements));
+    }
+    else {
+        circuit_elements.push_back(std::make_shared<multi_input_gate_element>
+            (get_circuit_size(), gate_type, input_elements));
+    }
+
+    connect_element(get_circuit_size());
+    return true;
+}
+
+// adds a bus cell followed by one bit select element for each of its outputs, least significant first
+// inputs are listed least significant bit first: the first operand, then the second, then any select
+bool circuit::add_bus_cell(const std::string gate_type, const std::vector<int>& element_input_positions)
+{
+    int cell_position{ get_circuit_size() };
+    if (!add_element(gate_type, element_input_positions)) {
+        return false;
+    }
+
+    for (int bit{}; bit < get_number_of_gate_outputs(gate_type); bit++) {
+        add_element("BIT" + std::to_string(bit), cell_position);
+    }
+    return true;
+}
+
+// adds an instance of a module followed by one bit select element for each of its outputs, as for bus cells
+// inputs are given in the order of the module's inputs
+bool circuit::add_module_instance(const std::string module_name, const std::vector<int>& element_input_positions)
+{
+    return add_bus_cell(module_name, element_input_positions);
+}
+
+
+// a bus cell or module instance outputs a whole bus, so only bit selects may use it as an input
+// returns false, writing why to std::cerr, if an element of gate_type could not use one of the given inputs
+bool circuit::can_use_inputs(const std::string& gate_type, const std::vector<int>& element_input_positions) const
+{
+    if (get_element_type(gate_type) == "bit") {
+        return true;
+    }
+    for (const int& input : element_input_positions) {
+        std::string input_gate_type{ circuit_elements[input]->get_gate_type() };
+        if (is_multi_output_type(input_gate_type)) {
+            std::cerr << "\nError: " << gate_type << " elements cannot use '" << get_element_name(input)
+                << "' as an input, as only BIT elements can read the outputs of " << input_gate_type << " elements\n";
+            return false;
+        }
+    }
+    return true;
+}
+
+
+// records a newly created element's level and cone hash, and adds it to the fanouts of its inputs
+// its inputs are no longer outputs of the circuit
+void circuit::connect_element(const int& position)
+{
+    const std::shared_ptr<circuit_element>& element{ circuit_elements[position] };
+    int level{ 0 };
+    std::uint64_t cone_hash{ std::hash<std::string>()(element->get_gate_type()) };
+
+    if (get_element_type(element->get_gate_type()) != "input") {
+        for (const int& input : element->get_input_elements_positions()) {
+            circuit_elements[input]->update_output_status();
+            element_fanouts[input].push_back(position);
+            level = std::max(level, element_levels[input] + 1);
+            cone_hash = combine_hash(cone_hash, get_cone_hash(input));
+        }
+    }
+    else {
+        cone_hash = combine_hash(cone_hash, position);
+    }
+
+    if (position >= static_cast<int>(element_levels.size())) {
+        element_levels.resize(position + 1);
+        element_fanouts.resize(position + 1);
+        is_pending.resize(position + 1);
+        cone_hashes.resize(position + 1);
+        is_cone_hash_stale.resize(position + 1);
+    }
+    element_levels[position] = level;
+    cone_hashes[position] = cone_hash;
+    is_cone_hash_stale[position] = false;
+    if (level >= static_cast<int>(pending_elements.size())) {
+        pending_elements.resize(level + 1);
+    }
+
+    // an unnamed element is named by its letter, or if another element already has that name,
+    // by its letter with enough leading underscores to make it unique
+    if (position >= static_cast<int>(element_name_ids.size()) || element_name_ids[position] == -1) {
+        std::string name{ get_element_letter(position) };
+        while (find_element(name) != -1) {
+            name = "_" + name;
+        }
+        set_element_name(position, name);
+    }
+
+    number_of_elements = std::max(number_of_elements, position + 1);
+    is_plan_current = false;
+    is_element_memory_current = false;
+    is_output_index_current = false;
+}
+
+
+// creates an element of the class for its gate type; its inputs must already exist
+std::shared_ptr<circuit_element> circuit::make_element(const int& position, const std::string& gate_type,
+    const std::vector<int>& element_input_positions, const bool& input_value) const
+{
+    std::string element_type{ get_element_type(gate_type) };
+
+    if (element_type == "input") {
+        return std::make_shared<input_element>(position, input_value);
+    }
+    if (element_type == "unary") {
+        return std::make_shared<unary_gate_element>(position, gate_type, circuit_elements[element_input_positions[0]]);
+    }
+    if (element_type == "bit") {
+        return std::make_shared<bit_select_element>(position, gate_type, circuit_elements[element_input_positions[0]]);
+    }
+    if (element_type == "lut" || element_type == "wide" || element_type == "bus" || element_type == "module") {
+        std::vector<std::shared_ptr<circuit_element>> input_elements;
+        for (const int& input : element_input_positions) {
+            input_elements.push_back(circuit_elements[input]);
+        }
+        if (element_type == "bus") {
+            return std::make_shared<bus_cell_element>(position, gate_type, input_elements);
+        }
+        if (element_type == "module") {
+            return std::make_shared<module_instance_element>(position, gate_type, input_elements);
+        }
+        return std::make_shared<multi_input_gate_element>(position, gate_type, input_elements);
+    }
+    return std::make_shared<binary_gate_element>(position, gate_type, circuit_elements[element_input_positions[0]],
+        circuit_elements[element_input_positions[1]]);
+}
+
+
+// out-of-order construction: between begin_netlist and finish_netlist, elements can be added
+// at any position and may use inputs that have not been added yet.
+// finish_netlist then sorts them so every element comes after its inputs
+void circuit::begin_netlist()
+{
+    pending_netlist.clear();
+}
+
+void circuit::add_netlist_element(const int& position, const bool& input_value)
+{
+    if (position >= static_cast<int>(pending_netlist.size())) {
+        pending_netlist.resize(position + 1, netlist_entry{ false, "", {}, false });
+    }
+    pending_netlist[position] = netlist_entry{ true, "Input", {}, input_value };
+}
+
+void circuit::add_netlist_element(const int& position, const std::string gate_type,
+    const std::vector<int>& element_input_positions)
+{
+    if (position >= static_cast<int>(pending_netlist.size())) {
+        pending_netlist.resize(position + 1, netlist_entry{ false, "", {}, false });
+    }
+    pending_netlist[position] = netlist_entry{ true, gate_type, element_input_positions, false };
+}
+
+
+// drops a netlist that could not be finished, along with any names given to its elements
+void circuit::discard_pending_netlist()
+{
+    for (int position{ get_circuit_size() }; position < static_cast<int>(element_name_ids.size()); position++) {
+        if (element_name_ids[position] != -1) {
+            named_elements[element_name_ids[position]] = -1;
+        }
+    }
+    element_name_ids.resize(std::min(element_name_ids.size(), static_cast<size_t>(get_circuit_size())));
+    pending_netlist.clear();
+}
+
+
+// checks the pending netlist, sorts it topologically and creates its elements
+// new elements must fill every position from the current circuit size up to the largest one given,
+// and may use existing elements as inputs.
+// the sort is Kahn's algorithm: an element is created once all of its inputs exist, which takes
+// linear time and leaves elements on a combinational loop uncreated.
+// returns false, leaving the circuit unchanged and writing why to error_output, if the netlist is incomplete
+// or contains a loop
+bool circuit::finish_netlist(std::ostream& error_output)
+{
+    TRACE_SCOPE("finish_netlist");
+    int first_position{ get_circuit_size() };
+    int netlist_size{ static_cast<int>(pending_netlist.size()) };
+    if (netlist_size <= first_position) {
+        pending_netlist.clear();
+        return true;
+    }
+
+    std::size_t free_memory{ get_free_memory() };
+    if (static_cast<std::size_t>(netlist_size - first_position) > free_memory / estimated_bytes_per_element) {
+        error_output << "\nError: adding " << netlist_size - first_position << " elements needs about "
+            << format_memory_size(estimated_bytes_per_element * (netlist_size - first_position))
+            << " but only " << format_memory_size(free_memory) << " of the memory budget is free\n";
+        discard_pending_netlist();
+        return false;
+    }
+
+    for (int position{ first_position }; position < netlist_size; position++) {
+        const netlist_entry& entry{ pending_netlist[position] };
+
+        if (!entry.is_defined) {
+            error_output << "\nError: element '" << get_element_name(position) << "' is missing from the netlist\n";
+            discard_pending_netlist();
+            return false;
+        }
+        size_t expected_inputs = get_number_of_gate_inputs(entry.gate_type);
+        if (entry.input_positions.size() != expected_inputs) {
+            error_output << "\nError: element '" << get_element_name(position) << "' has "
+                << entry.input_positions.size() << " inputs but a " << entry.gate_type
+                << " element needs " << expected_inputs << "\n";
+            discard_pending_netlist();
+            return false;
+        }
+        for (const int& input : entry.input_positions) {
+            if (input < 0 || input >= netlist_size || (input >= first_position && !pending_netlist[input].is_defined)) {
+                error_output << "\nError: element '" << get_element_name(position)
+                    << "' uses an element that does not exist\n";
+                discard_pending_netlist();
+                return false;
+            }
+        }
+
+        // a bit select must read an output that its bus cell or module instance actually has,
+        // and other elements cannot read bus cells or module instances at all
+        if (get_element_type(entry.gate_type) != "bit") {
+            for (const int& input : entry.input_positions) {
+                std::string input_gate_type{ input < first_position ?
+                    circuit_elements[input]->get_gate_type() : pending_netlist[input].gate_type };
+                if (is_multi_output_type(input_gate_type)) {
+                    error_output << "\nError: element '" << get_element_name(position) << "' uses '"
+                        << get_element_name(input) << "' as an input, but only BIT elements can read the outputs of "
+                        << input_gate_type << " elements\n";
+                    discard_pending_netlist();
+                    return false;
+                }
+            }
+        }
+        else {
+            int input{ entry.input_positions[0] };
+            std::string input_gate_type{ input < first_position ?
+                circuit_elements[input]->get_gate_type() : pending_netlist[input].gate_type };
+            std::string base_type;
+            int bit{};
+            parse_sized_gate_type(entry.gate_type, base_type, bit);
+
+            if (!is_multi_output_type(input_gate_type) || bit >= get_number_of_gate_outputs(input_gate_type)) {
+                error_output << "\nError: element '" << get_element_name(position)
+                    << "' selects an output that element '" << get_element_name(input) << "' does not have\n";
+                discard_pending_netlist();
+                return false;
+            }
+        }
+    }
+
+    // number of inputs of each new element that have not been created yet
+    std::vector<int> missing_inputs(netlist_size - first_position, 0);
+    std::vector<std::vector<int>> new_fanouts(missing_inputs.size());
+    std::vector<int> ready_positions;
+
+    for (int position{ first_position }; position < netlist_size; position++) {
+        for (const int& input : pending_netlist[position].input_positions) {
+            if (input >= first_position) {
+                missing_inputs[position - first_position]++;
+                new_fanouts[input - first_position].push_back(position);
+            }
+        }
+        if (missing_inputs[position - first_position] == 0) {
+            ready_positions.push_back(position);
+        }
+    }
+
+    std::vector<int> creation_order;
+    for (size_t i{}; i < ready_positions.size(); i++) {
+        int position{ ready_positions[i] };
+        creation_order.push_back(position);
+        for (const int& fanout : new_fanouts[position - first_position]) {
+            if (--missing_inputs[fanout - first_position] == 0) {
+                ready_positions.push_back(fanout);
+            }
+        }
+    }
+
+    if (static_cast<int>(creation_order.size()) != netlist_size - first_position) {
+        print_netlist_loop(missing_inputs, error_output);
+        discard_pending_netlist();
+        return false;
+    }
+
+    circuit_elements.resize(netlist_size);
+    for (const int& position : creation_order) {
+        const netlist_entry& entry{ pending_netlist[position] };
+        circuit_elements[position] = make_element(position, entry.gate_type, entry.input_positions, entry.input_value);
+        connect_element(position);
+    }
+
+    // inputs are kept in position order, so they are listed by letter as usual
+    for (int position{ first_position }; position < netlist_size; position++) {
+        if (get_element_type(pending_netlist[position].gate_type) == "input") {
+            input_positions.push_back(position);
+            input_set_hash = combine_hash(input_set_hash, position);
+            number_of_inputs++;
+        }
+    }
+    pending_netlist.clear();
+    publish_values();
+    return true;
+}
+
+
+// prints the letters of one combinational loop among the elements finish_netlist could not create
+// every such element has an uncreated input, so following uncreated inputs must revisit an element
+void circuit::print_netlist_loop(const std::vector<int>& missing_inputs, std::ostream& error_output) const
+{
+    int first_position{ get_circuit_size() };
+    int position{ first_position };
+    while (missing_inputs[position - first_position] == 0) {
+        position++;
+    }
+
+    std::vector<int> visit_order(missing_inputs.size(), -1);
+    std::vector<int> path;
+    while (visit_order[position - first_position] == -1) {
+        visit_order[position - first_position] = static_cast<int>(path.size());
+        path.push_back(position);
+        for (const int& input : pending_netlist[position].input_positions) {
+            if (input >= first_position && missing_inputs[input - first_position] != 0) {
+                position = input;
+                break;
+            }
+        }
+    }
+
+    error_output << "\nError: the netlist contains a combinational loop: ";
+    for (size_t i = visit_order[position - first_position]; i < path.size(); i++) {
+        error_output << get_element_name(path[i]) << " <- ";
+    }
+    error_output << get_element_name(position) << "\n";
+}
+
+
+// incremental edits: each changes one element in place, updates the fanouts, levels, cone hashes and
+// output status of only the elements it affects, then propagates any change of value like update_circuit.
+// the evaluation plan and output index are rebuilt when next needed, as after add_element.
+// each returns false, leaving the circuit unchanged, if the edit is not possible
+
+// gives an element a different gate type taking the same number of inputs (eg. AND to NAND)
+// inputs, bus cells, module instances and bit selects cannot change type, as other elements depend on their outputs
+bool circuit::set_element_type(const int& element_position, const std::string& gate_type)
+{
+    if (element_position < 0 || element_position >= number_of_elements) {
+        std::cerr << "\nError: there is no element at position " << element_position << "\n";
+        return false;
+    }
+    std::string element_type{ get_element_type(circuit_elements[element_position]->get_gate_type()) };
+    if (element_type == "input" || element_type == "bus" || element_type == "module" || element_type == "bit") {
+        std::cerr << "\nError: element '" << get_element_name(element_position) << "' is a "
+            << circuit_elements[element_position]->get_gate_type() << ", which cannot change type\n";
+        return false;
+    }
+    if (!is_gate_type(gate_type) || is_multi_output_type(gate_type)) {
+        std::cerr << "\nError: '" << gate_type << "' is not a gate type\n";
+        return false;
+    }
+    std::vector<int> element_inputs{ circuit_elements[element_position]->get_input_elements_positions() };
+    if (get_number_of_gate_inputs(gate_type) != static_cast<int>(element_inputs.size())) {
+        std::cerr << "\nError: element '" << get_element_name(element_position) << "' has " << element_inputs.size()
+            << " inputs but a " << gate_type << " element needs " << get_number_of_gate_inputs(gate_type) << "\n";
+        return false;
+    }
+
+    TRACE_SCOPE("set_element_type");
+    std::uint64_t previous_word{ circuit_elements[element_position]->get_output_word() };
+    replace_element(element_position, make_element(element_position, gate_type, element_inputs, false));
+    update_fanout_cone(element_position);
+    propagate_edit(element_position, previous_word);
+    return true;
+}
+
+
+// connects an element to different inputs, which must not depend on the element itself
+// a bit select's input must be a bus cell or module instance with the output it selects, and no other element may use one
+bool circuit::set_element_inputs(const int& element_position, const std::vector<int>& element_input_positions)
+{
+    if (element_position < 0 || element_position >= number_of_elements) {
+        std::cerr << "\nError: there is no element at position " << element_position << "\n";
+        return false;
+    }
+    std::string gate_type{ circuit_elements[element_position]->get_gate_type() };
+    if (get_element_type(gate_type) == "input") {
+        std::cerr << "\nError: element '" << get_element_name(element_position) << "' is an input, so has no inputs\n";
+        return false;
+    }
+    if (static_cast<int>(element_input_positions.size()) != get_number_of_gate_inputs(gate_type)) {
+        std::cerr << "\nError: element '" << get_element_name(element_position) << "' is given "
+            << element_input_positions.size() << " inputs but a " << gate_type << " element needs "
+            << get_number_of_gate_inputs(gate_type) << "\n";
+        return false;
+    }
+    for (const int& input : element_input_positions) {
+        if (input < 0 || input >= number_of_elements) {
+            std::cerr << "\nError: element '" << get_element_name(element_position) << "' is given an input that does not exist\n";
+            return false;
+        }
+        if (is_in_fanout_cone(element_position, input)) {
+            std::cerr << "\nError: using '" << get_element_name(input) << "' as an input of '"
+                << get_element_name(element_position) << "' would make a combinational loop\n";
+            return false;
+        }
+    }
+    if (!can_use_inputs(gate_type, element_input_positions)) {
+        return false;
+    }
+    if (get_element_type(gate_type) == "bit") {
+        std::string input_gate_type{ circuit_elements[element_input_positions[0]]->get_gate_type() };
+        std::string base_type;
+        int bit{};
+        parse_sized_gate_type(gate_type, base_type, bit);
+
+        if (!is_multi_output_type(input_gate_type) || bit >= get_number_of_gate_outputs(input_gate_type)) {
+            std::cerr << "\nError: element '" << get_element_name(element_position) << "' selects an output that element '"
+                << get_element_name(element_input_positions[0]) << "' does not have\n";
+            return false;
+        }
+    }
+
+    TRACE_SCOPE("set_element_inputs");
+    std::uint64_t previous_word{ circuit_elements[element_position]->get_output_word() };
+    disconnect_inputs(element_position);
+    replace_element(element_position, make_element(element_position, gate_type, element_input_positions, false));
+    connect_inputs(element_position);
+    update_fanout_cone(element_position);
+    propagate_edit(element_position, previous_word);
+    return true;
+}
+
+
+// removes an element that no other element uses (an output of the circuit, or an unused input)
+// to keep positions contiguous, the last element moves into the removed element's position,
+// keeping its name; recorders opened on the old positions (eg. vcd_writer) should be reopened
+bool circuit::remove_element(const int& element_position)
+{
+    if (element_position < 0 || element_position >= number_of_elements) {
+        std::cerr << "\nError: there is no element at position " << element_position << "\n";
+        return false;
+    }
+    if (!element_fanouts[element_position].empty()) {
+        std::cerr << "\nError: element '" << get_element_name(element_position) << "' is still used by "
+            << element_fanouts[element_position].size() << " elements, so cannot be removed\n";
+        return false;
+    }
+
+    TRACE_SCOPE("remove_element");
+    update_output_index();
+    bool is_input{ get_element_type(circuit_elements[element_position]->get_gate_type()) == "input" };
+    disconnect_inputs(element_position);
+    if (element_name_ids[element_position] != -1) {
+        named_elements[element_name_ids[element_position]] = -1;
+    }
+    if (is_input) {
+        input_positions.erase(std::find(input_positions.begin(), input_positions.end(), element_position));
+        number_of_inputs--;
+    }
+
+    // the removed element's output index is dropped; the moved element's is kept under its new position
+    int last_position{ number_of_elements - 1 };
+    if (output_indices[element_position] != -1) {
+        circuit_outputs[output_indices[element_position]] = -1;
+    }
+    bool is_last_input{ get_element_type(circuit_elements[last_position]->get_gate_type()) == "input" };
+    if (element_position != last_position) {
+        const std::shared_ptr<circuit_element>& last_element{ circuit_elements[last_position] };
+        std::shared_ptr<circuit_element> moved_element{ make_element(element_position, last_element->get_gate_type(),
+            last_element->get_input_elements_positions(), last_element->get_output_value()) };
+        moved_element->set_output_word(last_element->get_output_word());
+
+        for (const int& input : moved_element->get_input_elements_positions()) {
+            std::replace(element_fanouts[input].begin(), element_fanouts[input].end(), last_position, element_position);
+        }
+        replace_element(last_position, moved_element);
+        circuit_elements[element_position] = moved_element;
+        element_fanouts[element_position].swap(element_fanouts[last_position]);
+        element_levels[element_position] = element_levels[last_position];
+        cone_hashes[element_position] = cone_hashes[last_position];
+        is_cone_hash_stale[element_position] = is_cone_hash_stale[last_position];
+        element_name_ids[element_position] = element_name_ids[last_position];
+        if (element_name_ids[element_position] != -1) {
+            named_elements[element_name_ids[element_position]] = element_position;
+        }
+
+        if (output_indices[last_position] != -1) {
+            circuit_outputs[output_indices[last_position]] = element_position;
+        }
+        output_indices[element_position] = output_indices[last_position];
+
+        // inputs are kept in position order
+        if (is_last_input) {
+            input_positions.erase(std::find(input_positions.begin(), input_positions.end(), last_position));
+            input_positions.insert(std::lower_bound(input_positions.begin(), input_positions.end(), element_position),
+                element_position);
+        }
+    }
+
+    circuit_elements.pop_back();
+    element_levels.pop_back();
+    element_fanouts.pop_back();
+    is_pending.pop_back();
+    cone_hashes.pop_back();
+    is_cone_hash_stale.pop_back();
+    element_name_ids.resize(last_position);
+    output_indices.pop_back();
+    number_of_elements--;
+
+    // an input's cone hash is made from its position, so moving or removing one changes the keys
+    // of every cone it feeds; the cache is cleared rather than risk reusing a stale key
+    if (is_input || is_last_input) {
+        input_set_hash = 0;
+        for (const int& input : input_positions) {
+            input_set_hash = combine_hash(input_set_hash, input);
+        }
+        cached_results.clear();
+        if (element_position != last_position) {
+            update_fanout_cone(element_position);
+        }
+    }
+    // a recorder is told the moved element's position changed, and forgets the last position
+    if (change_log != nullptr) {
+        change_log->erase(std::remove(change_log->begin(), change_log->end(), last_position), change_log->end());
+        if (element_position != last_position) {
+            change_log->push_back(element_position);
+        }
+    }
+    is_plan_current = false;
+    is_element_memory_current = false;
+    is_output_index_current = false;
+    value_snapshots->mark_all_changed();
+    publish_values();
+    return true;
+}
+
+
+// replaces every module instance with a copy of its module's gates, for analyses that only understand
+// primitive gates (eg. lut mapping); until then a circuit only holds one copy of each module it uses.
+// only the gates feeding the module's outputs are copied, named <instance name>.<name in the module>,
+// and the last one copied takes the instance's position. the instance's bit selects become buffers of
+// the copied outputs, keeping their positions and names, and modules used inside modules are flattened
+// in turn. levels are worked out once at the end, as rewiring an instance can move everything after it.
+// returns the number of instances flattened
+int circuit::flatten_module_instances()
+{
+    TRACE_SCOPE("flatten_module_instances");
+    int instances_flattened{ 0 };
+    for (int position{}; position < number_of_elements; position++) {
+        std::string gate_type{ circuit_elements[position]->get_gate_type() };
+        if (get_element_type(gate_type) != "module") {
+            continue;
+        }
+        std::shared_ptr<const module_definition> module{ find_module(gate_type) };
+        const circuit& body{ module->get_body() };
+        std::string instance_name{ get_element_name(position) };
+
+        std::vector<char> is_needed(body.get_circuit_size(), false);
+        std::vector<int> needed_gates;
+        std::vector<int> searched_positions{ module->get_output_positions() };
+        for (const int& output : searched_positions) {
+            is_needed[output] = true;
+        }
+        for (size_t i{}; i < searched_positions.size(); i++) {
+            if (get_element_type(body.get_element_gate_type(searched_positions[i])) == "input") {
+                continue;
+            }
+            needed_gates.push_back(searched_positions[i]);
+            for (const int& input : body.get_element_input_positions(searched_positions[i])) {
+                if (!is_needed[input]) {
+                    is_needed[input] = true;
+                    searched_positions.push_back(input);
+                }
+            }
+        }
+        // copying in level order means every gate's inputs are copied before it
+        std::stable_sort(needed_gates.begin(), needed_gates.end(), [&body](const int& a, const int& b) {
+            return body.get_element_level(a) < body.get_element_level(b);
+        });
+
+        // the module's inputs are the instance's inputs
+        std::vector<int> copy_positions(body.get_circuit_size(), -1);
+        std::vector<int> body_inputs{ body.get_input_positions() };
+        std::vector<int> instance_inputs{ circuit_elements[position]->get_input_elements_positions() };
+        for (size_t i{}; i < body_inputs.size(); i++) {
+            copy_positions[body_inputs[i]] = instance_inputs[i];
+        }
+        disconnect_inputs(position);
+        for (size_t i{}; i < needed_gates.size(); i++) {
+            std::vector<int> copy_inputs;
+            for (const int& input : body.get_element_input_positions(needed_gates[i])) {
+                copy_inputs.push_back(copy_positions[input]);
+            }
+            bool is_last_gate{ i + 1 == needed_gates.size() };
+            int copy_position{ is_last_gate ? position : get_circuit_size() };
+            set_element_name(copy_position, instance_name + "." + body.get_element_name(needed_gates[i]));
+            std::shared_ptr<circuit_element> copy{ make_element(copy_position, body.get_element_gate_type(needed_gates[i]),
+                copy_inputs, false) };
+            if (is_last_gate) {
+                replace_element(position, copy);
+                connect_inputs(position);
+            }
+            else {
+                circuit_elements.push_back(copy);
+                connect_element(copy_position);
+            }
+            copy_positions[needed_gates[i]] = copy_position;
+        }
+
+        // bit selects become buffers, and elements using the instance directly read its first output
+        std::vector<int> instance_fanouts{ element_fanouts[position] };
+        std::sort(instance_fanouts.begin(), instance_fanouts.end());
+        instance_fanouts.erase(std::unique(instance_fanouts.begin(), instance_fanouts.end()), instance_fanouts.end());
+        for (const int& fanout : instance_fanouts) {
+            std::string fanout_gate_type{ circuit_elements[fanout]->get_gate_type() };
+            std::vector<int> fanout_inputs{ circuit_elements[fanout]->get_input_elements_positions() };
+            if (get_element_type(fanout_gate_type) == "bit") {
+                std::string base_type;
+                int bit{};
+                parse_sized_gate_type(fanout_gate_type, base_type, bit);
+                fanout_gate_type = "BUFFER";
+                fanout_inputs = { copy_positions[module->get_output_positions()[bit]] };
+            }
+            else {
+                std::replace(fanout_inputs.begin(), fanout_inputs.end(), position,
+                    copy_positions[module->get_output_positions()[0]]);
+            }
+            disconnect_inputs(fanout);
+            replace_element(fanout, make_element(fanout, fanout_gate_type, fanout_inputs, false));
+            connect_inputs(fanout);
+        }
+
+        // a module whose outputs are all its inputs leaves no gate to take the instance's position
+        if (needed_gates.empty()) {
+            connect_inputs(position);
+            remove_element(position);
+            position--;
+        }
+        else if (change_log != nullptr) {
+            change_log->push_back(position);
+        }
+        instances_flattened++;
+    }
+    if (instances_flattened == 0) {
+        return 0;
+    }
+
+    // levels are worked out again in topological order (Kahn's algorithm, as in finish_netlist)
+    std::vector<int> missing_inputs(number_of_elements, 0);
+    std::vector<int> ready_positions;
+    for (int position{}; position < number_of_elements; position++) {
+        element_levels[position] = 0;
+        if (get_element_type(circuit_elements[position]->get_gate_type()) != "input") {
+            missing_inputs[position] = static_cast<int>(circuit_elements[position]->get_input_elements_positions().size());
+        }
+        if (missing_inputs[position] == 0) {
+            ready_positions.push_back(position);
+        }
+    }
+    for (size_t i{}; i < ready_positions.size(); i++) {
+        int position{ ready_positions[i] };
+        if (element_levels[position] >= static_cast<int>(pending_elements.size())) {
+            pending_elements.resize(element_levels[position] + 1);
+        }
+        for (const int& fanout : element_fanouts[position]) {
+            element_levels[fanout] = std::max(element_levels[fanout], element_levels[position] + 1);
+            if (--missing_inputs[fanout] == 0) {
+                ready_positions.push_back(fanout);
+            }
+        }
+    }
+    std::fill(is_cone_hash_stale.begin(), is_cone_hash_stale.end(), true);
+    is_plan_current = false;
+    is_element_memory_current = false;
+    is_output_index_current = false;
+    value_snapshots->mark_all_changed();
+    publish_values();
+    return instances_flattened;
+}
+
+
+// builds a copy of the circuit in target, which must be empty: the same elements at the same positions,
+// with the same names and input values, using the same module library. analyses that change the circuit
+// they work on (eg. flattening module instances before lut mapping) can then leave the original as it is
+bool circuit::copy_circuit(circuit& target) const
+{
+    target.modules = modules;
+    for (int position{}; position < number_of_elements; position++) {
+        if (position < static_cast<int>(element_name_ids.size()) && element_name_ids[position] != -1) {
+            target.set_element_name(position, get_element_name(position));
+        }
+    }
+    target.begin_netlist();
+    for (int position{}; position < number_of_elements; position++) {
+        std::string gate_type{ circuit_elements[position]->get_gate_type() };
+        if (get_element_type(gate_type) == "input") {
+            target.add_netlist_element(position, circuit_elements[position]->get_output_value());
+        }
+        else {
+            target.add_netlist_element(position, gate_type, circuit_elements[position]->get_input_elements_positions());
+        }
+    }
+    return target.finish_netlist(std::cerr);
+}
+
+
+// whether element can be reached from element_position by following fanouts (or is element_position)
+// only elements at levels below element's need to be searched, as levels increase along every path.
+// reached elements are marked in is_pending, which is clear again before returning
+bool circuit::is_in_fanout_cone(const int& element_position, const int& element)
+{
+    if (element == element_position) {
+        return true;
+    }
+    if (element_levels[element] <= element_levels[element_position]) {
+        return false;
+    }
+
+    std::vector<int> reached{ element_position };
+    bool is_found{ false };
+    for (size_t i{}; i < reached.size() && !is_found; i++) {
+        for (const int& fanout : element_fanouts[reached[i]]) {
+            if (fanout == element) {
+                is_found = true;
+                break;
+            }
+            if (!is_pending[fanout] && element_levels[fanout] < element_levels[element]) {
+                is_pending[fanout] = true;
+                reached.push_back(fanout);
+            }
+        }
+    }
+    for (const int& position : reached) {
+        is_pending[position] = false;
+    }
+    return is_found;
+}
+
+
+// replaces the object at a position, pointing every element that used the old one at the new one
+void circuit::replace_element(const int& element_position, const std::shared_ptr<circuit_element>& new_element)
+{
+    std::shared_ptr<circuit_element> old_element{ circuit_elements[element_position] };
+    for (const int& fanout : element_fanouts[element_position]) {
+        circuit_elements[fanout]->replace_input_element(old_element, new_element);
+    }
+    new_element->set_output_status(old_element->get_output_status());
+    circuit_elements[element_position] = new_element;
+    is_plan_current = false;
+    is_element_memory_current = false;
+}
+
+
+// removes an element from the fanouts of its inputs; inputs left with no fanouts become outputs
+void circuit::disconnect_inputs(const int& element_position)
+{
+    if (get_element_type(circuit_elements[element_position]->get_gate_type()) == "input") {
+        return;
+    }
+    for (const int& input : circuit_elements[element_position]->get_input_elements_positions()) {
+        std::vector<int>& fanouts{ element_fanouts[input] };
+        fanouts.erase(std::find(fanouts.begin(), fanouts.end(), element_position));
+        if (fanouts.empty()) {
+            circuit_elements[input]->set_output_status(true);
+            is_output_index_current = false;
+        }
+    }
+}
+
+// adds an element to the fanouts of its inputs, which are no longer outputs
+void circuit::connect_inputs(const int& element_position)
+{
+    for (const int& input : circuit_elements[element_position]->get_input_elements_positions()) {
+        if (circuit_elements[input]->get_output_status()) {
+            circuit_elements[input]->update_output_status();
+            is_output_index_current = false;
+        }
+        element_fanouts[input].push_back(element_position);
+    }
+}
+
+
+// recalculates the level of an edited element, then of its fanouts for as long as they change.
+// each element is queued at most once at a time (marked in is_pending), and worked out from its inputs'
+// levels when it is reached, so it is queued again if one of its inputs changes after that.
+// cone hashes change all the way down the fanout cone, so they are only marked stale, to be
+// worked out again if a formula or truth table is asked for
+void circuit::update_fanout_cone(const int& element_position)
+{
+    mark_cone_hashes_stale(element_position);
+
+    std::vector<int> queued{ element_position };
+    is_pending[element_position] = true;
+    for (size_t i{}; i < queued.size(); i++) {
+        int position{ queued[i] };
+        is_pending[position] = false;
+        int level{ 0 };
+        if (get_element_type(circuit_elements[position]->get_gate_type()) != "input") {
+            for (const int& input : circuit_elements[position]->get_input_elements_positions()) {
+                level = std::max(level, element_levels[input] + 1);
+            }
+        }
+
+        if (i > 0 && level == element_levels[position]) {
+            continue;
+        }
+        element_levels[position] = level;
+        if (level >= static_cast<int>(pending_elements.size())) {
+            pending_elements.resize(level + 1);
+        }
+        for (const int& fanout : element_fanouts[position]) {
+            if (!is_pending[fanout]) {
+                is_pending[fanout] = true;
+                queued.push_back(fanout);
+            }
+        }
+    }
+    is_plan_current = false;
+    is_element_memory_current = false;
+}
+
+
+// marks the cone hashes of an element and everything it feeds as stale
+// the fanouts of a stale element are always stale too, so the search stops at stale elements
+void circuit::mark_cone_hashes_stale(const int& element_position)
+{
+    std::vector<int> marked{ element_position };
+    is_cone_hash_stale[element_position] = true;
+    for (size_t i{}; i < marked.size(); i++) {
+        for (const int& fanout : element_fanouts[marked[i]]) {
+            if (!is_cone_hash_stale[fanout]) {
+                is_cone_hash_stale[fanout] = true;
+                marked.push_back(fanout);
+            }
+        }
+    }
+}
+
+
+// an element's cone hash, first working out any stale hashes in its cone, inputs before the elements
+// they feed (an explicit stack is used, as cones can be deeper than the call stack allows)
+std::uint64_t circuit::get_cone_hash(const int& element_position) const
+{
+    std::vector<int> unhashed{ element_position };
+    while (!unhashed.empty()) {
+        int position{ unhashed.back() };
+        if (!is_cone_hash_stale[position]) {
+            unhashed.pop_back();
+            continue;
+        }
+
+        const std::shared_ptr<circuit_element>& element{ circuit_elements[position] };
+        std::uint64_t cone_hash{ std::hash<std::string>()(element->get_gate_type()) };
+        bool are_inputs_hashed{ true };
+        if (get_element_type(element->get_gate_type()) != "input") {
+            for (const int& input : element->get_input_elements_positions()) {
+                if (is_cone_hash_stale[input]) {
+                    unhashed.push_back(input);
+                    are_inputs_hashed = false;
+                }
+                cone_hash = combine_hash(cone_hash, cone_hashes[input]);
+            }
+        }
+        else {
+            cone_hash = combine_hash(cone_hash, position);
+        }
+
+        if (are_inputs_hashed) {
+            cone_hashes[position] = cone_hash;
+            is_cone_hash_stale[position] = false;
+            unhashed.pop_back();
+        }
+    }
+    return cone_hashes[element_position];
+}
+
+
+// passes on an edited element's new value, if it differs from its value before the edit
+void circuit::propagate_edit(const int& element_position, const std::uint64_t& previous_word)
+{
+    if (circuit_elements[element_position]->get_output_word() != previous_word) {
+        update_circuit(element_position);
+    }
+}
+
+
+int circuit::get_circuit_size() const
+{
+    return number_of_elements;
+}
+
+bool circuit::get_element_output(const int& element_position) const
+{
+    return circuit_elements[element_position]->get_output_value();
+}
+
+std::string circuit::get_element_gate_type(const int& element_position) const
+{
+    return circuit_elements[element_position]->get_gate_type();
+}
+
+std::vector<int> circuit::get_element_input_positions(const int& element_position) const
+{
+    return circuit_elements[element_position]->get_input_elements_positions();
+}
+
+std::string circuit::get_element_name(const int& element_position) const
+{
+    if (element_position < static_cast<int>(element_name_ids.size()) && element_name_ids[element_position] != -1) {
+        return element_names.get_name(element_name_ids[element_position]);
+    }
+    return get_element_letter(element_position);
+}
+
+// position of the element with the given name, or -1 if no element has it
+int circuit::find_element(const std::string& name) const
+{
+    int name_id{ element_names.find_name(name) };
+    return name_id == -1 ? -1 : named_elements[name_id];
+}
+
+// names (or renames) the element at a position, which may not have been created yet,
+// so netlists can name elements before finish_netlist creates them
+// returns false if another element already has the name
+bool circuit::set_element_name(const int& element_position, const std::string& name)
+{
+    int name_id{ element_names.add_name(name) };
+    if (name_id >= static_cast<int>(named_elements.size())) {
+        named_elements.resize(name_id + 1, -1);
+    }
+    if (named_elements[name_id] != -1 && named_elements[name_id] != element_position) {
+        return false;
+    }
+
+    if (element_position >= static_cast<int>(element_name_ids.size())) {
+        element_name_ids.resize(element_position + 1, -1);
+    }
+    // cached formulae contain element names, so they are dropped when an element is renamed
+    if (element_name_ids[element_position] != -1) {
+        named_elements[element_name_ids[element_position]] = -1;
+        cached_results.clear();
+    }
+    element_name_ids[element_position] = name_id;
+    named_elements[name_id] = element_position;
+    return true;
+}
+
+std::vector<int> circuit::get_input_positions() const
+{
+    return input_positions;
+}
+
+std::vector<bool> circuit::get_current_input_values() const
+{
+    std::vector<bool> current_input_values;
+
+    for (int i{}; i < number_of_inputs; i++) {
+        current_input_values.push_back(circuit_elements[input_positions[i]]->get_output_value());
+    }
+    return current_input_values;
+}
+
+// positions of all elements that are circuit outputs, in circuit order
+std::vector<int> circuit::get_output_positions() const
+{
+    update_output_index();
+    return circuit_outputs;
+}
+
+int circuit::get_number_of_outputs() const
+{
+    update_output_index();
+    return static_cast<int>(circuit_outputs.size());
+}
+
+
+// rebuilds the list of outputs if elements were added or edited since it was last built
+// changes not yet reported are kept for outputs that are still outputs; new outputs start unchanged
+void circuit::update_output_index() const
+{
+    if (is_output_index_current) {
+        return;
+    }
+    std::vector<int> previous_outputs;
+    previous_outputs.swap(circuit_outputs);
+    std::vector<int> previous_indices;
+    previous_indices.swap(output_indices);
+
+    output_indices.assign(number_of_elements, -1);
+    for (int position{}; position < number_of_elements; position++) {
+        if (circuit_elements[position]->get_output_status()) {
+            output_indices[position] = static_cast<int>(circuit_outputs.size());
+            circuit_outputs.push_back(position);
+        }
+    }
+
+    std::vector<char> previous_reported_values;
+    previous_reported_values.swap(reported_output_values);
+    std::vector<char> previous_notified_values;
+    previous_notified_values.swap(notified_output_values);
+    for (const int& position : circuit_outputs) {
+        bool is_previous_output{ position < static_cast<int>(previous_indices.size()) && previous_indices[position] != -1 };
+        char value{ circuit_elements[position]->get_output_value() };
+        reported_output_values.push_back(is_previous_output ? previous_reported_values[previous_indices[position]] : value);
+        notified_output_values.push_back(is_previous_output ? previous_notified_values[previous_indices[position]] : value);
+    }
+
+    std::vector<int> previous_changes;
+    previous_changes.swap(changed_outputs);
+    changed_output_bits.assign((circuit_outputs.size() + 63) / 64, 0);
+    for (const int& previous_index : previous_changes) {
+        // removed outputs are left in the previous list as -1 (see remove_element)
+        int previous_position{ previous_outputs[previous_index] };
+        int index{ previous_position == -1 ? -1 : output_indices[previous_position] };
+        if (index != -1) {
+            changed_output_bits[index / 64] |= std::uint64_t{ 1 } << (index % 64);
+            changed_outputs.push_back(index);
+        }
+    }
+    is_output_index_current = true;
+}
+
+int circuit::get_number_of_levels() const
+{
+    return get_evaluation_plan().get_number_of_levels();
+}
+
+// inputs are level 0, and every gate is one level above its highest input
+int circuit::get_element_level(const int& element_position) const
+{
+    return element_levels[element_position];
+}
+
+
+// rebuilds the evaluation plan if elements were added since it was last built
+const evaluation_plan& circuit::get_evaluation_plan() const
+{
+    if (!is_plan_current) {
+        COUNT(counters, plan_builds, 1);
+        plan.build(circuit_elements, element_levels, &counters);
+        is_plan_current = true;
+    }
+    return plan;
+}
+
+
+// with more than one thread, whole-circuit evaluations (set_input_values and truth tables)
+// are done level by level across a persistent pool of worker threads; 0 or 1 returns to serial
+// changes to a single input are still propagated by update_circuit, as they usually affect few elements
+void circuit::set_worker_threads(const int& number_of_threads)
+{
+    if (number_of_threads > 1) {
+        worker_pool.reset(new thread_pool(number_of_threads));
+    }
+    else {
+        worker_pool.reset();
+    }
+}
+
+
+// limits the memory used by cached formulae and truth tables
+// the least recently used results are dropped first
+void circuit::set_cache_memory_limit(const std::size_t& bytes)
+{
+    cache_memory_limit = bytes;
+    fit_cache_to_budget();
+}
+
+
+// limits the memory used by the whole circuit, 0 meaning no limit. with a budget set:
+// - netlists that would not fit are refused by finish_netlist
+// - truth tables too large to store in what is left are printed a chunk of rows at a time
+//   (without a budget, only those larger than maximum_truth_table_memory are)
+// - the result cache only keeps what fits in what is left, up to its own limit
+void circuit::set_memory_budget(const std::size_t& bytes)
+{
+    memory_budget = bytes;
+    fit_cache_to_budget();
+}
+
+std::size_t circuit::get_memory_budget() const
+{
+    return memory_budget;
+}
+
+
+// gives the circuit a library of its own, so the modules of netlists read into it are kept apart
+// from other circuits'. its module instances are only found while the library is in scope (see module_library_scope)
+void circuit::set_module_library(const std::shared_ptr<module_library>& library)
+{
+    modules = library;
+    is_element_memory_current = false;
+}
+
+module_library& circuit::get_module_library() const
+{
+    return modules ? *modules : get_default_module_library();
+}
+
+
+// memory used by each part of the circuit, found from the sizes of its containers
+memory_usage circuit::get_memory_usage() const
+{
+    memory_usage usage{};
+
+    usage.netlist = get_vector_memory(circuit_elements) + get_vector_memory(input_positions)
+        + get_vector_memory(element_levels) + get_vector_memory(element_fanouts)
+        + get_vector_memory(pending_elements) + get_vector_memory(is_pending)
+        + get_vector_memory(cone_hashes) + get_vector_memory(is_cone_hash_stale) + get_vector_memory(pending_netlist);
+    update_element_memory();
+    usage.netlist += element_memory_used;
+    for (const std::vector<int>& level : pending_elements) {
+        usage.netlist += get_vector_memory(level);
+    }
+    for (const netlist_entry& entry : pending_netlist) {
+        usage.netlist += get_vector_memory(entry.input_positions);
+    }
+
+    usage.names = element_names.get_memory_used() + get_vector_memory(element_name_ids)
+        + get_vector_memory(named_elements);
+    usage.evaluation_plan = plan.get_memory_used();
+    usage.value_arrays = get_vector_memory(level_values) + value_snapshots->get_memory_used();
+    usage.truth_table_buffers = truth_table_memory_peak;
+    usage.result_cache = cached_results.get_memory_used();
+    usage.modules = module_memory_used;
+    return usage;
+}
+
+
+// totals the memory of the elements, their fanout lists and their modules, the parts of get_memory_usage
+// that would take a pass over the whole circuit. the totals are kept until the circuit's structure changes,
+// so checking the memory budget does not walk the circuit each time
+void circuit::update_element_memory() const
+{
+    if (is_element_memory_current) {
+        return;
+    }
+    // a make_shared element also has a control block holding its reference counts
+    const std::size_t shared_pointer_overhead{ 16 };
+    element_memory_used = 0;
+    module_memory_used = 0;
+
+    std::set<std::string> module_names;
+    for (const auto& element : circuit_elements) {
+        element_memory_used += element->get_memory_used() + shared_pointer_overhead;
+        if (dynamic_cast<const module_instance_element*>(element.get()) != nullptr) {
+            module_names.insert(element->get_gate_type());
+        }
+    }
+    for (const std::vector<int>& fanouts : element_fanouts) {
+        element_memory_used += get_vector_memory(fanouts);
+    }
+    for (const std::string& module_name : module_names) {
+        module_memory_used += find_module(module_name)->get_memory_used();
+    }
+    is_element_memory_current = true;
+}
+
+
+// the part of the memory budget not currently in use
+// truth table buffers are left out, as they are only held while a table is being made
+std::size_t circuit::get_free_memory() const
+{
+    if (memory_budget == 0) {
+        return std::numeric_limits<std::size_t>::max();
+    }
+    memory_usage usage{ get_memory_usage() };
+    std::size_t memory_used{ usage.get_total() - usage.truth_table_buffers };
+    return memory_budget > memory_used ? memory_budget - memory_used : 0;
+}
+
+
+// the result cache gives up its memory before anything else, so it may only grow into the free budget
+void circuit::fit_cache_to_budget() const
+{
+    std::size_t free_memory{ get_free_memory() };
+    std::size_t cache_memory_used{ cached_results.get_memory_used() };
+    std::size_t budget_limit{ free_memory > std::numeric_limits<std::size_t>::max() - cache_memory_used ?
+        free_memory : cache_memory_used + free_memory };
+
+    cached_results.set_memory_limit(std::min(cache_memory_limit, budget_limit));
+}
+
+
+// flips value of chosen input then updates the whole circuit
+void circuit::change_input(const int& input_position)
+{
+    COUNT(counters, input_changes, 1);
+    circuit_elements[input_position]->update_output();
+    update_circuit(input_position);
+}
+
+
+// updates the elements affected by a change to the given input element
+// elements are updated level by level, so each is updated once after all of its inputs,
+// and an element is only updated if one of its inputs changed value
+void circuit::update_circuit(const int& input_position)
+{
+    TRACE_SCOPE("update_circuit");
+    TIME_SCOPE(counters, update_nanoseconds);
+    std::uint64_t events_propagated{};
+    std::uint64_t events_changed{};
+    bool is_recording_values{ value_snapshots->is_recording() };
+
+    update_output_index();
+    record_output_change(input_position);
+    if (change_log != nullptr) {
+        change_log->push_back(input_position);
+    }
+    if (is_recording_values) {
+        value_snapshots->record_change(input_position);
+    }
+    schedule_fanouts(input_position);
+    for (size_t level = element_levels[input_position] + 1; level < pending_elements.size(); level++) {
+        for (const int& position : pending_elements[level]) {
+            // bus cells can change an output other than output_value, so whole output words are compared
+            std::uint64_t previous_word{ circuit_elements[position]->get_output_word() };
+            circuit_elements[position]->update_output();
+            is_pending[position] = false;
+
+            if (circuit_elements[position]->get_output_word() != previous_word) {
+                schedule_fanouts(position);
+                record_output_change(position);
+                if (change_log != nullptr) {
+                    change_log->push_back(position);
+                }
+                if (is_recording_values) {
+                    value_snapshots->record_change(position);
+                }
+                events_changed++;
+            }
+        }
+        events_propagated += pending_elements[level].size();
+        COUNT_ELEMENT_EVALUATIONS(counters, pending_elements[level]);
+        pending_elements[level].clear();
+    }
+    COUNT(counters, events_propagated, events_propagated);
+    COUNT(counters, events_changed, events_changed);
+    notify_output_subscribers();
+    publish_values();
+}
+
+
+// marks an element's change if it is an output
+// only outputs of the current index are marked, so update_output_index must be called first
+void circuit::record_output_change(const int& element_position)
+{
+    int index{ output_indices[element_position] };
+    if (index == -1) {
+        return;
+    }
+    std::uint64_t bit{ std::uint64_t{ 1 } << (index % 64) };
+    if ((changed_output_bits[index / 64] & bit) == 0) {
+        changed_output_bits[index / 64] |= bit;
+        changed_outputs.push_back(index);
+    }
+    if (!output_subscriptions.empty()) {
+        propagation_changes.push_back(index);
+    }
+}
+
+
+// calls every subscriber for each output changed by the last update, in the order they were updated
+void circuit::notify_output_subscribers()
+{
+    for (const int& index : propagation_changes) {
+        int position{ circuit_outputs[index] };
+        char value{ circuit_elements[position]->get_output_value() };
+
+        if (value != notified_output_values[index]) {
+            notified_output_values[index] = value;
+            for (const output_subscription& subscription : output_subscriptions) {
+                subscription.callback(position, value != 0);
+            }
+        }
+    }
+    propagation_changes.clear();
+}
+
+
+// the callback is given the position and new value of each output that changes value,
+// once the change has propagated through the whole circuit; it must not change the circuit
+// returns an id for unsubscribe_from_outputs
+int circuit::subscribe_to_outputs(const std::function<void(const int&, const bool&)>& callback)
+{
+    update_output_index();
+    for (size_t i{}; i < circuit_outputs.size(); i++) {
+        notified_output_values[i] = circuit_elements[circuit_outputs[i]]->get_output_value();
+    }
+    output_subscriptions.push_back({ next_subscription_id, callback });
+    return next_subscription_id++;
+}
+
+void circuit::unsubscribe_from_outputs(const int& subscription_id)
+{
+    for (auto it = output_subscriptions.begin(); it != output_subscriptions.end(); it++) {
+        if (it->id == subscription_id) {
+            output_subscriptions.erase(it);
+            return;
+        }
+    }
+}
+
+
+// starts (or with nullptr, stops) adding the position of every element whose value changes to log,
+// for recorders such as vcd_writer that only want to look at what changed.
+// the owner empties the log as it reads it. an element can appear more than once, or be back to
+// its earlier value (eg. after an input is changed and changed back), so readers compare values themselves
+void circuit::set_change_log(std::vector<int>* log)
+{
+    change_log = log;
+}
+
+
+// makes the current element values the ones value_readers see; this is done after every update,
+// so only needs calling to publish elements added since, or before the first input change
+void circuit::publish_values()
+{
+    value_snapshots->publish(number_of_elements, [this](const int& position) {
+        return circuit_elements[position]->get_output_value() != 0;
+    });
+}
+
+value_buffers& circuit::get_value_buffers() const
+{
+    return *value_snapshots;
 }
 
-void circuit::add_element(const std::string gate_type, const int& input_position)
+
+// positions of the outputs whose value has changed since this was last called, in circuit order
+// takes time proportional to the number of outputs marked as changed, not the size of the circuit
+std::vector<int> circuit::take_changed_outputs()
 {
-    circuit_elements.push_back(std::make_shared<unary_gate_element>
-        (gate_type, circuit_elements[input_position]));
+    update_output_index();
+    std::vector<int> changed_positions;
 
-    circuit_elements[input_position]->update_output_status();
-    number_of_elements++;
+    for (const int& index : changed_outputs) {
+        changed_output_bits[index / 64] &= ~(std::uint64_t{ 1 } << (index % 64));
+        int position{ circuit_outputs[index] };
+        char value{ circuit_elements[position]->get_output_value() };
+
+        if (value != reported_output_values[index]) {
+            reported_output_values[index] = value;
+            changed_positions.push_back(position);
+        }
+    }
+    changed_outputs.clear();
+    std::sort(changed_positions.begin(), changed_positions.end());
+    return changed_positions;
 }
 
-void circuit::add_element(const std::string gate_type,
-    const int& input1_position, const int& input2_position)
+// fanouts are always on a higher level than the element, so the level being updated never grows
+void circuit::schedule_fanouts(const int& element_position)
 {
-    circuit_elements.push_back(std::make_shared<binary_gate_element>
-        (gate_type, circuit_elements[input1_position], circuit_elements[input2_position]));
-
-    circuit_elements[input1_position]->update_output_status();
-    circuit_elements[input2_position]->update_output_status();
-    number_of_elements++;
+    for (const int& fanout : element_fanouts[element_position]) {
+        if (!is_pending[fanout]) {
+            is_pending[fanout] = true;
+            pending_elements[element_levels[fanout]].push_back(fanout);
+        }
+    }
 }
 
 
-int circuit::get_circuit_size() const
+// sets every input at once (in get_input_positions() order) then evaluates the whole circuit
+// every output is marked as possibly changed, as checking them costs no more than the evaluation
+void circuit::set_input_values(const std::vector<bool>& input_values)
 {
-    return number_of_elements;
+    std::vector<std::uint64_t> previous_words;
+    if (change_log != nullptr) {
+        for (const auto& element : circuit_elements) {
+            previous_words.push_back(element->get_output_word());
+        }
+    }
+
+    for (int i{}; i < number_of_inputs; i++) {
+        circuit_elements[input_positions[i]]->set_output_value(input_values[i]);
+    }
+    evaluate_circuit_levels();
+
+    if (change_log != nullptr) {
+        for (int position{}; position < number_of_elements; position++) {
+            if (circuit_elements[position]->get_output_word() != previous_words[position]) {
+                change_log->push_back(position);
+            }
+        }
+    }
+
+    update_output_index();
+    for (const int& position : circuit_outputs) {
+        record_output_change(position);
+    }
+    notify_output_subscribers();
+    publish_values();
 }
 
-bool circuit::get_element_output(const int& element_position) const
+
+// evaluates every gate from the current input values using the levelized evaluation plan
+void circuit::evaluate_circuit_levels()
 {
-    return circuit_elements[element_position]->get_output_value();
+    TRACE_SCOPE("evaluate_levels");
+    const evaluation_plan& levelized_circuit{ get_evaluation_plan() };
+    COUNT(counters, level_evaluations, 1);
+    value_snapshots->mark_all_changed();
+
+    levelized_circuit.load_values(level_values);
+    levelized_circuit.evaluate_levels(level_values, worker_pool.get());
+    levelized_circuit.store_values(level_values, worker_pool.get());
 }
 
-std::vector<int> circuit::get_input_positions() const
+
+// evaluates many input vectors at once without changing the circuit's current input values
+// input_vectors has one row per input (in get_input_positions() order) and one column per vector;
+// the result has one row per output (in get_output_positions() order) and the same columns.
+// vectors are evaluated 64 at a time, one per bit of a word, and blocks of 64 vectors
+// are shared out across the worker pool when there is one.
+// returns an empty matrix if input_vectors does not have one row per input
+bit_matrix circuit::evaluate_batch(const bit_matrix& input_vectors) const
 {
-    return input_positions;
+    return evaluate_batch(input_vectors, get_output_positions());
 }
 
-std::vector<bool> circuit::get_current_input_values() const
+// as above, with one row of the result for each of the given elements
+// returns an empty matrix, too, if one of the elements is not in the circuit
+bit_matrix circuit::evaluate_batch(const bit_matrix& input_vectors, const std::vector<int>& output_positions) const
 {
-    std::vector<bool> current_input_values;
+    if (input_vectors.get_number_of_rows() != number_of_inputs) {
+        std::cerr << "\nError: the input vectors have " << input_vectors.get_number_of_rows()
+            << " rows but the circuit has " << number_of_inputs << " inputs\n";
+        return bit_matrix();
+    }
+    for (const int& position : output_positions) {
+        if (position < 0 || position >= number_of_elements) {
+            std::cerr << "\nError: there is no element at position " << position << " to evaluate\n";
+            return bit_matrix();
+        }
+    }
 
-    for (int i{}; i < number_of_inputs; i++) {
-        current_input_values.push_back(circuit_elements[input_positions[i]]->get_output_value());
+    const evaluation_plan& levelized_circuit{ get_evaluation_plan() };
+    int number_of_blocks{ input_vectors.get_words_per_row() };
+    bit_matrix output_vectors(static_cast<int>(output_positions.size()), input_vectors.get_number_of_columns());
+
+    std::vector<int> input_indices;
+    for (const int& position : input_positions) {
+        input_indices.push_back(levelized_circuit.get_evaluation_index(position));
     }
-    return current_input_values;
+    std::vector<int> output_indices;
+    for (const int& position : output_positions) {
+        output_indices.push_back(levelized_circuit.get_evaluation_index(position));
+    }
+
+    auto evaluate_blocks = [&](int first_block, int last_block) {
+        TRACE_SCOPE_ARGUMENT("batch_blocks", "first_block", first_block);
+        std::vector<std::uint64_t> values(levelized_circuit.get_size());
+        COUNT(counters, batch_blocks, last_block - first_block);
+
+        for (int block{ first_block }; block < last_block; block++) {
+            for (int i{}; i < number_of_inputs; i++) {
+                values[input_indices[i]] = input_vectors.get_word(i, block);
+            }
+            levelized_circuit.evaluate_words(values);
+            for (size_t i{}; i < output_indices.size(); i++) {
+                output_vectors.set_word(static_cast<int>(i), block, values[output_indices[i]]);
+            }
+        }
+    };
+
+    if (!worker_pool || number_of_blocks < 2) {
+        evaluate_blocks(0, number_of_blocks);
+    }
+    else {
+        int number_of_chunks{ std::min(number_of_blocks, worker_pool->get_number_of_threads() * 4) };
+        worker_pool->run_chunks(number_of_chunks, [&](int chunk) {
+            evaluate_blocks(number_of_blocks * chunk / number_of_chunks,
+                number_of_blocks * (chunk + 1) / number_of_chunks);
+        });
+    }
+
+    // bits beyond the last vector are left as 0
+    int unused_bits{ output_vectors.get_words_per_row() * 64 - output_vectors.get_number_of_columns() };
+    if (unused_bits > 0) {
+        for (int i{}; i < output_vectors.get_number_of_rows(); i++) {
+            int last_word{ output_vectors.get_words_per_row() - 1 };
+            output_vectors.set_word(i, last_word, output_vectors.get_word(i, last_word) & (~std::uint64_t{ 0 } >> unused_bits));
+        }
+    }
+    return output_vectors;
 }
 
 
-// flips value of chosen input then updates the whole circuit
-void circuit::change_input(const int& input_position)
+// values the given elements would have if the given inputs were set to the given values,
+// found on a scratch copy of the circuit's values, so the circuit itself is not changed
+std::vector<bool> circuit::evaluate_what_if(const std::vector<int>& changed_inputs, const std::vector<bool>& input_values,
+    const std::vector<int>& element_positions) const
 {
-    circuit_elements[input_position]->update_output();
-    update_circuit(input_position);
+    if (changed_inputs.size() != input_values.size()) {
+        std::cerr << "\nError: each changed input needs exactly one value\n";
+        return {};
+    }
+    for (const int& position : changed_inputs) {
+        if (std::find(input_positions.begin(), input_positions.end(), position) == input_positions.end()) {
+            std::cerr << "\nError: element " << position << " is not an input of the circuit\n";
+            return {};
+        }
+    }
+    for (const int& position : element_positions) {
+        if (position < 0 || position >= number_of_elements) {
+            std::cerr << "\nError: there is no element at position " << position << "\n";
+            return {};
+        }
+    }
+
+    const evaluation_plan& levelized_circuit{ get_evaluation_plan() };
+    std::vector<unsigned char> values;
+    levelized_circuit.load_values(values);
+
+    for (size_t i{}; i < changed_inputs.size(); i++) {
+        values[levelized_circuit.get_evaluation_index(changed_inputs[i])] = input_values[i];
+    }
+    levelized_circuit.evaluate_levels(values, worker_pool.get());
+
+    std::vector<bool> element_values;
+    for (const int& position : element_positions) {
+        element_values.push_back(values[levelized_circuit.get_evaluation_index(position)] != 0);
+    }
+    return element_values;
 }
 
 
-// updates all elements after the given input element
-// checks for input_elements so these don't get updated
-void circuit::update_circuit(const int& input_position)
+// evaluates the circuit for one set of four-valued input values (in get_input_positions() order)
+// returns the value of every element, indexed by element position, or an empty vector
+// if there is not one value per input. the circuit's current input values are left unchanged
+std::vector<logic_value> circuit::evaluate_four_valued(const std::vector<logic_value>& input_values) const
 {
-    int current_input_position = input_position;
-    int input_number{};
+    if (static_cast<int>(input_values.size()) != number_of_inputs) {
+        std::cerr << "\nError: " << input_values.size() << " input values were given for a circuit with "
+            << number_of_inputs << " inputs\n";
+        return {};
+    }
+    const evaluation_plan& levelized_circuit{ get_evaluation_plan() };
+    std::vector<std::uint64_t> can_be_zero(levelized_circuit.get_size());
+    std::vector<std::uint64_t> can_be_one(levelized_circuit.get_size());
 
     for (int i{}; i < number_of_inputs; i++) {
-        if (input_position == input_positions[i]) {
-            input_number = i;
-        }
+        int index{ levelized_circuit.get_evaluation_index(input_positions[i]) };
+        can_be_zero[index] = (input_values[i] == logic_value::zero || input_values[i] == logic_value::x) ? 1 : 0;
+        can_be_one[index] = (input_values[i] == logic_value::one || input_values[i] == logic_value::x) ? 1 : 0;
     }
+    levelized_circuit.evaluate_dual_rail(can_be_zero, can_be_one);
 
-    for (int i{ input_position }; i < circuit_elements.size(); i++) {
-        if (i != current_input_position) {
-            circuit_elements[i]->update_output();
+    std::vector<logic_value> element_values(number_of_elements);
+    for (int i{}; i < number_of_elements; i++) {
+        int index{ levelized_circuit.get_evaluation_index(i) };
+        if (can_be_zero[index] & can_be_one[index] & 1) {
+            element_values[i] = logic_value::x;
+        }
+        else if (can_be_one[index] & 1) {
+            element_values[i] = logic_value::one;
+        }
+        else if (can_be_zero[index] & 1) {
+            element_values[i] = logic_value::zero;
         }
-        else if (input_number + 1 != number_of_inputs) {
-            current_input_position = input_positions[++input_number];
+        else {
+            element_values[i] = logic_value::z;
         }
     }
+    return element_values;
 }
 
 
 void circuit::reset_circuit()
 {
-    if (get_circuit_size() != 0) {
-        circuit_elements[0]->reset_element_count();
-    }
     circuit_elements.clear();
     input_positions.clear();
     number_of_inputs = 0;
     number_of_elements = 0;
+    element_levels.clear();
+    element_fanouts.clear();
+    pending_elements.clear();
+    is_pending.clear();
+    cone_hashes.clear();
+    is_cone_hash_stale.clear();
+    input_set_hash = 0;
+    cached_results.clear();
+    element_names.clear();
+    element_name_ids.clear();
+    named_elements.clear();
+    pending_netlist.clear();
+    plan.clear();
+    is_plan_current = false;
+    is_element_memory_current = false;
+    level_values.clear();
+    truth_table_memory_peak = 0;
+    fit_cache_to_budget();
+    circuit_outputs.clear();
+    output_indices.clear();
+    is_output_index_current = true;
+    changed_output_bits.clear();
+    changed_outputs.clear();
+    reported_output_values.clear();
+    notified_output_values.clear();
+    propagation_changes.clear();
+    value_snapshots->mark_all_changed();
+    publish_values();
 }
 
 
+// sets every input (in get_input_positions() order), changing only those whose value differs
 void circuit::restore_input_values(const std::vector<bool>& input_values)
 {
     for (int i{}; i < number_of_inputs; i++) {
         if (input_values[i] != circuit_elements[input_positions[i]]->get_output_value()) {
-            change_input(i);
+            change_input(input_positions[i]);
         }
     }
 }
@@ -127,11 +1745,9 @@ void circuit::restore_input_values(const std::vector<bool>& input_values)
 
 void circuit::print_circuit_output() const
 {
-    for (int i{}; i < get_circuit_size(); i++) {
-        if (circuit_elements[i]->get_output_status()) {
-            std::cout << "Output " << get_element_letter(i) << " is "
-                << circuit_elements[i]->get_output_value() << "\n";
-        }
+    for (const int& output : get_output_positions()) {
+        std::cout << "Output " << get_element_name(output) << " is "
+            << circuit_elements[output]->get_output_value() << "\n";
     }
     std::cout << "\n";
 }
@@ -142,19 +1758,16 @@ void circuit::print_input_output_letters(const bool& ignore_output_position,
     const int& output_position)
 {
     for (const int& input : input_positions) {
-        std::cout << "   " << get_element_letter(input) << "   |";
+        std::cout << "   " << get_element_name(input) << "   |";
     }
 
     if (ignore_output_position) {
-        for (const auto& element : circuit_elements) {
-            if (element->get_output_status()) {
-                std::cout << "    " << get_element_letter(element->get_element_position())
-                    << "   |";
-            }
+        for (const int& output : get_output_positions()) {
+            std::cout << "    " << get_element_name(output) << "   |";
         }
     }
     else {
-        std::cout << "    " << get_element_letter(output_position)
+        std::cout << "    " << get_element_name(output_position)
             << "   |";
     }
     std::cout << "\n";
@@ -162,105 +1775,417 @@ void circuit::print_input_output_letters(const bool& ignore_output_position,
 
 
 // prints truth table for a given element, its gate type and its logic formula
-// for truth table: stores current input values,
-// tries all input combinations and obtains the output values, then restores original input values
 void circuit::element_truth_table(const int& element_position)
 {
-    std::cout << "Gate '" << get_element_letter(element_position)
+    std::cout << "Gate '" << get_element_name(element_position)
         << "' type is " << circuit_elements[element_position]->get_gate_type()
         << " gate.\nIt's logic formula is: "
-        << generate_logic_formula(circuit_elements[element_position])
-        << "\nTruth table:\n\n";
+        << get_element_formula(element_position) << "\n";
+    print_minimized_formula(element_position);
+    std::cout << "Truth table:\n\n";
 
-    std::vector<bool> stored_input_values{ get_current_input_values() };
-    std::vector<std::vector<bool>> inputs{ truth_table_inputs_generator(number_of_inputs) };
-    std::vector<std::vector<bool>> outputs(1);
-
-    for (int i{}; i < inputs[0].size(); i++) {
-        for (int j{}; j < number_of_inputs; j++) {
-            if (circuit_elements[input_positions[j]]->get_output_value() != inputs[j][i]) {
-                circuit_elements[input_positions[j]]->update_output();
-            }
-        }
-        update_circuit(0);
-        outputs[0].push_back(circuit_elements[element_position]->get_output_value());
+    print_input_output_letters(false, element_position);
+    if (!can_store_truth_table(1)) {
+        stream_truth_table({ element_position });
+        return;
     }
+    std::vector<std::vector<bool>> outputs{ get_truth_table_columns({ element_position }) };
+    std::vector<std::vector<bool>> inputs{ truth_table_inputs_generator(number_of_inputs) };
 
-    restore_input_values(stored_input_values);
-    print_input_output_letters(false, element_position);
     print_truth_table(inputs, outputs);
 }
 
 
-// stores current input values, gets circuit outputs for all input combinations,
-// then restores input values
+// prints the formula of each output, then the circuit's truth table
 void circuit::circuit_truth_table()
 {
     circuit_formula();
     std::cout << "Truth table for all inputs and outputs:\n\n";
 
-    std::vector<bool> stored_input_values{ get_current_input_values() };
+    std::vector<int> output_positions{ get_output_positions() };
+    print_input_output_letters(true, 0);
+    if (!can_store_truth_table(output_positions.size())) {
+        stream_truth_table(output_positions);
+        return;
+    }
+    std::vector<std::vector<bool>> outputs{ get_truth_table_columns(output_positions) };
     std::vector<std::vector<bool>> inputs{ truth_table_inputs_generator(number_of_inputs) };
-    std::vector<int> output_positions;
 
-    for (auto it = circuit_elements.begin(); it != circuit_elements.end(); it++) {
-        if ((*it)->get_output_status()) {
-            output_positions.push_back((*it)->get_element_position());
+    print_truth_table(inputs, outputs);
+}
+
+
+// gets the truth table column of each given element, for callers that want the values rather than
+// a printed table; rows are in the order given by truth_table_inputs_generator.
+// returns false, leaving columns empty, if the table is too large for the memory budget
+bool circuit::get_truth_table(const std::vector<int>& element_positions, std::vector<std::vector<bool>>& columns)
+{
+    columns.clear();
+    if (!can_store_truth_table(element_positions.size())) {
+        return false;
+    }
+    columns = get_truth_table_columns(element_positions);
+    return true;
+}
+
+
+// whether a truth table with the given number of output columns fits in the free memory budget
+// and in maximum_truth_table_memory. while it is made the table holds a column for each input and three
+// for each output (the evaluated column, its copy as a vector and the copy in the result cache)
+bool circuit::can_store_truth_table(const std::size_t& number_of_outputs) const
+{
+    if (number_of_inputs > maximum_stored_truth_table_inputs) {
+        return false;
+    }
+    std::size_t truth_table_memory{ get_truth_table_memory(number_of_inputs, number_of_inputs + 3 * number_of_outputs) };
+    return truth_table_memory <= maximum_truth_table_memory && truth_table_memory <= get_free_memory();
+}
+
+
+// the input columns of number_of_rows truth table rows, starting at row 64 * first_word
+static bit_matrix get_truth_table_inputs(const int& number_of_inputs, const std::uint64_t& first_word,
+    const int& number_of_rows)
+{
+    bit_matrix input_vectors(number_of_inputs, number_of_rows);
+    for (int i{}; i < number_of_inputs; i++) {
+        // the first input changes slowest, as in truth_table_inputs_generator
+        int bit{ number_of_inputs - 1 - i };
+        for (int word{}; word < input_vectors.get_words_per_row(); word++) {
+            input_vectors.set_word(i, word, get_truth_table_input_word(bit, first_word + word));
+        }
+    }
+    return input_vectors;
+}
+
+
+// prints the truth table of the given elements a chunk of rows at a time without storing it,
+// for tables too large for the memory budget; the columns are not cached, as they would not fit either
+void circuit::stream_truth_table(const std::vector<int>& element_positions) const
+{
+    if (number_of_inputs >= std::numeric_limits<std::uint64_t>::digits) {
+        std::cerr << "\nError: a truth table of " << number_of_inputs << " inputs has too many rows to print\n";
+        return;
+    }
+
+    TIME_SCOPE(counters, truth_table_nanoseconds);
+    std::uint64_t number_of_rows{ std::uint64_t{ 1 } << number_of_inputs };
+    COUNT(counters, truth_table_rows, number_of_rows);
+
+    print_truth_table_header(number_of_inputs, static_cast<int>(element_positions.size()));
+    std::vector<bool> input_values(number_of_inputs);
+    std::vector<bool> output_values(element_positions.size());
+
+    for (std::uint64_t first_row{}; first_row < number_of_rows; first_row += truth_table_chunk_rows) {
+        TRACE_SCOPE_ARGUMENT("truth_table_rows", "first_row", static_cast<std::int64_t>(first_row));
+
+        int chunk_rows{ static_cast<int>(std::min<std::uint64_t>(number_of_rows - first_row, truth_table_chunk_rows)) };
+        bit_matrix chunk_inputs{ get_truth_table_inputs(number_of_inputs, first_row / 64, chunk_rows) };
+        bit_matrix chunk_outputs{ evaluate_batch(chunk_inputs, element_positions) };
+
+        for (int row{}; row < chunk_rows; row++) {
+            for (int j{}; j < number_of_inputs; j++) {
+                input_values[j] = chunk_inputs.get_bit(j, row);
+            }
+            for (size_t j{}; j < element_positions.size(); j++) {
+                output_values[j] = chunk_outputs.get_bit(static_cast<int>(j), row);
+            }
+            print_truth_table_row(input_values, output_values);
+        }
+    }
+}
+
+
+// gets the truth table column (output value for every input combination) of each given element
+// columns are reused from the result cache where possible; the rest are found together by
+// evaluating every input combination 64 at a time on scratch values, so the circuit's own
+// values (and anything watching them) are left as they are
+std::vector<std::vector<bool>> circuit::get_truth_table_columns(const std::vector<int>& element_positions)
+{
+    std::vector<std::vector<bool>> columns(element_positions.size());
+    std::vector<int> missing_columns;
+    std::vector<int> missing_positions;
+
+    for (size_t i{}; i < element_positions.size(); i++) {
+        std::uint64_t key{ combine_hash(get_cone_hash(element_positions[i]), input_set_hash) };
+        if (!cached_results.find_truth_table(key, columns[i])) {
+            missing_columns.push_back(static_cast<int>(i));
+            missing_positions.push_back(element_positions[i]);
+        }
+    }
+    if (missing_columns.empty()) {
+        return columns;
+    }
+
+    TIME_SCOPE(counters, truth_table_nanoseconds);
+    fit_cache_to_budget();
+    int number_of_rows{ 1 << number_of_inputs };
+    COUNT(counters, truth_table_rows, number_of_rows);
+    truth_table_memory_peak = std::max(truth_table_memory_peak,
+        get_truth_table_memory(number_of_inputs, number_of_inputs + 3 * element_positions.size()));
+
+    TRACE_SCOPE("truth_table_rows");
+    bit_matrix missing_outputs{ evaluate_batch(get_truth_table_inputs(number_of_inputs, 0, number_of_rows), missing_positions) };
+    for (size_t i{}; i < missing_columns.size(); i++) {
+        std::vector<bool>& column{ columns[missing_columns[i]] };
+        column.resize(number_of_rows);
+        for (int row{}; row < number_of_rows; row++) {
+            column[row] = missing_outputs.get_bit(static_cast<int>(i), row);
         }
     }
+
+    for (const int& column : missing_columns) {
+        std::uint64_t key{ combine_hash(get_cone_hash(element_positions[column]), input_set_hash) };
+        cached_results.store_truth_table(key, columns[column]);
+    }
+    return columns;
+}
+
+
+// prints the truth table of every output with each input set to 0, 1 or X
+// 64 rows are evaluated at once with the dual-rail encoding used by evaluate_four_valued,
+// and printed straight away, so the 3^n row table is never held in memory
+// (Z inputs are not listed, as gates treat them exactly like X)
+void circuit::four_valued_truth_table() const
+{
+    // 3^40 is the largest power of 3 that fits in 64 bits
+    const int maximum_four_valued_inputs{ 40 };
+    if (number_of_inputs > maximum_four_valued_inputs) {
+        std::cerr << "\nError: a four-valued truth table of " << number_of_inputs << " inputs has too many rows to print\n";
+        return;
+    }
+    std::cout << "Truth table for all inputs and outputs, including unknown (X) inputs:\n\n";
+
+    const evaluation_plan& levelized_circuit{ get_evaluation_plan() };
+    std::vector<int> output_positions{ get_output_positions() };
     size_t number_of_outputs = output_positions.size();
-    std::vector<std::vector<bool>> outputs(number_of_outputs);
 
-    for (int i{}; i < inputs[0].size(); i++) {
+    std::uint64_t number_of_rows{ 1 };
+    for (int i{}; i < number_of_inputs; i++) {
+        number_of_rows *= 3;
+    }
+    const logic_value row_values[3]{ logic_value::zero, logic_value::one, logic_value::x };
+
+    std::vector<std::vector<logic_value>> block_inputs(64, std::vector<logic_value>(number_of_inputs));
+    std::vector<logic_value> output_values(number_of_outputs);
+    std::vector<std::uint64_t> can_be_zero(levelized_circuit.get_size());
+    std::vector<std::uint64_t> can_be_one(levelized_circuit.get_size());
+
+    for (const int& input : input_positions) {
+        std::cout << "   " << get_element_name(input) << "   |";
+    }
+    for (const int& output : output_positions) {
+        std::cout << "    " << get_element_name(output) << "   |";
+    }
+    std::cout << "\n";
+    print_truth_table_header(number_of_inputs, static_cast<int>(number_of_outputs));
+
+    for (std::uint64_t first_row{}; first_row < number_of_rows; first_row += 64) {
+        int block_size{ static_cast<int>(std::min<std::uint64_t>(64, number_of_rows - first_row)) };
+
+        // the first input changes slowest, as in truth_table_inputs_generator
         for (int j{}; j < number_of_inputs; j++) {
-            if (circuit_elements[input_positions[j]]->get_output_value() != inputs[j][i]) {
-                circuit_elements[input_positions[j]]->update_output();
+            int index{ levelized_circuit.get_evaluation_index(input_positions[j]) };
+            can_be_zero[index] = 0;
+            can_be_one[index] = 0;
+        }
+        for (int row{}; row < block_size; row++) {
+            std::uint64_t remaining_digits{ first_row + row };
+            for (int j{ number_of_inputs - 1 }; j >= 0; j--) {
+                logic_value value{ row_values[remaining_digits % 3] };
+                remaining_digits /= 3;
+                block_inputs[row][j] = value;
+
+                int index{ levelized_circuit.get_evaluation_index(input_positions[j]) };
+                if (value != logic_value::one) {
+                    can_be_zero[index] |= std::uint64_t{ 1 } << row;
+                }
+                if (value != logic_value::zero) {
+                    can_be_one[index] |= std::uint64_t{ 1 } << row;
+                }
             }
         }
-        update_circuit(0);
-        for (int j{}; j < number_of_outputs; j++) {
-            outputs[j].push_back(circuit_elements[output_positions[j]]->get_output_value());
+
+        levelized_circuit.evaluate_dual_rail(can_be_zero, can_be_one);
+
+        for (int row{}; row < block_size; row++) {
+            for (size_t j{}; j < number_of_outputs; j++) {
+                int index{ levelized_circuit.get_evaluation_index(output_positions[j]) };
+                bool could_be_zero{ ((can_be_zero[index] >> row) & 1) != 0 };
+                bool could_be_one{ ((can_be_one[index] >> row) & 1) != 0 };
+                output_values[j] = (could_be_zero && could_be_one) ? logic_value::x
+                    : (could_be_one ? logic_value::one : logic_value::zero);
+            }
+            print_four_valued_truth_table_row(block_inputs[row], output_values);
         }
     }
+}
+
+
+// prints the formula of every output with the given four-valued input values substituted in,
+// followed by the resulting output value
+void circuit::four_valued_formula(const std::vector<logic_value>& input_values) const
+{
+    std::vector<logic_value> element_values{ evaluate_four_valued(input_values) };
+    if (static_cast<int>(element_values.size()) != number_of_elements) {
+        return;
+    }
 
-    restore_input_values(stored_input_values);
-    print_input_output_letters(true, 0);
-    print_truth_table(inputs, outputs);
+    for (const int& output : get_output_positions()) {
+        std::cout << "Output " << get_element_name(output) << " logic formula: "
+            << get_element_formula(output) << "\n    = "
+            << generate_logic_formula(circuit_elements[output], &element_values) << " = "
+            << get_logic_value_symbol(element_values[output]) << "\n";
+    }
+    std::cout << "\n";
 }
 
 
 // prints formula for all outputs
 void circuit::circuit_formula() const
 {
-    std::string output_logic_formula{};
-    for (const auto& element : circuit_elements) {
-        if (element->get_output_status()) {
-            std::cout << "Output " << get_element_letter(element->get_element_position())
-                << " logic formula: ";
-            std::cout << generate_logic_formula(element);
-            std::cout << "\n";
-        }
+    fit_cache_to_budget();
+    for (const int& output : get_output_positions()) {
+        std::cout << "Output " << get_element_name(output) << " logic formula: ";
+        std::cout << get_element_formula(output);
+        std::cout << "\n";
+    }
+    std::cout << "\n";
+}
+
+
+// prints the minimized formula of every output (as a sum of products), for outputs whose cones are small enough
+void circuit::minimized_formula() const
+{
+    fit_cache_to_budget();
+    for (const int& output : get_output_positions()) {
+        std::cout << "Output " << get_element_name(output) << "\n";
+        print_minimized_formula(output);
     }
     std::cout << "\n";
 }
 
 
+// gets an element's formula from the result cache, generating and caching it if needed
+// an element's formula only depends on its cone, so the cone hash alone is the key
+std::string circuit::get_element_formula(const int& element_position) const
+{
+    std::string logic_formula;
+
+    std::uint64_t cone_hash{ get_cone_hash(element_position) };
+    if (!cached_results.find_formula(cone_hash, logic_formula)) {
+        logic_formula = generate_logic_formula(circuit_elements[element_position]);
+        cached_results.store_formula(cone_hash, logic_formula);
+    }
+    return logic_formula;
+}
+
+
+// circuit inputs in an element's cone, in input order
+std::vector<int> circuit::get_cone_inputs(const int& element_position) const
+{
+    std::vector<char> is_in_cone(number_of_elements, false);
+    std::vector<int> cone{ element_position };
+    is_in_cone[element_position] = true;
+    for (size_t i{}; i < cone.size(); i++) {
+        if (get_element_type(circuit_elements[cone[i]]->get_gate_type()) == "input") {
+            continue;
+        }
+        for (const int& input : circuit_elements[cone[i]]->get_input_elements_positions()) {
+            if (!is_in_cone[input]) {
+                is_in_cone[input] = true;
+                cone.push_back(input);
+            }
+        }
+    }
+
+    std::vector<int> cone_inputs;
+    for (const int& input : input_positions) {
+        if (is_in_cone[input]) {
+            cone_inputs.push_back(input);
+        }
+    }
+    return cone_inputs;
+}
+
+// a smallest sum of products (as far as the mode can find) equal to an element's function,
+// over just the inputs in its cone. returns an empty string if the cone has too many inputs for the mode
+std::string circuit::get_minimized_formula(const int& element_position, const minimization_mode& mode) const
+{
+    std::vector<int> cone_inputs{ get_cone_inputs(element_position) };
+    int number_of_cone_inputs{ static_cast<int>(cone_inputs.size()) };
+    if (number_of_cone_inputs > (mode == minimization_mode::exact ?
+            maximum_exact_minimization_inputs : maximum_minimization_inputs)) {
+        return "";
+    }
+
+    std::string minimized_formula;
+    std::uint64_t key{ combine_hash(get_cone_hash(element_position), mode == minimization_mode::exact ? 2 : 1) };
+    if (cached_results.find_formula(key, minimized_formula)) {
+        return minimized_formula;
+    }
+    TRACE_SCOPE_ARGUMENT("minimize_formula", "inputs", number_of_cone_inputs);
+
+    // the truth table has cone input i as bit i of the row number; other inputs are held at 0
+    const evaluation_plan& levelized_circuit{ get_evaluation_plan() };
+    std::vector<std::uint64_t> values(levelized_circuit.get_size(), 0);
+    std::vector<std::uint64_t> truth_table(number_of_cone_inputs > 6 ? std::size_t{ 1 } << (number_of_cone_inputs - 6) : 1);
+    for (size_t word{}; word < truth_table.size(); word++) {
+        for (int i{}; i < number_of_cone_inputs; i++) {
+            values[levelized_circuit.get_evaluation_index(cone_inputs[i])] = get_truth_table_input_word(i, word);
+        }
+        levelized_circuit.evaluate_words(values);
+        truth_table[word] = values[levelized_circuit.get_evaluation_index(element_position)];
+    }
+
+    std::vector<product_term> cover;
+    minimize_sum_of_products(truth_table, number_of_cone_inputs, mode, cover);
+    std::vector<std::string> input_names;
+    for (const int& input : cone_inputs) {
+        input_names.push_back(get_element_name(input));
+    }
+    minimized_formula = format_sum_of_products(cover, input_names);
+    cached_results.store_formula(key, minimized_formula);
+    return minimized_formula;
+}
+
+// prints an element's minimized formula, found exactly for small cones, unless its cone has too many inputs
+// minimization can take a while, so it is kept out of circuit_formula and the benchmarked paths
+void circuit::print_minimized_formula(const int& element_position) const
+{
+    std::size_t number_of_cone_inputs{ get_cone_inputs(element_position).size() };
+    if (number_of_cone_inputs > static_cast<std::size_t>(maximum_minimization_inputs)) {
+        std::cout << "    minimized: not found, as it depends on more than " << maximum_minimization_inputs << " inputs\n";
+        return;
+    }
+    minimization_mode mode{ number_of_cone_inputs <= static_cast<std::size_t>(maximum_printed_exact_minimization_inputs) ?
+        minimization_mode::exact : minimization_mode::heuristic };
+    std::cout << "    minimized: " << get_minimized_formula(element_position, mode) << "\n";
+}
+
+
 // creates a formula for the argument element by recursively creating formulas for its input elements
-std::string circuit::generate_logic_formula(const std::shared_ptr<circuit_element>& element) const
+// if element_values is given, inputs are shown by their value (0, 1, X or Z) instead of their letter
+std::string circuit::generate_logic_formula(const std::shared_ptr<circuit_element>& element,
+    const std::vector<logic_value>* element_values) const
 {
     std::stringstream current_logic_formula;
     std::string logic_formula;
     std::string element_type{ get_element_type(element->get_gate_type()) };
 
     if (element_type == "input") {
-        logic_formula = get_element_letter(element->get_element_position());
+        if (element_values != nullptr) {
+            logic_formula = get_logic_value_symbol((*element_values)[element->get_element_position()]);
+        }
+        else {
+            logic_formula = get_element_name(element->get_element_position());
+        }
     } 
     else if (element_type == "unary") {
         current_logic_formula << "("
             << element->get_gate_type() << " ";
 
         int input_element_position{ (element->get_input_elements_positions())[0] };
-        current_logic_formula << generate_logic_formula(circuit_elements[input_element_position])
+        current_logic_formula << generate_logic_formula(circuit_elements[input_element_position], element_values)
             << ")";
 
         logic_formula = current_logic_formula.str();
@@ -269,14 +2194,179 @@ std::string circuit::generate_logic_formula(const std::shared_ptr<circuit_elemen
         current_logic_formula << "(";
 
         int input1_element_position{ (element->get_input_elements_positions())[0] };
-        current_logic_formula << generate_logic_formula(circuit_elements[input1_element_position])
+        current_logic_formula << generate_logic_formula(circuit_elements[input1_element_position], element_values)
             << " " << element->get_gate_type() << " ";
 
         int input2_element_position{ (element->get_input_elements_positions())[1] };
-        current_logic_formula << generate_logic_formula(circuit_elements[input2_element_position])
+        current_logic_formula << generate_logic_formula(circuit_elements[input2_element_position], element_values)
             << ")";
 
         logic_formula = current_logic_formula.str();
     }
+    else if (element_type == "bit") {
+        std::string base_type;
+        int bit{};
+        parse_sized_gate_type(element->get_gate_type(), base_type, bit);
+
+        int input_element_position{ (element->get_input_elements_positions())[0] };
+        current_logic_formula << generate_logic_formula(circuit_elements[input_element_position], element_values)
+            << "[" << bit << "]";
+
+        logic_formula = current_logic_formula.str();
+    }
+    else if (element_type == "lut" || element_type == "wide" || element_type == "bus" || element_type == "module") {
+        current_logic_formula << element->get_gate_type() << "(";
+
+        std::vector<int> input_elements_positions{ element->get_input_elements_positions() };
+        for (size_t i{}; i < input_elements_positions.size(); i++) {
+            current_logic_formula << (i == 0 ? "" : ", ")
+                << generate_logic_formula(circuit_elements[input_elements_positions[i]], element_values);
+        }
+        current_logic_formula << ")";
+
+        logic_formula = current_logic_formula.str();
+    }
     return logic_formula;
 }
+
+
+// positions of the (at most number_of_elements_wanted) elements re-evaluated most often by update_circuit,
+// most evaluated first. these are the gates in the cones that input changes keep reaching
+std::vector<int> circuit::get_hottest_elements(const counter_totals& totals, const int& number_of_elements_wanted) const
+{
+    std::vector<int> positions;
+    for (int i{}; i < std::min(number_of_elements, static_cast<int>(totals.element_evaluations.size())); i++) {
+        if (totals.element_evaluations[i] > 0) {
+            positions.push_back(i);
+        }
+    }
+
+    auto is_hotter = [&totals](const int& position1, const int& position2) {
+        return totals.element_evaluations[position1] > totals.element_evaluations[position2];
+    };
+    int number_kept{ std::min(number_of_elements_wanted, static_cast<int>(positions.size())) };
+    std::partial_sort(positions.begin(), positions.begin() + number_kept, positions.end(), is_hotter);
+    positions.resize(number_kept);
+    return positions;
+}
+
+
+// ratio of two counts, or 0 if nothing has been counted yet
+static double get_rate(const double& count, const double& total)
+{
+    return total > 0 ? count / total : 0;
+}
+
+// prints the evaluation counters, the result cache hit rate and the most evaluated elements
+void circuit::print_statistics() const
+{
+#ifndef LCS_INSTRUMENTATION
+    std::cout << "Simulation counters were left out of this build (LCS_NO_INSTRUMENTATION).\n";
+#endif
+    counter_totals totals{ counters.collect() };
+    auto count = [&totals](const counter_id& counter) {
+        return static_cast<double>(totals.counts[static_cast<int>(counter)]);
+    };
+
+    std::cout << "Simulation counters:\n";
+    for (int i{}; i < static_cast<int>(counter_id::number_of_counters); i++) {
+        std::cout << "    " << get_counter_name(static_cast<counter_id>(i)) << ": " << totals.counts[i] << "\n";
+    }
+    std::uint64_t cache_lookups{ cached_results.get_number_of_hits() + cached_results.get_number_of_misses() };
+
+    std::cout << "\nElements re-evaluated per input change: "
+        << get_rate(count(counter_id::events_propagated), count(counter_id::input_changes))
+        << "\nMean update time: "
+        << get_rate(count(counter_id::update_nanoseconds), count(counter_id::input_changes)) / 1000 << " us"
+        << "\nTruth table rows per second: "
+        << get_rate(count(counter_id::truth_table_rows), count(counter_id::truth_table_nanoseconds) / 1e9)
+        << "\nResult cache hit rate: " << 100 * get_rate(static_cast<double>(cached_results.get_number_of_hits()),
+            static_cast<double>(cache_lookups)) << "% of " << cache_lookups << " lookups\n";
+
+    std::vector<int> hottest_elements{ get_hottest_elements(totals, 10) };
+    if (!hottest_elements.empty()) {
+        std::cout << "\nElements re-evaluated most often by input changes:\n";
+        for (const int& position : hottest_elements) {
+            std::cout << "    " << get_element_name(position) << " (" << circuit_elements[position]->get_gate_type()
+                << "): " << totals.element_evaluations[position] << "\n";
+        }
+    }
+    std::cout << "\n";
+}
+
+
+// prints how much memory each part of the circuit uses, and how much of the budget is left
+void circuit::print_memory_usage() const
+{
+    memory_usage usage{ get_memory_usage() };
+    std::cout << "Memory used:\n"
+        << "    netlist: " << format_memory_size(usage.netlist) << "\n"
+        << "    names: " << format_memory_size(usage.names) << "\n"
+        << "    evaluation plan: " << format_memory_size(usage.evaluation_plan) << "\n"
+        << "    value arrays: " << format_memory_size(usage.value_arrays) << "\n"
+        << "    truth table buffers (largest): " << format_memory_size(usage.truth_table_buffers) << "\n"
+        << "    result cache: " << format_memory_size(usage.result_cache)
+        << " (limit " << format_memory_size(cached_results.get_memory_limit()) << ")\n"
+        << "    modules (shared by their instances): " << format_memory_size(usage.modules) << "\n"
+        << "    total: " << format_memory_size(usage.get_total()) << "\n\n";
+
+    if (memory_budget == 0) {
+        std::cout << "No memory budget is set.\n\n";
+    }
+    else {
+        std::cout << "Memory budget: " << format_memory_size(memory_budget) << ", of which "
+            << format_memory_size(get_free_memory()) << " is free.\n\n";
+    }
+}
+
+
+// the same statistics as print_statistics as a JSON object, for scripts comparing runs
+// element evaluations are those done by update_circuit; whole-circuit evaluations
+// (level_evaluations) also evaluate every gate once each
+std::string circuit::get_statistics_json() const
+{
+    counter_totals totals{ counters.collect() };
+    std::stringstream json;
+
+#ifdef LCS_INSTRUMENTATION
+    json << "{\n  \"instrumentation\": true,\n  \"counters\": {";
+#else
+    json << "{\n  \"instrumentation\": false,\n  \"counters\": {";
+#endif
+    for (int i{}; i < static_cast<int>(counter_id::number_of_counters); i++) {
+        json << (i > 0 ? "," : "") << "\n    " << get_json_string(get_counter_name(static_cast<counter_id>(i)))
+            << ": " << totals.counts[i];
+    }
+    json << "\n  },\n  \"cache\": {\n    \"hits\": " << cached_results.get_number_of_hits()
+        << ",\n    \"misses\": " << cached_results.get_number_of_misses()
+        << ",\n    \"memory_used\": " << cached_results.get_memory_used() << "\n  },\n  \"memory\": {";
+
+    memory_usage usage{ get_memory_usage() };
+    json << "\n    \"netlist\": " << usage.netlist
+        << ",\n    \"names\": " << usage.names
+        << ",\n    \"evaluation_plan\": " << usage.evaluation_plan
+        << ",\n    \"value_arrays\": " << usage.value_arrays
+        << ",\n    \"truth_table_buffers\": " << usage.truth_table_buffers
+        << ",\n    \"result_cache\": " << usage.result_cache
+        << ",\n    \"modules\": " << usage.modules
+        << ",\n    \"total\": " << usage.get_total()
+        << ",\n    \"budget\": " << memory_budget << "\n  },\n  \"hottest_elements\": [";
+
+    std::vector<int> hottest_elements{ get_hottest_elements(totals, 10) };
+    for (size_t i{}; i < hottest_elements.size(); i++) {
+        const int& position{ hottest_elements[i] };
+        json << (i > 0 ? "," : "") << "\n    { \"name\": " << get_json_string(get_element_name(position))
+            << ", \"position\": " << position
+            << ", \"gate_type\": " << get_json_string(circuit_elements[position]->get_gate_type())
+            << ", \"evaluations\": " << totals.element_evaluations[position] << " }";
+    }
+    json << (hottest_elements.empty() ? "]\n}\n" : "\n  ]\n}\n");
+    return json.str();
+}
+
+void circuit::reset_statistics()
+{
+    counters.reset();
+    cached_results.reset_counts();
+    truth_table_memory_peak = 0;
+}
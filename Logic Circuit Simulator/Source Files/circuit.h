@@ -1,4 +1,4 @@
-// circuit.h (last modified: 03/07/22)
+// circuit.h (last modified: 18/10/26)
 // header file for circuit class definition and class member declarations
 // also contains definition of the destructor
 
@@ -8,7 +8,24 @@
 #include <memory>
 #include <vector>
 #include <unordered_map>
+#include <string>
+#include <cstdint>
+#include <cstddef>
+#include <functional>
+#include <ostream>
 #include "elements.h"
+#include "evaluation_plan.h"
+#include "thread_pool.h"
+#include "bit_matrix.h"
+#include "result_cache.h"
+#include "symbol_table.h"
+#include "instrumentation.h"
+#include "memory_usage.h"
+#include "value_buffers.h"
+#include "sop_minimization.h"
+
+
+class module_library;
 
 
 class circuit
@@ -19,30 +36,195 @@ private:
     int number_of_elements;
     int number_of_inputs;
 
+    // logic level and the elements each element outputs to, by element position
+    std::vector<int> element_levels;
+    std::vector<std::vector<int>> element_fanouts;
+    std::vector<std::vector<int>> pending_elements;
+    std::vector<char> is_pending;
+
+    // structural hash of each element's cone (the element and everything feeding it),
+    // and of the list of circuit inputs; together they key the cached formulae and truth tables.
+    // edits mark the hashes of the cones they change as stale, and get_cone_hash brings them up to date
+    mutable std::vector<std::uint64_t> cone_hashes;
+    mutable std::vector<char> is_cone_hash_stale;
+    std::uint64_t input_set_hash;
+    mutable result_cache cached_results;
+
+    // name of each element: element_name_ids maps positions to ids in element_names,
+    // and named_elements maps ids back to positions (-1 once a name is no longer used)
+    // elements not given a name get their letter as a name when they are created
+    symbol_table element_names;
+    std::vector<int> element_name_ids;
+    std::vector<int> named_elements;
+
+    // elements given to add_netlist_element, waiting to be sorted by finish_netlist
+    struct netlist_entry
+    {
+        bool is_defined;
+        std::string gate_type;
+        std::vector<int> input_positions;
+        bool input_value;
+    };
+    std::vector<netlist_entry> pending_netlist;
+
+    // levelized copy of the circuit used for parallel evaluation, rebuilt after the circuit changes
+    mutable evaluation_plan plan;
+    mutable bool is_plan_current;
+    std::unique_ptr<thread_pool> worker_pool;
+    std::vector<unsigned char> level_values;
+
+    // limit on the memory the circuit uses (0 for none); truth tables too large for what is left
+    // (or for maximum_truth_table_memory) are printed row by row instead of being stored,
+    // and the result cache shrinks to fit
+    std::size_t memory_budget;
+    std::size_t cache_memory_limit;
+    std::size_t truth_table_memory_peak;
+    mutable std::size_t element_memory_used;   // see update_element_memory
+    mutable std::size_t module_memory_used;
+    mutable bool is_element_memory_current;
+
+    // outputs of the circuit by output index, rebuilt after elements are added.
+    // output changes are marked in changed_output_bits (listed in changed_outputs) until taken, and
+    // gathered in propagation_changes while an update runs so subscribers can be told at the end.
+    // an output is only reported if its value differs from when it was last reported or notified,
+    // so one that changes and changes back is not reported
+    struct output_subscription
+    {
+        int id;
+        std::function<void(const int&, const bool&)> callback;
+    };
+    mutable std::vector<int> circuit_outputs;
+    mutable std::vector<int> output_indices;
+    mutable bool is_output_index_current;
+    mutable std::vector<std::uint64_t> changed_output_bits;
+    mutable std::vector<int> changed_outputs;
+    mutable std::vector<char> reported_output_values;
+    mutable std::vector<char> notified_output_values;
+    std::vector<int> propagation_changes;
+    std::vector<output_subscription> output_subscriptions;
+    int next_subscription_id;
+
+    // when set, the position of every element whose value changes is added to it (see set_change_log)
+    std::vector<int>* change_log;
+
+    // copies of the element values published after each update, for value_readers on other threads
+    std::unique_ptr<value_buffers> value_snapshots;
+
+    // the circuit's simulation counters (see instrumentation.h), added to by const members too
+    mutable simulation_counters counters;
+
+    // the library netlists read into the circuit add their modules to; null for the default library
+    std::shared_ptr<module_library> modules;
+
+    void evaluate_circuit_levels();
+    void connect_element(const int&);
+    bool can_use_inputs(const std::string&, const std::vector<int>&) const;
+    std::shared_ptr<circuit_element> make_element(const int&, const std::string&, const std::vector<int>&,
+        const bool&) const;
+    void replace_element(const int&, const std::shared_ptr<circuit_element>&);
+    void disconnect_inputs(const int&);
+    void connect_inputs(const int&);
+    bool is_in_fanout_cone(const int&, const int&);
+    void update_fanout_cone(const int&);
+    void mark_cone_hashes_stale(const int&);
+    std::uint64_t get_cone_hash(const int&) const;
+    void propagate_edit(const int&, const std::uint64_t&);
+    void discard_pending_netlist();
+    void schedule_fanouts(const int&);
+    void print_netlist_loop(const std::vector<int>&, std::ostream&) const;
+    std::vector<std::vector<bool>> get_truth_table_columns(const std::vector<int>&);
+    bool can_store_truth_table(const std::size_t&) const;
+    void stream_truth_table(const std::vector<int>&) const;
+    void update_element_memory() const;
+    std::size_t get_free_memory() const;
+    void fit_cache_to_budget() const;
+    void update_output_index() const;
+    void record_output_change(const int&);
+    void notify_output_subscribers();
+    std::vector<int> get_hottest_elements(const counter_totals&, const int&) const;
+    std::vector<int> get_cone_inputs(const int&) const;
+    void print_minimized_formula(const int&) const;
+
 public:
     circuit();
     ~circuit() {};
 
     void add_element(const bool&);
-    void add_element(const std::string, const int&);
-    void add_element(const std::string, const int&, const int&);
+    bool add_element(const std::string, const int&);
+    bool add_element(const std::string, const int&, const int&);
+    bool add_element(const std::string, const std::vector<int>&);
+    bool add_bus_cell(const std::string, const std::vector<int>&);
+    bool add_module_instance(const std::string, const std::vector<int>&);
+
+    void begin_netlist();
+    void add_netlist_element(const int&, const bool&);
+    void add_netlist_element(const int&, const std::string, const std::vector<int>&);
+    bool finish_netlist(std::ostream&);
+
+    bool set_element_type(const int&, const std::string&);
+    bool set_element_inputs(const int&, const std::vector<int>&);
+    bool remove_element(const int&);
+    int flatten_module_instances();
+    bool copy_circuit(circuit&) const;
 
     int get_circuit_size() const;
     bool get_element_output(const int&) const;
+    std::string get_element_gate_type(const int&) const;
+    std::vector<int> get_element_input_positions(const int&) const;
+    std::string get_element_name(const int&) const;
+    int find_element(const std::string&) const;
+    bool set_element_name(const int&, const std::string&);
     std::vector<int> get_input_positions() const;
     std::vector<bool> get_current_input_values() const;
+    std::vector<int> get_output_positions() const;
+    int get_number_of_outputs() const;
+    int get_number_of_levels() const;
+    int get_element_level(const int&) const;
+    const evaluation_plan& get_evaluation_plan() const;
+
+    void set_worker_threads(const int&);
+    void set_cache_memory_limit(const std::size_t&);
+    void set_memory_budget(const std::size_t&);
+    std::size_t get_memory_budget() const;
+    memory_usage get_memory_usage() const;
+    void set_module_library(const std::shared_ptr<module_library>&);
+    module_library& get_module_library() const;
 
     void change_input(const int&);
     void update_circuit(const int&);
+    void set_input_values(const std::vector<bool>&);
     void reset_circuit();
 
+    int subscribe_to_outputs(const std::function<void(const int&, const bool&)>&);
+    void unsubscribe_from_outputs(const int&);
+    std::vector<int> take_changed_outputs();
+    void set_change_log(std::vector<int>*);
+    void publish_values();
+    value_buffers& get_value_buffers() const;
+
+    bit_matrix evaluate_batch(const bit_matrix&) const;
+    bit_matrix evaluate_batch(const bit_matrix&, const std::vector<int>&) const;
+    std::vector<bool> evaluate_what_if(const std::vector<int>&, const std::vector<bool>&, const std::vector<int>&) const;
+    std::vector<logic_value> evaluate_four_valued(const std::vector<logic_value>&) const;
+
     void restore_input_values(const std::vector<bool>&);
     void print_circuit_output() const;
     void print_input_output_letters(const bool&, const int&);
     void element_truth_table(const int&);
     void circuit_truth_table();
     void circuit_formula() const;
-    std::string generate_logic_formula(const std::shared_ptr<circuit_element>&) const;
+    void minimized_formula() const;
+    std::string get_element_formula(const int&) const;
+    std::string get_minimized_formula(const int&, const minimization_mode&) const;
+    bool get_truth_table(const std::vector<int>&, std::vector<std::vector<bool>>&);
+    void four_valued_truth_table() const;
+    void four_valued_formula(const std::vector<logic_value>&) const;
+    void print_statistics() const;
+    void print_memory_usage() const;
+    std::string get_statistics_json() const;
+    void reset_statistics();
+    std::string generate_logic_formula(const std::shared_ptr<circuit_element>&,
+        const std::vector<logic_value>* element_values = nullptr) const;
 };
 
 #endif
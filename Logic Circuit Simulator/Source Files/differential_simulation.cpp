@@ -0,0 +1,316 @@
+// differential_simulation.cpp (last modified: 18/10/26)
+// Contains definition of all differential_simulator class members not defined in differential_simulation.h
+
+#include <iostream>
+#include <vector>
+#include <string>
+#include <memory>
+#include <unordered_map>
+#include <algorithm>
+#include <functional>
+#include <random>
+#include <cstdint>
+#include "differential_simulation.h"
+#include "circuit.h"
+#include "bit_matrix.h"
+#include "result_cache.h"
+#include "universal_functions.h"
+
+
+// circuits with up to this many inputs are compared on every input vector, larger ones on random vectors
+const int exhaustive_comparison_inputs{ 16 };
+const int random_comparison_vectors{ 1 << 16 };
+
+
+differential_simulator::differential_simulator() : original_size{}, number_of_original_inputs{},
+    number_of_shared_elements{}, difference_circuit{}, boundary_positions{}, added_input_values{}, difference_positions{},
+    shared_positions{}, compared_outputs{}, unmatched_outputs{} {}
+
+
+// hash of every element's cone, by element position. unlike the cone hashes a circuit keeps for itself,
+// inputs are hashed by their number among the original circuit's inputs (input_numbers, by position)
+// rather than by position, so the same logic has the same hash in both revisions
+std::vector<std::uint64_t> differential_simulator::get_structure_hashes(const circuit& source,
+    const std::vector<int>& input_numbers) const
+{
+    std::vector<int> topological_order(source.get_circuit_size());
+    for (int position{}; position < source.get_circuit_size(); position++) {
+        topological_order[position] = position;
+    }
+    std::stable_sort(topological_order.begin(), topological_order.end(), [&source](const int& a, const int& b) {
+        return source.get_element_level(a) < source.get_element_level(b);
+    });
+
+    std::vector<std::uint64_t> hashes(source.get_circuit_size());
+    for (const int& position : topological_order) {
+        std::string gate_type{ source.get_element_gate_type(position) };
+        std::uint64_t hash{ std::hash<std::string>()(gate_type) };
+        if (get_element_type(gate_type) == "input") {
+            hash = combine_hash(hash, input_numbers[position]);
+        }
+        else {
+            for (const int& input : source.get_element_input_positions(position)) {
+                hash = combine_hash(hash, hashes[input]);
+            }
+        }
+        hashes[position] = hash;
+    }
+    return hashes;
+}
+
+
+// matches the elements of revised to those of original, and copies the revised elements with no match
+// into the difference circuit. inputs and outputs are matched by name, so the revision may add, remove
+// or reorder elements. inputs the original does not have keep their current value in revised on every vector.
+// returns false if the circuits cannot be compared
+bool differential_simulator::match(const circuit& original, const circuit& revised)
+{
+    original_size = original.get_circuit_size();
+    std::vector<int> original_inputs{ original.get_input_positions() };
+    number_of_original_inputs = static_cast<int>(original_inputs.size());
+    compared_outputs.clear();
+    unmatched_outputs.clear();
+    boundary_positions.clear();
+    added_input_values.clear();
+    difference_circuit.reset(new circuit());
+
+    std::vector<int> original_input_numbers(original_size, -1);
+    for (int i{}; i < number_of_original_inputs; i++) {
+        original_input_numbers[original_inputs[i]] = i;
+    }
+    // inputs added by the revision are numbered after the original's, so never match
+    std::vector<int> revised_input_numbers(revised.get_circuit_size(), -1);
+    int next_added_input{ number_of_original_inputs };
+    for (const int& input : revised.get_input_positions()) {
+        int original_input{ original.find_element(revised.get_element_name(input)) };
+        bool is_original_input{ original_input != -1 && original_input_numbers[original_input] != -1 };
+        revised_input_numbers[input] = is_original_input ? original_input_numbers[original_input] : next_added_input++;
+    }
+
+    std::vector<std::uint64_t> original_hashes{ get_structure_hashes(original, original_input_numbers) };
+    std::vector<std::uint64_t> revised_hashes{ get_structure_hashes(revised, revised_input_numbers) };
+
+    std::unordered_map<std::uint64_t, int> original_cones;
+    for (int position{}; position < original_size; position++) {
+        original_cones.emplace(original_hashes[position], position);
+    }
+    shared_positions.assign(revised.get_circuit_size(), -1);
+    for (int position{}; position < revised.get_circuit_size(); position++) {
+        auto original_cone = original_cones.find(revised_hashes[position]);
+        if (original_cone != original_cones.end()) {
+            shared_positions[position] = original_cone->second;
+        }
+    }
+
+    // a bit select can only read a bus cell or module instance, so a new bit select of a shared one
+    // takes a copy of the cell with it. the cell's own inputs are shared, so this goes no further
+    for (int position{}; position < revised.get_circuit_size(); position++) {
+        if (shared_positions[position] == -1 && get_element_type(revised.get_element_gate_type(position)) == "bit") {
+            shared_positions[revised.get_element_input_positions(position)[0]] = -1;
+        }
+    }
+
+    // difference circuit: the shared elements the differing ones read come first, as its inputs
+    std::unordered_map<int, int> boundary_inputs;
+    std::vector<int> differing_elements;
+    for (int position{}; position < revised.get_circuit_size(); position++) {
+        if (shared_positions[position] != -1) {
+            continue;
+        }
+        differing_elements.push_back(position);
+        if (get_element_type(revised.get_element_gate_type(position)) == "input") {
+            added_input_values.push_back(revised.get_element_output(position));
+            continue;
+        }
+        for (const int& input : revised.get_element_input_positions(position)) {
+            if (shared_positions[input] != -1
+                    && boundary_inputs.emplace(shared_positions[input], static_cast<int>(boundary_positions.size())).second) {
+                boundary_positions.push_back(shared_positions[input]);
+            }
+        }
+    }
+    number_of_shared_elements = revised.get_circuit_size() - static_cast<int>(differing_elements.size());
+
+    int number_of_boundary_inputs{ static_cast<int>(boundary_positions.size()) };
+    difference_positions.assign(revised.get_circuit_size(), -1);
+    for (size_t i{}; i < differing_elements.size(); i++) {
+        difference_positions[differing_elements[i]] = number_of_boundary_inputs + static_cast<int>(i);
+    }
+    difference_circuit->begin_netlist();
+    for (int i{}; i < number_of_boundary_inputs; i++) {
+        difference_circuit->add_netlist_element(i, false);
+    }
+    for (const int& position : differing_elements) {
+        if (get_element_type(revised.get_element_gate_type(position)) == "input") {
+            difference_circuit->add_netlist_element(difference_positions[position], revised.get_element_output(position));
+            continue;
+        }
+        std::vector<int> inputs;
+        for (const int& input : revised.get_element_input_positions(position)) {
+            inputs.push_back(shared_positions[input] != -1 ?
+                boundary_inputs[shared_positions[input]] : difference_positions[input]);
+        }
+        difference_circuit->add_netlist_element(difference_positions[position], revised.get_element_gate_type(position), inputs);
+    }
+    if (!difference_circuit->finish_netlist(std::cerr)) {
+        return false;
+    }
+
+    // an output whose cone is the same in both revisions is the same on every vector, so is not simulated
+    for (const int& output : revised.get_output_positions()) {
+        std::string name{ revised.get_element_name(output) };
+        int original_position{ original.find_element(name) };
+        if (original_position == -1) {
+            unmatched_outputs.push_back(name);
+            continue;
+        }
+        compared_outputs.push_back(compared_output{ name, original_position, output,
+            original_hashes[original_position] == revised_hashes[output], -1 });
+    }
+    return true;
+}
+
+
+// simulates both revisions on the given input vectors, which have one row per input of the original
+// circuit (in get_input_positions() order) and one column per vector, as for circuit::evaluate_batch.
+// the original is simulated in full, and only the difference circuit on top of it.
+// returns false if the vectors do not fit, or the original has changed since match
+bool differential_simulator::simulate(const circuit& original, const bit_matrix& input_vectors)
+{
+    if (original.get_circuit_size() != original_size || input_vectors.get_number_of_rows() != number_of_original_inputs) {
+        std::cerr << "\nError: the input vectors do not fit the circuits that were matched\n";
+        return false;
+    }
+
+    // values needed from the original: the difference circuit's inputs, then for each output that
+    // can differ, its own value and, if the revised output is shared logic, the value of that logic
+    std::vector<int> original_rows{ boundary_positions };
+    std::vector<int> revised_rows;
+    std::vector<int> difference_rows;
+    for (compared_output& output : compared_outputs) {
+        output.first_mismatch = -1;
+        if (output.is_identical) {
+            continue;
+        }
+        original_rows.push_back(output.original_position);
+        if (shared_positions[output.revised_position] != -1) {
+            revised_rows.push_back(static_cast<int>(original_rows.size()));
+            original_rows.push_back(shared_positions[output.revised_position]);
+        }
+        else {
+            revised_rows.push_back(-1 - static_cast<int>(difference_rows.size()));
+            difference_rows.push_back(difference_positions[output.revised_position]);
+        }
+    }
+    bit_matrix original_values{ original.evaluate_batch(input_vectors, original_rows) };
+
+    bit_matrix difference_values;
+    if (!difference_rows.empty()) {
+        // the difference circuit's inputs are the boundary, then any inputs the revision added
+        int number_of_boundary_inputs{ static_cast<int>(boundary_positions.size()) };
+        bit_matrix boundary_values(number_of_boundary_inputs + static_cast<int>(added_input_values.size()),
+            input_vectors.get_number_of_columns());
+        for (int row{}; row < boundary_values.get_number_of_rows(); row++) {
+            for (int word{}; word < boundary_values.get_words_per_row(); word++) {
+                boundary_values.set_word(row, word, row < number_of_boundary_inputs ? original_values.get_word(row, word)
+                    : (added_input_values[row - number_of_boundary_inputs] ? ~std::uint64_t{ 0 } : 0));
+            }
+        }
+        difference_values = difference_circuit->evaluate_batch(boundary_values, difference_rows);
+    }
+
+    // bits beyond the last vector are 0 in both, so never mismatch
+    int next_row{ static_cast<int>(boundary_positions.size()) };
+    int next_output{};
+    for (compared_output& output : compared_outputs) {
+        if (output.is_identical) {
+            continue;
+        }
+        int original_row{ next_row++ };
+        int revised_row{ revised_rows[next_output++] };
+        if (revised_row >= 0) {
+            next_row++;
+        }
+        for (int word{}; word < original_values.get_words_per_row(); word++) {
+            std::uint64_t revised_word{ revised_row >= 0 ? original_values.get_word(revised_row, word)
+                : difference_values.get_word(-1 - revised_row, word) };
+            std::uint64_t mismatches{ original_values.get_word(original_row, word) ^ revised_word };
+            if (mismatches != 0) {
+                int bit{};
+                while (((mismatches >> bit) & 1) == 0) {
+                    bit++;
+                }
+                output.first_mismatch = word * 64 + bit;
+                break;
+            }
+        }
+    }
+    return true;
+}
+
+
+int differential_simulator::get_number_of_shared_elements() const
+{
+    return number_of_shared_elements;
+}
+
+// gates of the revised circuit evaluated again on every vector, as they differ from the original
+int differential_simulator::get_number_of_reevaluated_elements() const
+{
+    return difference_circuit ? difference_circuit->get_circuit_size() - static_cast<int>(difference_circuit->get_input_positions().size()) : 0;
+}
+
+int differential_simulator::get_number_of_compared_outputs() const
+{
+    return static_cast<int>(compared_outputs.size());
+}
+
+const std::string& differential_simulator::get_output_name(const int& output) const
+{
+    return compared_outputs[output].name;
+}
+
+// first input vector (column of the simulated vectors) on which the output differs, or -1 if it never does
+int differential_simulator::get_first_mismatch(const int& output) const
+{
+    return compared_outputs[output].first_mismatch;
+}
+
+// outputs of the revised circuit with no element of the same name in the original
+const std::vector<std::string>& differential_simulator::get_unmatched_outputs() const
+{
+    return unmatched_outputs;
+}
+
+// true once simulate has found every compared output the same, and every output of revised was compared
+bool differential_simulator::are_outputs_equal() const
+{
+    for (const compared_output& output : compared_outputs) {
+        if (output.first_mismatch != -1) {
+            return false;
+        }
+    }
+    return unmatched_outputs.empty();
+}
+
+
+bool is_comparison_exhaustive(const int& number_of_inputs)
+{
+    return number_of_inputs <= exhaustive_comparison_inputs;
+}
+
+// one row per input; as in truth tables, the first input is the most significant bit of the vector number
+bit_matrix get_comparison_vectors(const int& number_of_inputs)
+{
+    bool is_exhaustive{ is_comparison_exhaustive(number_of_inputs) };
+    bit_matrix input_vectors(number_of_inputs, is_exhaustive ? 1 << number_of_inputs : random_comparison_vectors);
+    std::mt19937_64 random_words{ 2026 };
+
+    for (int i{}; i < number_of_inputs; i++) {
+        for (int word{}; word < input_vectors.get_words_per_row(); word++) {
+            input_vectors.set_word(i, word, is_exhaustive ?
+                get_truth_table_input_word(number_of_inputs - 1 - i, word) : random_words());
+        }
+    }
+    return input_vectors;
+}
@@ -0,0 +1,71 @@
+// differential_simulation.h (last modified: 18/10/26)
+// header file for the differential_simulator class definition and class member declarations
+// a differential_simulator compares a revised circuit against the original it was edited from.
+// elements of the two revisions are matched by the structure of their cones, so logic an edit left
+// alone is simulated once, in the original, and only the revised cones that differ are evaluated again,
+// reading the shared logic's values from the original. each output is reported with the first
+// input vector on which the two revisions give different values
+
+#ifndef DIFFERENTIAL_SIMULATION_H
+#define DIFFERENTIAL_SIMULATION_H
+
+#include <vector>
+#include <string>
+#include <memory>
+#include <cstdint>
+#include "circuit.h"
+#include "bit_matrix.h"
+
+
+class differential_simulator
+{
+private:
+    // an output of the revised circuit, and the element of the original with the same name
+    struct compared_output
+    {
+        std::string name;
+        int original_position;
+        int revised_position;
+        bool is_identical;          // both have the same cone, so cannot differ
+        int first_mismatch;         // first input vector giving different values, or -1
+    };
+
+    int original_size;
+    int number_of_original_inputs;
+    int number_of_shared_elements;
+
+    // the revised elements that differ from the original, copied into a circuit of their own
+    // whose inputs are the shared elements they read (boundary_positions, in the original)
+    std::unique_ptr<circuit> difference_circuit;
+    std::vector<int> boundary_positions;
+    std::vector<bool> added_input_values;   // values of inputs the revision added, which are not in the vectors
+    std::vector<int> difference_positions;  // revised position -> position in difference_circuit, or -1
+    std::vector<int> shared_positions;      // revised position -> matching original position, or -1
+
+    std::vector<compared_output> compared_outputs;
+    std::vector<std::string> unmatched_outputs;
+
+    std::vector<std::uint64_t> get_structure_hashes(const circuit&, const std::vector<int>&) const;
+
+public:
+    differential_simulator();
+    ~differential_simulator() {};
+
+    bool match(const circuit& original, const circuit& revised);
+    bool simulate(const circuit& original, const bit_matrix& input_vectors);
+
+    int get_number_of_shared_elements() const;
+    int get_number_of_reevaluated_elements() const;
+    int get_number_of_compared_outputs() const;
+    const std::string& get_output_name(const int& output) const;
+    int get_first_mismatch(const int& output) const;
+    const std::vector<std::string>& get_unmatched_outputs() const;
+    bool are_outputs_equal() const;
+};
+
+
+// input vectors for comparing circuits: every vector for circuits with few inputs, random vectors otherwise
+bool is_comparison_exhaustive(const int& number_of_inputs);
+bit_matrix get_comparison_vectors(const int& number_of_inputs);
+
+#endif
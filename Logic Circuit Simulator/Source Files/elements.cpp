@@ -1,28 +1,40 @@
-// elements.cpp (last modified: 03/07/22)
+// elements.cpp (last modified: 18/10/26)
 // Contains definition of all members of element classes not defined in elements.h
 
 #include <vector>
 #include <string>
 #include <memory>
+#include <algorithm>
+#include <cstdint>
+#include <cstddef>
 #include "elements.h"
 #include "universal_functions.h"
+#include "module_definition.h"
+#include "evaluation_plan.h"
 
 
 // base class for all elements
 //
 // output_value defaults to true, but is updated by the derived element constructors
-circuit_element::circuit_element() :
-    element_position{ number_of_elements }, output_value{ true },
-    is_output_of_circuit{ true }, gate_type{}
-{
-    number_of_elements++;
-};
+// position is the element's place in its circuit, which also gives its letter
+circuit_element::circuit_element(const int& position) :
+    element_position{ position }, output_value{ true },
+    is_output_of_circuit{ true }, gate_type{}, code{ gate_code::input }, gate_parameter{ 0 } {}
+
+bool circuit_element::is_destruction_message_shown{ true };
 
 circuit_element::~circuit_element()
 {
-    std::cout << "Destructing " << "element '" << get_element_letter(element_position) << "'\n";
+    if (is_destruction_message_shown) {
+        std::cout << "Destructing " << "element '" << get_element_letter(element_position) << "'\n";
+    }
 };
 
+void circuit_element::show_destruction_messages(const bool& is_shown)
+{
+    is_destruction_message_shown = is_shown;
+}
+
 bool circuit_element::get_output_value() const
 {
     return output_value;
@@ -43,16 +55,67 @@ std::string circuit_element::get_gate_type() const
     return gate_type;
 }
 
+gate_code circuit_element::get_gate_code() const
+{
+    return code;
+}
+
+std::uint64_t circuit_element::get_gate_parameter() const
+{
+    return gate_parameter;
+}
+
+// sets the gate type, with its gate_code and parameter
+void circuit_element::set_gate_type(const std::string& new_gate_type)
+{
+    gate_type = new_gate_type;
+    code = ::get_gate_code(gate_type);
+    gate_parameter = 0;
+
+    if (code == gate_code::lut) {
+        int lut_inputs{};
+        parse_lut_gate_type(gate_type, lut_inputs, gate_parameter);
+    }
+    else if (get_element_type(gate_type) == "bus" || code == gate_code::bit_select) {
+        std::string base_type;
+        int size{};
+        parse_sized_gate_type(gate_type, base_type, size);
+        gate_parameter = static_cast<std::uint64_t>(size);
+    }
+}
+
+// used by the compiled evaluation routines, which calculate outputs outside of the elements
+void circuit_element::set_output_value(const bool& new_output_value)
+{
+    output_value = new_output_value;
+}
+
 void circuit_element::update_output_status()
 {
     is_output_of_circuit = false;
 }
 
-void circuit_element::reset_element_count()
+// used when an element's fanouts are edited, which can make it an output of the circuit again
+void circuit_element::set_output_status(const bool& is_output)
+{
+    is_output_of_circuit = is_output;
+}
+
+std::uint64_t circuit_element::get_output_word() const
+{
+    return output_value ? 1 : 0;
+}
+
+void circuit_element::set_output_word(const std::uint64_t& new_output_word)
+{
+    output_value = (new_output_word & 1) != 0;
+}
+
+// short gate types are stored inside the string itself, so only longer ones allocate memory
+std::size_t circuit_element::get_gate_type_memory() const
 {
-    number_of_elements = 0;
+    return gate_type.capacity() > 15 ? gate_type.capacity() + 1 : 0;
 }
-int circuit_element::number_of_elements{};
 
 
 
@@ -60,9 +123,9 @@ int circuit_element::number_of_elements{};
 // 
 // circuit input class
 
-input_element::input_element(const bool& input_value) : circuit_element{}
+input_element::input_element(const int& position, const bool& input_value) : circuit_element{ position }
 {
-    gate_type = "Input";
+    set_gate_type("Input");
     output_value = input_value;
 }
 
@@ -78,29 +141,32 @@ std::vector<int> input_element::get_input_elements_positions() const
     return std::vector<int>{get_element_position()};
 }
 
+// input_elements have no input elements to replace
+void input_element::replace_input_element(const std::shared_ptr<circuit_element>&,
+    const std::shared_ptr<circuit_element>&) {}
+
+std::size_t input_element::get_memory_used() const
+{
+    return sizeof(*this) + get_gate_type_memory();
+}
+
 
 
 // class for gates with a single input
 //
-unary_gate_element::unary_gate_element(const std::string new_gate_type,
+unary_gate_element::unary_gate_element(const int& position, const std::string new_gate_type,
     const std::shared_ptr<circuit_element>& set_input_element) :
-    circuit_element{}, input_element{ set_input_element }
+    circuit_element{ position }, input_element{ set_input_element }
 {
-    gate_type = new_gate_type;
+    set_gate_type(new_gate_type);
     update_output();
 }
 
-bool unary_gate_element::output_calculator(const std::vector<bool>& inputs) const
-{
-    return logic_operation(gate_type, inputs);
-}
-
 // calculates output based on output_value of its input element
 void unary_gate_element::update_output()
 {
-    std::vector<bool> inputs;
-    inputs.push_back(input_element->get_output_value());
-    output_value = output_calculator(inputs);
+    std::uint64_t input_word{ input_element->get_output_value() ? ~std::uint64_t{ 0 } : 0 };
+    output_value = (evaluate_gate_word(code, input_word, input_word) & 1) != 0;
 }
 
 std::vector<int> unary_gate_element::get_input_elements_positions() const
@@ -110,31 +176,38 @@ std::vector<int> unary_gate_element::get_input_elements_positions() const
     return input_elements_positions;
 }
 
+void unary_gate_element::replace_input_element(const std::shared_ptr<circuit_element>& old_input,
+    const std::shared_ptr<circuit_element>& new_input)
+{
+    if (input_element == old_input) {
+        input_element = new_input;
+    }
+}
+
+std::size_t unary_gate_element::get_memory_used() const
+{
+    return sizeof(*this) + get_gate_type_memory();
+}
+
 
 
 // class for gates with two inputs
 //
-binary_gate_element::binary_gate_element(const std::string set_gate_type,
+binary_gate_element::binary_gate_element(const int& position, const std::string new_gate_type,
     const std::shared_ptr<circuit_element>& set_input_element1, const std::shared_ptr<circuit_element>& set_input_element2) :
-    circuit_element{},
+    circuit_element{ position },
     input_element1{ set_input_element1 }, input_element2{ set_input_element2 }
 {
-    gate_type = set_gate_type;
+    set_gate_type(new_gate_type);
     update_output();
 }
 
-bool binary_gate_element::output_calculator(const std::vector<bool>& inputs) const
-{
-    return logic_operation(gate_type, inputs);
-}
-
 // calculates output based on output_value's of its 2 input elements
 void binary_gate_element::update_output()
 {
-    std::vector<bool> inputs;
-    inputs.push_back(input_element1->get_output_value());
-    inputs.push_back(input_element2->get_output_value());
-    output_value = output_calculator(inputs);
+    std::uint64_t input1_word{ input_element1->get_output_value() ? ~std::uint64_t{ 0 } : 0 };
+    std::uint64_t input2_word{ input_element2->get_output_value() ? ~std::uint64_t{ 0 } : 0 };
+    output_value = (evaluate_gate_word(code, input1_word, input2_word) & 1) != 0;
 }
 
 std::vector<int> binary_gate_element::get_input_elements_positions() const
@@ -143,4 +216,227 @@ std::vector<int> binary_gate_element::get_input_elements_positions() const
     input_elements_positions.push_back(input_element1->get_element_position());
     input_elements_positions.push_back(input_element2->get_element_position());
     return input_elements_positions;
-}
\ No newline at end of file
+}
+
+void binary_gate_element::replace_input_element(const std::shared_ptr<circuit_element>& old_input,
+    const std::shared_ptr<circuit_element>& new_input)
+{
+    if (input_element1 == old_input) {
+        input_element1 = new_input;
+    }
+    if (input_element2 == old_input) {
+        input_element2 = new_input;
+    }
+}
+
+std::size_t binary_gate_element::get_memory_used() const
+{
+    return sizeof(*this) + get_gate_type_memory();
+}
+
+
+
+// class for gates with any number of inputs
+//
+multi_input_gate_element::multi_input_gate_element(const int& position, const std::string new_gate_type,
+    const std::vector<std::shared_ptr<circuit_element>>& set_input_elements) :
+    circuit_element{ position }, input_elements{ set_input_elements }
+{
+    set_gate_type(new_gate_type);
+    update_output();
+}
+
+// calculates output based on output_value's of all its input elements
+void multi_input_gate_element::update_output()
+{
+    std::uint64_t input_words[maximum_wide_gate_inputs];
+    int number_of_inputs{ static_cast<int>(input_elements.size()) };
+    for (int i{}; i < number_of_inputs; i++) {
+        input_words[i] = input_elements[i]->get_output_value() ? ~std::uint64_t{ 0 } : 0;
+    }
+    output_value = (evaluate_gate_word(code, gate_parameter, input_words, number_of_inputs) & 1) != 0;
+}
+
+std::vector<int> multi_input_gate_element::get_input_elements_positions() const
+{
+    std::vector<int> input_elements_positions;
+    for (const auto& input : input_elements) {
+        input_elements_positions.push_back(input->get_element_position());
+    }
+    return input_elements_positions;
+}
+
+void multi_input_gate_element::replace_input_element(const std::shared_ptr<circuit_element>& old_input,
+    const std::shared_ptr<circuit_element>& new_input)
+{
+    for (auto& input : input_elements) {
+        if (input == old_input) {
+            input = new_input;
+        }
+    }
+}
+
+std::size_t multi_input_gate_element::get_memory_used() const
+{
+    return sizeof(*this) + get_gate_type_memory()
+        + input_elements.capacity() * sizeof(std::shared_ptr<circuit_element>);
+}
+
+
+
+// class for word-level bus cells
+//
+bus_cell_element::bus_cell_element(const int& position, const std::string new_gate_type,
+    const std::vector<std::shared_ptr<circuit_element>>& set_input_elements) :
+    circuit_element{ position }, input_elements{ set_input_elements }, output_word{}
+{
+    set_gate_type(new_gate_type);
+    update_output();
+}
+
+// calculates every output bit at once from the output_value's of all its input elements,
+// packed into operands as in bus_cell_operation
+void bus_cell_element::update_output()
+{
+    int width{ static_cast<int>(gate_parameter) };
+    std::uint64_t operands[3]{};
+    for (size_t i{}; i < input_elements.size(); i++) {
+        int operand{ std::min(static_cast<int>(i) / width, 2) };
+        int bit{ static_cast<int>(i) - operand * width };
+        operands[operand] |= static_cast<std::uint64_t>(input_elements[i]->get_output_value() ? 1 : 0) << bit;
+    }
+    set_output_word(bus_cell_operation(code, width, operands[0], operands[1], operands[2]));
+}
+
+std::vector<int> bus_cell_element::get_input_elements_positions() const
+{
+    std::vector<int> input_elements_positions;
+    for (const auto& input : input_elements) {
+        input_elements_positions.push_back(input->get_element_position());
+    }
+    return input_elements_positions;
+}
+
+void bus_cell_element::replace_input_element(const std::shared_ptr<circuit_element>& old_input,
+    const std::shared_ptr<circuit_element>& new_input)
+{
+    for (auto& input : input_elements) {
+        if (input == old_input) {
+            input = new_input;
+        }
+    }
+}
+
+std::size_t bus_cell_element::get_memory_used() const
+{
+    return sizeof(*this) + get_gate_type_memory()
+        + input_elements.capacity() * sizeof(std::shared_ptr<circuit_element>);
+}
+
+std::uint64_t bus_cell_element::get_output_word() const
+{
+    return output_word;
+}
+
+void bus_cell_element::set_output_word(const std::uint64_t& new_output_word)
+{
+    output_word = new_output_word;
+    output_value = (output_word & 1) != 0;
+}
+
+
+
+// class for module instances
+//
+module_instance_element::module_instance_element(const int& position, const std::string new_gate_type,
+    const std::vector<std::shared_ptr<circuit_element>>& set_input_elements) :
+    circuit_element{ position }, input_elements{ set_input_elements }, definition{ find_module(new_gate_type) },
+    output_word{}
+{
+    set_gate_type(new_gate_type);
+    update_output();
+}
+
+// packs the output_value's of its input elements into a word, first input as bit 0,
+// then runs the module's kernel on it
+void module_instance_element::update_output()
+{
+    std::uint64_t input_word{};
+    for (size_t i{}; i < input_elements.size(); i++) {
+        input_word |= static_cast<std::uint64_t>(input_elements[i]->get_output_value() ? 1 : 0) << i;
+    }
+    set_output_word(definition->evaluate(input_word));
+}
+
+std::vector<int> module_instance_element::get_input_elements_positions() const
+{
+    std::vector<int> input_elements_positions;
+    for (const auto& input : input_elements) {
+        input_elements_positions.push_back(input->get_element_position());
+    }
+    return input_elements_positions;
+}
+
+void module_instance_element::replace_input_element(const std::shared_ptr<circuit_element>& old_input,
+    const std::shared_ptr<circuit_element>& new_input)
+{
+    for (auto& input : input_elements) {
+        if (input == old_input) {
+            input = new_input;
+        }
+    }
+}
+
+// the module itself is shared, so is counted once by the circuit rather than by each instance
+std::size_t module_instance_element::get_memory_used() const
+{
+    return sizeof(*this) + get_gate_type_memory()
+        + input_elements.capacity() * sizeof(std::shared_ptr<circuit_element>);
+}
+
+std::uint64_t module_instance_element::get_output_word() const
+{
+    return output_word;
+}
+
+void module_instance_element::set_output_word(const std::uint64_t& new_output_word)
+{
+    output_word = new_output_word;
+    output_value = (output_word & 1) != 0;
+}
+
+
+
+// class for single output bits of bus cells and module instances
+//
+bit_select_element::bit_select_element(const int& position, const std::string new_gate_type,
+    const std::shared_ptr<circuit_element>& set_input_element) :
+    circuit_element{ position }, input_element{ set_input_element }
+{
+    set_gate_type(new_gate_type);
+    update_output();
+}
+
+// gate_parameter is the selected bit
+void bit_select_element::update_output()
+{
+    output_value = ((input_element->get_output_word() >> gate_parameter) & 1) != 0;
+}
+
+std::vector<int> bit_select_element::get_input_elements_positions() const
+{
+    return std::vector<int>{input_element->get_element_position()};
+}
+
+void bit_select_element::replace_input_element(const std::shared_ptr<circuit_element>& old_input,
+    const std::shared_ptr<circuit_element>& new_input)
+{
+    if (input_element == old_input) {
+        input_element = new_input;
+    }
+}
+
+std::size_t bit_select_element::get_memory_used() const
+{
+    return sizeof(*this) + get_gate_type_memory();
+}
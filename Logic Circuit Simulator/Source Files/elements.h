@@ -1,4 +1,4 @@
-// elements.h (last modified: 03/07/22)
+// elements.h (last modified: 18/10/26)
 // header file containing definitions of element classes, and declarations of their members
 // also contains definition of virtual member functions and the derived class's destructors
 
@@ -9,6 +9,8 @@
 #include <memory>
 #include <string>
 #include <iostream>
+#include <cstdint>
+#include <cstddef>
 #include "universal_functions.h"
 
 
@@ -17,27 +19,54 @@ class circuit_element
 {
 private:
     const int element_position;
-    static int number_of_elements;
     bool is_output_of_circuit;
 
+    // whether destroying an element prints a message; turned off when timing large circuits
+    static bool is_destruction_message_shown;
+
 protected:
     std::string gate_type;
     bool output_value;
 
+    // gate_type worked out once, when the element is made, so evaluating it never reads the string:
+    // the truth table of a lut gate, the width of a bus cell or the bit of a bit select, otherwise 0
+    gate_code code;
+    std::uint64_t gate_parameter;
+
+    void set_gate_type(const std::string&);
+    std::size_t get_gate_type_memory() const;
+
 public:
-    circuit_element();
+    circuit_element(const int& position);
     virtual ~circuit_element();
 
     virtual void update_output() = 0;
     virtual std::vector<int> get_input_elements_positions() const = 0;
 
+    // makes every input that is old_input use new_input instead, when the circuit replaces an element
+    virtual void replace_input_element(const std::shared_ptr<circuit_element>& old_input,
+        const std::shared_ptr<circuit_element>& new_input) = 0;
+
+    // approximate bytes used by the element, including memory it allocates
+    virtual std::size_t get_memory_used() const = 0;
+
     bool get_output_value() const;
     int get_element_position() const;
     bool get_output_status() const;
     std::string get_gate_type() const;
+    gate_code get_gate_code() const;
+    std::uint64_t get_gate_parameter() const;
 
+    void set_output_value(const bool&);
     void update_output_status();
-    void reset_element_count();
+    void set_output_status(const bool&);
+
+    static void show_destruction_messages(const bool&);
+
+    // every output of the element packed into a word, bit 0 being output_value
+    // only bus cells have more than one output
+    virtual std::uint64_t get_output_word() const;
+    virtual void set_output_word(const std::uint64_t&);
 };
 
 
@@ -47,11 +76,13 @@ public:
 class input_element : public circuit_element
 {
 public:
-    input_element(const bool& input_value);
+    input_element(const int& position, const bool& input_value);
     ~input_element() {};
 
     void update_output();
     std::vector<int> get_input_elements_positions() const;
+    void replace_input_element(const std::shared_ptr<circuit_element>&, const std::shared_ptr<circuit_element>&);
+    std::size_t get_memory_used() const;
 };
 
 
@@ -59,16 +90,17 @@ public:
 class unary_gate_element : public circuit_element
 {
 private:
-    const std::shared_ptr<circuit_element> input_element;
+    std::shared_ptr<circuit_element> input_element;
 
 public:
-    unary_gate_element(const std::string new_gate_type,
+    unary_gate_element(const int& position, const std::string new_gate_type,
         const std::shared_ptr<circuit_element>& set_input_element);
     ~unary_gate_element() {};
 
-    bool output_calculator(const std::vector<bool>& inputs) const;
     void update_output();
     std::vector<int> get_input_elements_positions() const;
+    void replace_input_element(const std::shared_ptr<circuit_element>&, const std::shared_ptr<circuit_element>&);
+    std::size_t get_memory_used() const;
 };
 
 
@@ -76,18 +108,106 @@ public:
 class binary_gate_element : public circuit_element
 {
 private:
-    const std::shared_ptr<circuit_element> input_element1;
-    const std::shared_ptr<circuit_element> input_element2;
+    std::shared_ptr<circuit_element> input_element1;
+    std::shared_ptr<circuit_element> input_element2;
 
 public:
-    binary_gate_element(const std::string set_gate_type,
+    binary_gate_element(const int& position, const std::string new_gate_type,
         const std::shared_ptr<circuit_element>& set_input_element1,
         const std::shared_ptr<circuit_element>& set_input_element2);
     ~binary_gate_element() {};
 
-    bool output_calculator(const std::vector<bool>& inputs) const;
     void update_output();
     std::vector<int> get_input_elements_positions() const;
+    void replace_input_element(const std::shared_ptr<circuit_element>&, const std::shared_ptr<circuit_element>&);
+    std::size_t get_memory_used() const;
+};
+
+
+// class for gates with any number of inputs, such as user-defined look-up table gates
+class multi_input_gate_element : public circuit_element
+{
+private:
+    std::vector<std::shared_ptr<circuit_element>> input_elements;
+
+public:
+    multi_input_gate_element(const int& position, const std::string new_gate_type,
+        const std::vector<std::shared_ptr<circuit_element>>& set_input_elements);
+    ~multi_input_gate_element() {};
+
+    void update_output();
+    std::vector<int> get_input_elements_positions() const;
+    void replace_input_element(const std::shared_ptr<circuit_element>&, const std::shared_ptr<circuit_element>&);
+    std::size_t get_memory_used() const;
+};
+
+
+// class for word-level bus cells (adders, comparators, multiplexers and shifters)
+// the cell evaluates all of its outputs at once on machine words;
+// each output bit is then shown in the circuit by a bit_select_element
+class bus_cell_element : public circuit_element
+{
+private:
+    std::vector<std::shared_ptr<circuit_element>> input_elements;
+    std::uint64_t output_word;
+
+public:
+    bus_cell_element(const int& position, const std::string new_gate_type,
+        const std::vector<std::shared_ptr<circuit_element>>& set_input_elements);
+    ~bus_cell_element() {};
+
+    void update_output();
+    std::vector<int> get_input_elements_positions() const;
+    void replace_input_element(const std::shared_ptr<circuit_element>&, const std::shared_ptr<circuit_element>&);
+    std::size_t get_memory_used() const;
+
+    std::uint64_t get_output_word() const;
+    void set_output_word(const std::uint64_t&);
+};
+
+
+class module_definition;
+
+// class for instances of modules (see module_definition.h)
+// the module's gates are shared by all of its instances and evaluated by its kernel, so an instance
+// only keeps its inputs and output word; as for bus cells, each output bit is shown by a bit_select_element
+class module_instance_element : public circuit_element
+{
+private:
+    std::vector<std::shared_ptr<circuit_element>> input_elements;
+    std::shared_ptr<const module_definition> definition;
+    std::uint64_t output_word;
+
+public:
+    module_instance_element(const int& position, const std::string new_gate_type,
+        const std::vector<std::shared_ptr<circuit_element>>& set_input_elements);
+    ~module_instance_element() {};
+
+    void update_output();
+    std::vector<int> get_input_elements_positions() const;
+    void replace_input_element(const std::shared_ptr<circuit_element>&, const std::shared_ptr<circuit_element>&);
+    std::size_t get_memory_used() const;
+
+    std::uint64_t get_output_word() const;
+    void set_output_word(const std::uint64_t&);
+};
+
+
+// class for elements giving one output bit of a bus cell or module instance
+class bit_select_element : public circuit_element
+{
+private:
+    std::shared_ptr<circuit_element> input_element;
+
+public:
+    bit_select_element(const int& position, const std::string new_gate_type,
+        const std::shared_ptr<circuit_element>& set_input_element);
+    ~bit_select_element() {};
+
+    void update_output();
+    std::vector<int> get_input_elements_positions() const;
+    void replace_input_element(const std::shared_ptr<circuit_element>&, const std::shared_ptr<circuit_element>&);
+    std::size_t get_memory_used() const;
 };
 
 
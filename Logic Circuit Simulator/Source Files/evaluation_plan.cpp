@@ -0,0 +1,761 @@
+// evaluation_plan.cpp (last modified: 18/10/26)
+// Contains definition of all evaluation_plan class members not defined in evaluation_plan.h
+
+#include <vector>
+#include <memory>
+#include <algorithm>
+#include <functional>
+#include <cstdint>
+#include <cstddef>
+#include "evaluation_plan.h"
+#include "elements.h"
+#include "thread_pool.h"
+#include "universal_functions.h"
+#include "instrumentation.h"
+#include "tracing.h"
+#include "memory_usage.h"
+#include "module_definition.h"
+
+
+// levels with fewer gates than this are evaluated by the calling thread alone,
+// since waking the workers would cost more than the level itself
+const int parallel_level_threshold{ 4096 };
+
+// chunks handed to workers are multiples of this many values (one cache line of bytes),
+// so no two threads ever write to the same cache line
+const int cache_line_size{ 64 };
+const int minimum_chunk_size{ 1024 };
+
+
+// evaluates a single gate for one set of input values
+static inline unsigned char evaluate_gate(const gate_code& code,
+    const unsigned char& input1, const unsigned char& input2)
+{
+    switch (code) {
+        case gate_code::not_gate:
+            return input1 ^ 1;
+        case gate_code::buffer_gate:
+            return input1;
+        case gate_code::and_gate:
+            return input1 & input2;
+        case gate_code::or_gate:
+            return input1 | input2;
+        case gate_code::nand_gate:
+            return (input1 & input2) ^ 1;
+        case gate_code::nor_gate:
+            return (input1 | input2) ^ 1;
+        case gate_code::xor_gate:
+            return input1 ^ input2;
+        case gate_code::xnor_gate:
+            return (input1 ^ input2) ^ 1;
+        default:
+            return input1;
+    }
+}
+
+
+// evaluates a single gate for 64 four-valued patterns encoded dual-rail:
+// each value is a pair of bits (could be 0, could be 1), so 0 = (1,0), 1 = (0,1), X = (1,1), Z = (0,0)
+// a Z input is read as X, since an undriven gate input could settle either way
+static inline void evaluate_gate_dual_rail(const gate_code& code,
+    std::uint64_t zero1, std::uint64_t one1, std::uint64_t zero2, std::uint64_t one2,
+    std::uint64_t& zero_out, std::uint64_t& one_out)
+{
+    std::uint64_t undriven1{ ~(zero1 | one1) };
+    std::uint64_t undriven2{ ~(zero2 | one2) };
+    zero1 |= undriven1;
+    one1 |= undriven1;
+    zero2 |= undriven2;
+    one2 |= undriven2;
+
+    switch (code) {
+        case gate_code::not_gate:
+            zero_out = one1;
+            one_out = zero1;
+            break;
+        case gate_code::and_gate:
+            zero_out = zero1 | zero2;
+            one_out = one1 & one2;
+            break;
+        case gate_code::or_gate:
+            zero_out = zero1 & zero2;
+            one_out = one1 | one2;
+            break;
+        case gate_code::nand_gate:
+            zero_out = one1 & one2;
+            one_out = zero1 | zero2;
+            break;
+        case gate_code::nor_gate:
+            zero_out = one1 | one2;
+            one_out = zero1 & zero2;
+            break;
+        case gate_code::xor_gate:
+            zero_out = (zero1 & zero2) | (one1 & one2);
+            one_out = (zero1 & one2) | (one1 & zero2);
+            break;
+        case gate_code::xnor_gate:
+            zero_out = (zero1 & one2) | (one1 & zero2);
+            one_out = (zero1 & zero2) | (one1 & one2);
+            break;
+        default:
+            zero_out = zero1;
+            one_out = one1;
+            break;
+    }
+}
+
+
+// evaluates a look-up table gate for one set of input values by indexing its truth table
+// the first input is the most significant bit of the row, as in logic_operation
+static inline unsigned char evaluate_lut(const std::uint64_t& mask, const int* inputs,
+    const int& number_of_inputs, const std::vector<unsigned char>& values)
+{
+    int row{ 0 };
+    for (int i{}; i < number_of_inputs; i++) {
+        row = (row << 1) | values[inputs[i]];
+    }
+    return static_cast<unsigned char>((mask >> row) & 1);
+}
+
+// evaluates a look-up table gate for 64 dual-rail four-valued patterns
+// the output could be 0 (or 1) if any row the inputs could select has a 0 (or 1) in the truth table
+static inline void evaluate_lut_dual_rail(const std::uint64_t& mask, const int* inputs,
+    const int& number_of_inputs, const std::vector<std::uint64_t>& can_be_zero,
+    const std::vector<std::uint64_t>& can_be_one, std::uint64_t& zero_out, std::uint64_t& one_out)
+{
+    zero_out = 0;
+    one_out = 0;
+
+    for (int row{}; row < (1 << number_of_inputs); row++) {
+        std::uint64_t is_possible_row{ ~std::uint64_t{ 0 } };
+        for (int i{}; i < number_of_inputs; i++) {
+            std::uint64_t undriven{ ~(can_be_zero[inputs[i]] | can_be_one[inputs[i]]) };
+            bool row_value{ ((row >> (number_of_inputs - 1 - i)) & 1) != 0 };
+            is_possible_row &= (row_value ? can_be_one[inputs[i]] : can_be_zero[inputs[i]]) | undriven;
+        }
+        if ((mask >> row) & 1) {
+            one_out |= is_possible_row;
+        }
+        else {
+            zero_out |= is_possible_row;
+        }
+    }
+}
+
+
+// evaluates an and/or/xor gate (or its inverse) with more than two inputs,
+// for one set of input values or for 64 at once; all_ones is 1 for single values and ~0 for words
+template <class value_type>
+static inline value_type evaluate_wide_gate(const gate_code& code, const int* inputs,
+    const int& number_of_inputs, const std::vector<value_type>& values, const value_type& all_ones)
+{
+    value_type result{ values[inputs[0]] };
+
+    if (code == gate_code::and_gate || code == gate_code::nand_gate) {
+        for (int i{ 1 }; i < number_of_inputs; i++) {
+            result &= values[inputs[i]];
+        }
+    }
+    else if (code == gate_code::or_gate || code == gate_code::nor_gate) {
+        for (int i{ 1 }; i < number_of_inputs; i++) {
+            result |= values[inputs[i]];
+        }
+    }
+    else {
+        for (int i{ 1 }; i < number_of_inputs; i++) {
+            result ^= values[inputs[i]];
+        }
+    }
+
+    if (code == gate_code::nand_gate || code == gate_code::nor_gate || code == gate_code::xnor_gate) {
+        result ^= all_ones;
+    }
+    return result;
+}
+
+// evaluates a wide gate for 64 dual-rail four-valued patterns by folding in one input at a time
+static inline void evaluate_wide_gate_dual_rail(const gate_code& code, const int* inputs,
+    const int& number_of_inputs, const std::vector<std::uint64_t>& can_be_zero,
+    const std::vector<std::uint64_t>& can_be_one, std::uint64_t& zero_out, std::uint64_t& one_out)
+{
+    gate_code base_code{ gate_code::xor_gate };
+    if (code == gate_code::and_gate || code == gate_code::nand_gate) {
+        base_code = gate_code::and_gate;
+    }
+    else if (code == gate_code::or_gate || code == gate_code::nor_gate) {
+        base_code = gate_code::or_gate;
+    }
+
+    std::uint64_t zero{};
+    std::uint64_t one{};
+    evaluate_gate_dual_rail(gate_code::buffer_gate, can_be_zero[inputs[0]], can_be_one[inputs[0]],
+        can_be_zero[inputs[0]], can_be_one[inputs[0]], zero, one);
+    for (int i{ 1 }; i < number_of_inputs; i++) {
+        evaluate_gate_dual_rail(base_code, zero, one, can_be_zero[inputs[i]], can_be_one[inputs[i]], zero, one);
+    }
+
+    bool is_inverted{ code == gate_code::nand_gate || code == gate_code::nor_gate || code == gate_code::xnor_gate };
+    zero_out = is_inverted ? one : zero;
+    one_out = is_inverted ? zero : one;
+}
+
+
+static inline bool is_bus_cell(const gate_code& code)
+{
+    return code == gate_code::add_cell || code == gate_code::compare_cell || code == gate_code::mux_cell
+        || code == gate_code::shift_left_cell || code == gate_code::shift_right_cell;
+}
+
+// number of evaluation indices (output bits) of a bus cell, as in get_number_of_gate_outputs
+static inline int get_bus_cell_outputs(const gate_code& code, const int& width)
+{
+    if (code == gate_code::add_cell) {
+        return width + 1;
+    }
+    return code == gate_code::compare_cell ? 3 : width;
+}
+
+// evaluates a bus cell for one set of input values on machine words:
+// the input bits are packed into operands, then bus_cell_operation does the arithmetic natively
+// output bit k is written to values[output_index + k]
+static inline void evaluate_bus_cell(const gate_code& code, const int& width, const int* inputs,
+    const int& number_of_inputs, std::vector<unsigned char>& values, const int& output_index)
+{
+    std::uint64_t operands[3]{};
+    for (int i{}; i < number_of_inputs; i++) {
+        int operand{ std::min(i / width, 2) };
+        operands[operand] |= static_cast<std::uint64_t>(values[inputs[i]]) << (i - operand * width);
+    }
+
+    std::uint64_t output_word{ bus_cell_operation(code, width, operands[0], operands[1], operands[2]) };
+    for (int k{}; k < get_bus_cell_outputs(code, width); k++) {
+        values[output_index + k] = static_cast<unsigned char>((output_word >> k) & 1);
+    }
+}
+
+// evaluates a bus cell for 64 sets of input values at once, bit-sliced:
+// each word holds one bit of an operand for all 64 sets, so an adder becomes a ripple of word
+// operations, a comparator a scan from the top bit and a shifter a few layers of multiplexers
+static inline void evaluate_bus_cell_words(const gate_code& code, const int& width, const int* inputs,
+    const int& number_of_inputs, std::vector<std::uint64_t>& values, const int& output_index)
+{
+    const int* operand1{ inputs };
+    const int* operand2{ inputs + width };
+
+    switch (code) {
+        case gate_code::add_cell: {
+            std::uint64_t carry{};
+            for (int i{}; i < width; i++) {
+                std::uint64_t a{ values[operand1[i]] };
+                std::uint64_t b{ values[operand2[i]] };
+                values[output_index + i] = a ^ b ^ carry;
+                carry = (a & b) | (carry & (a ^ b));
+            }
+            values[output_index + width] = carry;
+            break;
+        }
+        case gate_code::compare_cell: {
+            std::uint64_t equal{ ~std::uint64_t{ 0 } };
+            std::uint64_t less{};
+            std::uint64_t greater{};
+            for (int i{ width - 1 }; i >= 0; i--) {
+                std::uint64_t a{ values[operand1[i]] };
+                std::uint64_t b{ values[operand2[i]] };
+                less |= equal & ~a & b;
+                greater |= equal & a & ~b;
+                equal &= ~(a ^ b);
+            }
+            values[output_index] = equal;
+            values[output_index + 1] = less;
+            values[output_index + 2] = greater;
+            break;
+        }
+        case gate_code::mux_cell: {
+            std::uint64_t select{ values[inputs[2 * width]] };
+            for (int i{}; i < width; i++) {
+                values[output_index + i] = (select & values[operand2[i]]) | (~select & values[operand1[i]]);
+            }
+            break;
+        }
+        default: {
+            // shift amount bit j moves every bit by 2^j places where it is set
+            std::uint64_t bits[maximum_bus_width];
+            std::uint64_t shifted_bits[maximum_bus_width];
+            for (int i{}; i < width; i++) {
+                bits[i] = values[operand1[i]];
+            }
+            for (int j{}; j < number_of_inputs - width; j++) {
+                std::uint64_t select{ values[operand2[j]] };
+                int distance{ 1 << j };
+                for (int i{}; i < width; i++) {
+                    int source{ code == gate_code::shift_left_cell ? i - distance : i + distance };
+                    std::uint64_t moved{ (source >= 0 && source < width) ? bits[source] : 0 };
+                    shifted_bits[i] = (select & moved) | (~select & bits[i]);
+                }
+                std::copy(shifted_bits, shifted_bits + width, bits);
+            }
+            for (int i{}; i < width; i++) {
+                values[output_index + i] = bits[i];
+            }
+            break;
+        }
+    }
+}
+
+// evaluates a bus cell for 64 dual-rail four-valued patterns
+// a pattern with any unknown or undriven input gives unknown outputs; the others are evaluated
+// bit-sliced on the can_be_one rail, which holds the known input values
+static inline void evaluate_bus_cell_dual_rail(const gate_code& code, const int& width, const int* inputs,
+    const int& number_of_inputs, std::vector<std::uint64_t>& can_be_zero,
+    std::vector<std::uint64_t>& can_be_one, const int& output_index)
+{
+    std::uint64_t is_unknown{};
+    for (int i{}; i < number_of_inputs; i++) {
+        std::uint64_t zero{ can_be_zero[inputs[i]] };
+        std::uint64_t one{ can_be_one[inputs[i]] };
+        is_unknown |= (zero & one) | ~(zero | one);
+    }
+
+    evaluate_bus_cell_words(code, width, inputs, number_of_inputs, can_be_one, output_index);
+    for (int k{}; k < get_bus_cell_outputs(code, width); k++) {
+        std::uint64_t output{ can_be_one[output_index + k] };
+        can_be_zero[output_index + k] = ~output | is_unknown;
+        can_be_one[output_index + k] = output | is_unknown;
+    }
+}
+
+
+// evaluates a module instance for one set of input values with its module's kernel
+// output bit k is written to values[output_index + k], as for bus cells
+static inline void evaluate_module_instance(const module_definition& module, const int* inputs,
+    const int& number_of_inputs, std::vector<unsigned char>& values, const int& output_index)
+{
+    std::uint64_t input_word{};
+    for (int i{}; i < number_of_inputs; i++) {
+        input_word |= static_cast<std::uint64_t>(values[inputs[i]]) << i;
+    }
+
+    std::uint64_t output_word{ module.evaluate(input_word) };
+    for (int k{}; k < module.get_number_of_outputs(); k++) {
+        values[output_index + k] = static_cast<unsigned char>((output_word >> k) & 1);
+    }
+}
+
+// evaluates a module instance for 64 sets of input values at once
+// module_values is scratch space for the module's kernel, shared by every instance
+static inline void evaluate_module_instance_words(const module_definition& module, const int* inputs,
+    const int& number_of_inputs, std::vector<std::uint64_t>& values, const int& output_index,
+    std::vector<std::uint64_t>& module_values)
+{
+    std::uint64_t input_words[maximum_module_ports];
+    for (int i{}; i < number_of_inputs; i++) {
+        input_words[i] = values[inputs[i]];
+    }
+    module.evaluate_words(input_words, values.data() + output_index, module_values);
+}
+
+// evaluates a module instance for 64 dual-rail four-valued patterns
+static inline void evaluate_module_instance_dual_rail(const module_definition& module, const int* inputs,
+    const int& number_of_inputs, std::vector<std::uint64_t>& can_be_zero,
+    std::vector<std::uint64_t>& can_be_one, const int& output_index,
+    std::vector<std::uint64_t>& module_can_be_zero, std::vector<std::uint64_t>& module_can_be_one)
+{
+    std::uint64_t inputs_can_be_zero[maximum_module_ports];
+    std::uint64_t inputs_can_be_one[maximum_module_ports];
+    for (int i{}; i < number_of_inputs; i++) {
+        inputs_can_be_zero[i] = can_be_zero[inputs[i]];
+        inputs_can_be_one[i] = can_be_one[inputs[i]];
+    }
+    module.evaluate_dual_rail(inputs_can_be_zero, inputs_can_be_one,
+        can_be_zero.data() + output_index, can_be_one.data() + output_index, module_can_be_zero, module_can_be_one);
+}
+
+
+// splits [begin, end) into chunks whose boundaries fall on cache lines of values
+// then runs chunk_task on every chunk across the thread pool
+static void run_aligned_chunks(const int& begin, const int& end, const unsigned char* values,
+    thread_pool& pool, const std::function<void(int, int)>& chunk_task)
+{
+    int chunk_size{ (end - begin) / (pool.get_number_of_threads() * 4) };
+    chunk_size = std::max(chunk_size, minimum_chunk_size);
+    chunk_size = (chunk_size + cache_line_size - 1) / cache_line_size * cache_line_size;
+
+    int misalignment{ static_cast<int>(reinterpret_cast<std::uintptr_t>(values) % cache_line_size) };
+
+    std::vector<int> boundaries{ begin };
+    for (int next{ begin + chunk_size }; next < end; next += chunk_size) {
+        int aligned{ (next + misalignment) / cache_line_size * cache_line_size - misalignment };
+        if (aligned > boundaries.back()) {
+            boundaries.push_back(aligned);
+        }
+    }
+    boundaries.push_back(end);
+
+    pool.run_chunks(static_cast<int>(boundaries.size()) - 1, [&boundaries, &chunk_task](int chunk) {
+        chunk_task(boundaries[chunk], boundaries[chunk + 1]);
+    });
+}
+
+
+evaluation_plan::evaluation_plan() :
+    element_order{}, evaluation_indices{}, element_levels{}, level_starts{},
+    gate_codes{}, gate_parameters{}, first_input{}, input_indices{}, ordered_elements{}, modules{}, counters{ nullptr } {}
+
+
+// lays the elements out level by level, given the logic level of each element
+// a counting sort groups elements by level; within a level, elements are then ordered by
+// the evaluation index of their first input, so neighbouring gates read neighbouring values.
+// the output bits of a bus cell or module instance take consecutive indices, and its bit selects read them directly
+// counts of the gates the plan evaluates are added to set_counters, unless it is null
+void evaluation_plan::build(const std::vector<std::shared_ptr<circuit_element>>& elements,
+    const std::vector<int>& levels, simulation_counters* set_counters)
+{
+    TRACE_SCOPE("build_evaluation_plan");
+    clear();
+    counters = set_counters;
+    int number_of_elements{ static_cast<int>(elements.size()) };
+    int number_of_levels{ 0 };
+    element_levels.assign(levels.begin(), levels.begin() + number_of_elements);
+
+    for (const int& level : element_levels) {
+        number_of_levels = std::max(number_of_levels, level + 1);
+    }
+
+    std::vector<gate_code> element_codes(number_of_elements);
+    std::vector<int> element_slots(number_of_elements, 1);
+    for (int i{}; i < number_of_elements; i++) {
+        element_codes[i] = elements[i]->get_gate_code();
+        if (is_bus_cell(element_codes[i]) || element_codes[i] == gate_code::module_instance) {
+            element_slots[i] = get_number_of_gate_outputs(elements[i]->get_gate_type());
+        }
+    }
+
+    level_starts.assign(number_of_levels + 1, 0);
+    std::vector<int> level_element_starts(number_of_levels + 1, 0);
+    for (int i{}; i < number_of_elements; i++) {
+        level_starts[element_levels[i] + 1] += element_slots[i];
+        level_element_starts[element_levels[i] + 1]++;
+    }
+    for (int l{}; l < number_of_levels; l++) {
+        level_starts[l + 1] += level_starts[l];
+        level_element_starts[l + 1] += level_element_starts[l];
+    }
+
+    std::vector<int> next_slot(level_element_starts.begin(), level_element_starts.end() - 1);
+    std::vector<int> positions_by_level(number_of_elements, 0);
+    for (int i{}; i < number_of_elements; i++) {
+        positions_by_level[next_slot[element_levels[i]]++] = i;
+    }
+
+    element_order.assign(level_starts[number_of_levels], 0);
+    evaluation_indices.assign(number_of_elements, 0);
+    std::vector<int> first_input_index(number_of_elements, 0);
+    for (int l{}; l < number_of_levels; l++) {
+        auto level_begin = positions_by_level.begin() + level_element_starts[l];
+        auto level_end = positions_by_level.begin() + level_element_starts[l + 1];
+
+        if (l > 0) {
+            for (auto it = level_begin; it != level_end; it++) {
+                first_input_index[*it] = evaluation_indices[elements[*it]->get_input_elements_positions()[0]];
+            }
+            std::stable_sort(level_begin, level_end, [&first_input_index](const int& a, const int& b) {
+                return first_input_index[a] < first_input_index[b];
+            });
+        }
+
+        int index{ level_starts[l] };
+        for (auto it = level_begin; it != level_end; it++) {
+            evaluation_indices[*it] = index;
+            for (int k{}; k < element_slots[*it]; k++) {
+                element_order[index++] = *it;
+            }
+        }
+    }
+
+    gate_codes.reserve(element_order.size());
+    gate_parameters.reserve(element_order.size());
+    first_input.reserve(element_order.size() + 1);
+    ordered_elements.reserve(element_order.size());
+    for (int index{}; index < get_size(); index++) {
+        int position{ element_order[index] };
+        gate_code code{ element_codes[position] };
+        std::uint64_t parameter{ 0 };
+        first_input.push_back(static_cast<int>(input_indices.size()));
+        ordered_elements.push_back(elements[position].get());
+
+        // the extra outputs of a bus cell or module instance record which output bit they hold
+        if (index != evaluation_indices[position]) {
+            gate_codes.push_back(gate_code::bus_output);
+            gate_parameters.push_back(index - evaluation_indices[position]);
+            continue;
+        }
+
+        if (code == gate_code::lut || is_bus_cell(code)) {
+            parameter = elements[position]->get_gate_parameter();
+        }
+        else if (code == gate_code::module_instance) {
+            const module_definition* module{ find_module(elements[position]->get_gate_type()).get() };
+            parameter = std::find(modules.begin(), modules.end(), module) - modules.begin();
+            if (parameter == modules.size()) {
+                modules.push_back(module);
+            }
+        }
+
+        if (code == gate_code::bit_select) {
+            int bit{ static_cast<int>(elements[position]->get_gate_parameter()) };
+            input_indices.push_back(evaluation_indices[elements[position]->get_input_elements_positions()[0]] + bit);
+            code = gate_code::buffer_gate;
+        }
+        else if (code != gate_code::input) {
+            for (const int& input : elements[position]->get_input_elements_positions()) {
+                input_indices.push_back(evaluation_indices[input]);
+            }
+        }
+        gate_codes.push_back(code);
+        gate_parameters.push_back(parameter);
+    }
+    first_input.push_back(static_cast<int>(input_indices.size()));
+}
+
+void evaluation_plan::clear()
+{
+    element_order.clear();
+    evaluation_indices.clear();
+    element_levels.clear();
+    level_starts.clear();
+    gate_codes.clear();
+    gate_parameters.clear();
+    first_input.clear();
+    input_indices.clear();
+    ordered_elements.clear();
+    modules.clear();
+}
+
+
+int evaluation_plan::get_size() const
+{
+    return static_cast<int>(element_order.size());
+}
+
+std::size_t evaluation_plan::get_memory_used() const
+{
+    return get_vector_memory(element_order) + get_vector_memory(evaluation_indices)
+        + get_vector_memory(element_levels) + get_vector_memory(level_starts)
+        + get_vector_memory(gate_codes) + get_vector_memory(gate_parameters)
+        + get_vector_memory(first_input) + get_vector_memory(input_indices)
+        + get_vector_memory(ordered_elements) + get_vector_memory(modules);
+}
+
+int evaluation_plan::get_number_of_levels() const
+{
+    return level_starts.empty() ? 0 : static_cast<int>(level_starts.size()) - 1;
+}
+
+int evaluation_plan::get_element_level(const int& element_position) const
+{
+    return element_levels[element_position];
+}
+
+int evaluation_plan::get_evaluation_index(const int& element_position) const
+{
+    return evaluation_indices[element_position];
+}
+
+// number of evaluation indices taken by the element at an index: one per output bit
+int evaluation_plan::get_number_of_outputs(const int& index) const
+{
+    if (is_bus_cell(gate_codes[index])) {
+        return get_bus_cell_outputs(gate_codes[index], static_cast<int>(gate_parameters[index]));
+    }
+    if (gate_codes[index] == gate_code::module_instance) {
+        return modules[gate_parameters[index]]->get_number_of_outputs();
+    }
+    return 1;
+}
+
+int evaluation_plan::get_widest_level_size() const
+{
+    int widest{ 0 };
+    for (int l{ 1 }; l < get_number_of_levels(); l++) {
+        widest = std::max(widest, level_starts[l + 1] - level_starts[l]);
+    }
+    return widest;
+}
+
+
+// copies the current output value of every element into values, in evaluation order
+void evaluation_plan::load_values(std::vector<unsigned char>& values) const
+{
+    values.resize(ordered_elements.size());
+    for (size_t i{}; i < ordered_elements.size(); i++) {
+        int output_bit{ gate_codes[i] == gate_code::bus_output ? static_cast<int>(gate_parameters[i]) : 0 };
+        values[i] = static_cast<unsigned char>((ordered_elements[i]->get_output_word() >> output_bit) & 1);
+    }
+}
+
+
+// evaluates every gate with an evaluation index in [begin, end)
+// all of their inputs must already hold up-to-date values
+void evaluation_plan::evaluate_range(std::vector<unsigned char>& values,
+    const int& begin, const int& end) const
+{
+    if (counters != nullptr) {
+        COUNT(*counters, plan_gate_evaluations, end - begin);
+    }
+    for (int i{ begin }; i < end; i++) {
+        const int* inputs{ input_indices.data() + first_input[i] };
+        int number_of_inputs{ first_input[i + 1] - first_input[i] };
+        if (gate_codes[i] == gate_code::lut) {
+            values[i] = evaluate_lut(gate_parameters[i], inputs, number_of_inputs, values);
+            continue;
+        }
+        if (is_bus_cell(gate_codes[i])) {
+            evaluate_bus_cell(gate_codes[i], static_cast<int>(gate_parameters[i]), inputs, number_of_inputs, values, i);
+            continue;
+        }
+        if (gate_codes[i] == gate_code::module_instance) {
+            evaluate_module_instance(*modules[gate_parameters[i]], inputs, number_of_inputs, values, i);
+            continue;
+        }
+        if (gate_codes[i] == gate_code::bus_output) {
+            continue;
+        }
+        if (number_of_inputs > 2) {
+            values[i] = evaluate_wide_gate<unsigned char>(gate_codes[i], inputs, number_of_inputs, values, 1);
+            continue;
+        }
+        unsigned char input1{ values[inputs[0]] };
+        unsigned char input2{ number_of_inputs > 1 ? values[inputs[1]] : input1 };
+        values[i] = evaluate_gate(gate_codes[i], input1, input2);
+    }
+}
+
+
+// evaluates all gates level by level
+// gates within a level only depend on earlier levels, so wide levels are split across the pool,
+// and run_chunks returning acts as the barrier before the next level starts
+void evaluation_plan::evaluate_levels(std::vector<unsigned char>& values, thread_pool* pool) const
+{
+    for (int l{ 1 }; l < get_number_of_levels(); l++) {
+        int begin{ level_starts[l] };
+        int end{ level_starts[l + 1] };
+
+        if (pool == nullptr || pool->get_number_of_threads() == 1 || end - begin < parallel_level_threshold) {
+            evaluate_range(values, begin, end);
+        }
+        else {
+            run_aligned_chunks(begin, end, values.data(), *pool, [this, &values](int chunk_begin, int chunk_end) {
+                evaluate_range(values, chunk_begin, chunk_end);
+            });
+        }
+    }
+}
+
+
+// writes values back into the output_value of every element
+void evaluation_plan::store_values(const std::vector<unsigned char>& values, thread_pool* pool) const
+{
+    auto store_range = [this, &values](int begin, int end) {
+        for (int i{ begin }; i < end; i++) {
+            if (is_bus_cell(gate_codes[i]) || gate_codes[i] == gate_code::module_instance) {
+                std::uint64_t output_word{};
+                for (int k{}; k < get_number_of_outputs(i); k++) {
+                    output_word |= static_cast<std::uint64_t>(values[i + k]) << k;
+                }
+                ordered_elements[i]->set_output_word(output_word);
+            }
+            else if (gate_codes[i] != gate_code::bus_output) {
+                ordered_elements[i]->set_output_value(values[i] != 0);
+            }
+        }
+    };
+
+    if (pool == nullptr || pool->get_number_of_threads() == 1 || get_size() < parallel_level_threshold) {
+        store_range(0, get_size());
+    }
+    else {
+        run_aligned_chunks(0, get_size(), values.data(), *pool, store_range);
+    }
+}
+
+
+// evaluates all gates for 64 input vectors at once
+// values holds one word per evaluation index, with the input elements' words already set
+void evaluation_plan::evaluate_words(std::vector<std::uint64_t>& values) const
+{
+    int first_gate{ get_number_of_levels() > 1 ? level_starts[1] : get_size() };
+    std::vector<std::uint64_t> module_values;
+
+    for (int i{ first_gate }; i < get_size(); i++) {
+        const int* inputs{ input_indices.data() + first_input[i] };
+        int number_of_inputs{ first_input[i + 1] - first_input[i] };
+        if (gate_codes[i] == gate_code::lut) {
+            values[i] = evaluate_lut_word(gate_parameters[i], number_of_inputs,
+                [inputs, &values](const int& input) { return values[inputs[input]]; });
+            continue;
+        }
+        if (is_bus_cell(gate_codes[i])) {
+            evaluate_bus_cell_words(gate_codes[i], static_cast<int>(gate_parameters[i]), inputs, number_of_inputs, values, i);
+            continue;
+        }
+        if (gate_codes[i] == gate_code::module_instance) {
+            evaluate_module_instance_words(*modules[gate_parameters[i]], inputs, number_of_inputs, values, i, module_values);
+            continue;
+        }
+        if (gate_codes[i] == gate_code::bus_output) {
+            continue;
+        }
+        if (number_of_inputs > 2) {
+            values[i] = evaluate_wide_gate<std::uint64_t>(gate_codes[i], inputs, number_of_inputs, values, ~std::uint64_t{ 0 });
+            continue;
+        }
+        std::uint64_t input1{ values[inputs[0]] };
+        std::uint64_t input2{ number_of_inputs > 1 ? values[inputs[1]] : input1 };
+        values[i] = evaluate_gate_word(gate_codes[i], input1, input2);
+    }
+}
+
+
+// evaluates all gates for 64 four-valued patterns at once, using the dual-rail encoding
+// described at evaluate_gate_dual_rail; the input elements' rails must already be set
+void evaluation_plan::evaluate_dual_rail(std::vector<std::uint64_t>& can_be_zero,
+    std::vector<std::uint64_t>& can_be_one) const
+{
+    if (counters != nullptr) {
+        COUNT(*counters, dual_rail_passes, 1);
+    }
+    int first_gate{ get_number_of_levels() > 1 ? level_starts[1] : get_size() };
+    std::vector<std::uint64_t> module_can_be_zero;
+    std::vector<std::uint64_t> module_can_be_one;
+
+    for (int i{ first_gate }; i < get_size(); i++) {
+        const int* inputs{ input_indices.data() + first_input[i] };
+        int number_of_inputs{ first_input[i + 1] - first_input[i] };
+        if (gate_codes[i] == gate_code::lut) {
+            evaluate_lut_dual_rail(gate_parameters[i], inputs, number_of_inputs,
+                can_be_zero, can_be_one, can_be_zero[i], can_be_one[i]);
+            continue;
+        }
+        if (is_bus_cell(gate_codes[i])) {
+            evaluate_bus_cell_dual_rail(gate_codes[i], static_cast<int>(gate_parameters[i]), inputs, number_of_inputs,
+                can_be_zero, can_be_one, i);
+            continue;
+        }
+        if (gate_codes[i] == gate_code::module_instance) {
+            evaluate_module_instance_dual_rail(*modules[gate_parameters[i]], inputs, number_of_inputs,
+                can_be_zero, can_be_one, i, module_can_be_zero, module_can_be_one);
+            continue;
+        }
+        if (gate_codes[i] == gate_code::bus_output) {
+            continue;
+        }
+        if (number_of_inputs > 2) {
+            evaluate_wide_gate_dual_rail(gate_codes[i], inputs, number_of_inputs,
+                can_be_zero, can_be_one, can_be_zero[i], can_be_one[i]);
+            continue;
+        }
+        int input2{ number_of_inputs > 1 ? inputs[1] : inputs[0] };
+        evaluate_gate_dual_rail(gate_codes[i], can_be_zero[inputs[0]], can_be_one[inputs[0]],
+            can_be_zero[input2], can_be_one[input2], can_be_zero[i], can_be_one[i]);
+    }
+}
@@ -0,0 +1,142 @@
+// evaluation_plan.h (last modified: 18/10/26)
+// header file for the evaluation_plan class definition and class member declarations
+// an evaluation_plan is a levelized, flattened copy of a circuit's structure:
+// elements are renumbered so that every logic level is a contiguous range of evaluation indices,
+// and gate types and inputs are stored in plain arrays instead of behind element pointers.
+// a bus cell or module instance takes one evaluation index per output bit, so its bit selects just read one of them
+
+#ifndef EVALUATION_PLAN_H
+#define EVALUATION_PLAN_H
+
+#include <vector>
+#include <memory>
+#include <cstdint>
+#include <cstddef>
+#include "elements.h"
+#include "thread_pool.h"
+#include "universal_functions.h"
+#include "instrumentation.h"
+
+
+class module_definition;
+
+
+// evaluates a single gate for 64 independent sets of input values, one per bit
+// shared by the evaluation plan, the elements and the lut mapper, so they always agree
+inline std::uint64_t evaluate_gate_word(const gate_code& code, const std::uint64_t& input1, const std::uint64_t& input2)
+{
+    switch (code) {
+        case gate_code::not_gate:
+            return ~input1;
+        case gate_code::buffer_gate:
+            return input1;
+        case gate_code::and_gate:
+            return input1 & input2;
+        case gate_code::or_gate:
+            return input1 | input2;
+        case gate_code::nand_gate:
+            return ~(input1 & input2);
+        case gate_code::nor_gate:
+            return ~(input1 | input2);
+        case gate_code::xor_gate:
+            return input1 ^ input2;
+        case gate_code::xnor_gate:
+            return ~(input1 ^ input2);
+        default:
+            return input1;
+    }
+}
+
+// evaluates a look-up table gate for 64 sets of input values by bit-sliced Shannon expansion:
+// starting from one all-0 or all-1 word per truth table row, each input (last first) selects
+// between pairs of cofactors, halving the number of words until only the output is left.
+// get_input_word(i) gives the word of input i, the first input being the most significant bit of the row
+template <class input_reader>
+inline std::uint64_t evaluate_lut_word(const std::uint64_t& mask, const int& number_of_inputs, input_reader get_input_word)
+{
+    std::uint64_t cofactors[64];
+    int number_of_cofactors{ 1 << number_of_inputs };
+
+    for (int row{}; row < number_of_cofactors; row++) {
+        cofactors[row] = ((mask >> row) & 1) ? ~std::uint64_t{ 0 } : 0;
+    }
+    for (int i{ number_of_inputs - 1 }; i >= 0; i--) {
+        std::uint64_t select{ get_input_word(i) };
+        number_of_cofactors /= 2;
+        for (int row{}; row < number_of_cofactors; row++) {
+            cofactors[row] = (select & cofactors[2 * row + 1]) | (~select & cofactors[2 * row]);
+        }
+    }
+    return cofactors[0];
+}
+
+// evaluates a not, buffer, look-up table or and/or/xor gate (or its inverse, with any number of inputs)
+// for 64 sets of input values; lut_mask is only used by look-up table gates
+inline std::uint64_t evaluate_gate_word(const gate_code& code, const std::uint64_t& lut_mask,
+    const std::uint64_t* input_words, const int& number_of_inputs)
+{
+    if (code == gate_code::lut) {
+        return evaluate_lut_word(lut_mask, number_of_inputs, [input_words](const int& i) { return input_words[i]; });
+    }
+    if (number_of_inputs <= 2) {
+        return evaluate_gate_word(code, input_words[0], input_words[number_of_inputs - 1]);
+    }
+
+    gate_code base_code{ gate_code::xor_gate };
+    if (code == gate_code::and_gate || code == gate_code::nand_gate) {
+        base_code = gate_code::and_gate;
+    }
+    else if (code == gate_code::or_gate || code == gate_code::nor_gate) {
+        base_code = gate_code::or_gate;
+    }
+    std::uint64_t result{ input_words[0] };
+    for (int i{ 1 }; i < number_of_inputs; i++) {
+        result = evaluate_gate_word(base_code, result, input_words[i]);
+    }
+    bool is_inverted{ code == gate_code::nand_gate || code == gate_code::nor_gate || code == gate_code::xnor_gate };
+    return is_inverted ? ~result : result;
+}
+
+
+class evaluation_plan
+{
+private:
+    std::vector<int> element_order;         // evaluation index -> element position (repeated for bus outputs)
+    std::vector<int> evaluation_indices;    // element position -> evaluation index
+    std::vector<int> element_levels;        // element position -> logic level (inputs are level 0)
+    std::vector<int> level_starts;          // level l covers [level_starts[l], level_starts[l + 1])
+    std::vector<gate_code> gate_codes;      // by evaluation index
+    std::vector<std::uint64_t> gate_parameters; // truth table of a lut gate, width of a bus cell or module number, by evaluation index
+    std::vector<int> first_input;           // inputs of index i are input_indices[first_input[i]...first_input[i + 1]]
+    std::vector<int> input_indices;         // evaluation indices of each element's inputs
+    std::vector<circuit_element*> ordered_elements;
+    std::vector<const module_definition*> modules;  // modules of the module instances, numbered by first use
+    simulation_counters* counters;          // the counters of the circuit the plan was built from, if any
+
+    int get_number_of_outputs(const int& index) const;
+
+public:
+    evaluation_plan();
+    ~evaluation_plan() {};
+
+    void build(const std::vector<std::shared_ptr<circuit_element>>& elements, const std::vector<int>& levels,
+        simulation_counters* set_counters);
+    void clear();
+
+    int get_size() const;
+    int get_number_of_levels() const;
+    int get_element_level(const int& element_position) const;
+    int get_evaluation_index(const int& element_position) const;
+    int get_widest_level_size() const;
+    std::size_t get_memory_used() const;
+
+    void load_values(std::vector<unsigned char>& values) const;
+    void evaluate_range(std::vector<unsigned char>& values, const int& begin, const int& end) const;
+    void evaluate_levels(std::vector<unsigned char>& values, thread_pool* pool) const;
+    void store_values(const std::vector<unsigned char>& values, thread_pool* pool) const;
+
+    void evaluate_words(std::vector<std::uint64_t>& values) const;
+    void evaluate_dual_rail(std::vector<std::uint64_t>& can_be_zero, std::vector<std::uint64_t>& can_be_one) const;
+};
+
+#endif
@@ -0,0 +1,131 @@
+// instrumentation.cpp (last modified: 18/10/26)
+// Contains definition of all simulation_counters class members and the counter functions declared in instrumentation.h
+
+#include <vector>
+#include <string>
+#include <memory>
+#include <mutex>
+#include <atomic>
+#include <thread>
+#include <algorithm>
+#include <cstdint>
+#include "instrumentation.h"
+
+
+const int number_of_counters{ static_cast<int>(counter_id::number_of_counters) };
+
+static std::atomic<std::uint64_t> next_counters_id{ 1 };
+
+
+simulation_counters::simulation_counters() :
+    counters_id{ next_counters_id.fetch_add(1) }, registry_lock{}, registry{} {}
+
+simulation_counters::~simulation_counters() {}
+
+
+// finds the calling thread's block, creating and registering it on the thread's first count,
+// and remembers it as the block the thread used last
+simulation_counters::thread_counters& simulation_counters::find_thread_counters()
+{
+    std::thread::id this_thread{ std::this_thread::get_id() };
+    std::lock_guard<std::mutex> lock(registry_lock);
+    thread_counters* block{ nullptr };
+    for (const std::unique_ptr<thread_counters>& registered_block : registry) {
+        if (registered_block->owner == this_thread) {
+            block = registered_block.get();
+        }
+    }
+    if (block == nullptr) {
+        registry.push_back(std::unique_ptr<thread_counters>(new thread_counters));
+        block = registry.back().get();
+        block->owner = this_thread;
+        for (int i{}; i < number_of_counters; i++) {
+            block->counts[i].store(0, std::memory_order_relaxed);
+        }
+        block->number_of_element_counts = 0;
+    }
+    get_last_used_block() = last_used_block{ counters_id, block };
+    return *block;
+}
+
+
+std::string get_counter_name(const counter_id& counter)
+{
+    static const std::vector<std::string> counter_names{
+        "input_changes", "events_propagated", "events_changed", "update_nanoseconds",
+        "level_evaluations", "plan_gate_evaluations", "batch_blocks", "dual_rail_passes",
+        "truth_table_rows", "truth_table_nanoseconds", "plan_builds" };
+
+    return counter_names[static_cast<int>(counter)];
+}
+
+
+// counts one evaluation of each given element, finding the thread's block once for all of them
+// the element counts grow to twice the size needed, so a growing circuit seldom reallocates them
+void simulation_counters::count_element_evaluations(const std::vector<int>& element_positions)
+{
+    if (element_positions.empty()) {
+        return;
+    }
+    thread_counters& block{ get_thread_counters() };
+
+    std::size_t largest_position{ static_cast<std::size_t>(
+        *std::max_element(element_positions.begin(), element_positions.end())) };
+    if (largest_position >= block.number_of_element_counts) {
+        std::size_t new_size{ 2 * largest_position + 1 };
+        std::unique_ptr<std::atomic<std::uint64_t>[]> new_counts(new std::atomic<std::uint64_t>[new_size]);
+        for (std::size_t i{}; i < new_size; i++) {
+            new_counts[i].store(i < block.number_of_element_counts ?
+                block.element_evaluations[i].load(std::memory_order_relaxed) : 0, std::memory_order_relaxed);
+        }
+        std::lock_guard<std::mutex> lock(registry_lock);
+        block.element_evaluations = std::move(new_counts);
+        block.number_of_element_counts = new_size;
+    }
+    for (const int& position : element_positions) {
+        std::atomic<std::uint64_t>& count{ block.element_evaluations[position] };
+        count.store(count.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+    }
+}
+
+
+// sums the counters of every thread
+// this is safe while a simulation is running, though counts added meanwhile may be left out
+counter_totals simulation_counters::collect() const
+{
+    counter_totals totals{ std::vector<std::uint64_t>(number_of_counters), {} };
+    std::lock_guard<std::mutex> lock(registry_lock);
+
+    for (const std::unique_ptr<thread_counters>& block : registry) {
+        for (int i{}; i < number_of_counters; i++) {
+            totals.counts[i] += block->counts[i].load(std::memory_order_relaxed);
+        }
+        std::size_t number_of_element_counts{ block->number_of_element_counts };
+        if (number_of_element_counts > totals.element_evaluations.size()) {
+            totals.element_evaluations.resize(number_of_element_counts);
+        }
+        for (std::size_t i{}; i < number_of_element_counts; i++) {
+            totals.element_evaluations[i] += block->element_evaluations[i].load(std::memory_order_relaxed);
+        }
+    }
+    while (!totals.element_evaluations.empty() && totals.element_evaluations.back() == 0) {
+        totals.element_evaluations.pop_back();
+    }
+    return totals;
+}
+
+// sets every counter of every thread back to 0
+// a count being added by a running simulation at the same moment may keep its value from before the reset
+void simulation_counters::reset()
+{
+    std::lock_guard<std::mutex> lock(registry_lock);
+
+    for (const std::unique_ptr<thread_counters>& block : registry) {
+        for (int i{}; i < number_of_counters; i++) {
+            block->counts[i].store(0, std::memory_order_relaxed);
+        }
+        for (std::size_t i{}; i < block->number_of_element_counts; i++) {
+            block->element_evaluations[i].store(0, std::memory_order_relaxed);
+        }
+    }
+}
@@ -0,0 +1,149 @@
+// instrumentation.h (last modified: 18/10/26)
+// header file for the simulation_counters class definition and class member declarations,
+// and the macros used to update them
+// each circuit has its own counters, so circuits simulated side by side (eg. by the server) are
+// reported apart. every thread adds to its own block of a circuit's counters, so counting never
+// contends between threads; the blocks are only summed when a report is asked for.
+// building with LCS_NO_INSTRUMENTATION defined turns every macro below into nothing
+
+#ifndef INSTRUMENTATION_H
+#define INSTRUMENTATION_H
+
+#include <vector>
+#include <string>
+#include <memory>
+#include <mutex>
+#include <atomic>
+#include <thread>
+#include <chrono>
+#include <cstdint>
+#include <cstddef>
+
+#ifndef LCS_NO_INSTRUMENTATION
+#define LCS_INSTRUMENTATION
+#endif
+
+
+// the quantities that are counted, used to index a block of counters
+enum class counter_id : int
+{
+    input_changes,          // calls to change_input
+    events_propagated,      // elements re-evaluated by update_circuit
+    events_changed,         // of those, elements whose output changed, so their fanouts were scheduled
+    update_nanoseconds,     // time spent in update_circuit
+    level_evaluations,      // whole-circuit evaluations through the evaluation plan
+    plan_gate_evaluations,  // gates evaluated by those, summed over every thread that took part
+    batch_blocks,           // blocks of 64 input vectors evaluated by evaluate_batch
+    dual_rail_passes,       // blocks of 64 four-valued patterns evaluated
+    truth_table_rows,       // truth table rows simulated (rows found in the cache are not counted)
+    truth_table_nanoseconds,
+    plan_builds,            // times the evaluation plan was rebuilt after the circuit changed
+    number_of_counters
+};
+
+
+// counters summed over every thread
+struct counter_totals
+{
+    std::vector<std::uint64_t> counts;                  // by counter_id
+    std::vector<std::uint64_t> element_evaluations;     // by element position, from update_circuit only
+};
+
+
+std::string get_counter_name(const counter_id& counter);
+
+
+class simulation_counters
+{
+private:
+    // one thread's block of a circuit's counters. only its own thread adds to it, so it adds with a
+    // relaxed load and store rather than a locked read-modify-write; reports may still read or reset it
+    // from other threads, so every count is atomic. the element counts are only reallocated by the
+    // owning thread, under the registry lock, so readers holding the lock never see a freed array;
+    // resetting them stores zeros rather than freeing them for the same reason
+    struct thread_counters
+    {
+        std::thread::id owner;
+        std::atomic<std::uint64_t> counts[static_cast<int>(counter_id::number_of_counters)];
+        std::unique_ptr<std::atomic<std::uint64_t>[]> element_evaluations;
+        std::size_t number_of_element_counts;
+    };
+
+    // the block the calling thread used last, and the id of the counters it belongs to
+    struct last_used_block
+    {
+        std::uint64_t counters_id;
+        thread_counters* block;
+    };
+
+    // tells the threads' remembered blocks apart, as new counters can reuse the address of old ones
+    std::uint64_t counters_id;
+
+    // blocks are kept after their thread ends (eg. when the worker pool is replaced), so nothing counted is lost
+    mutable std::mutex registry_lock;
+    std::vector<std::unique_ptr<thread_counters>> registry;
+
+    static last_used_block& get_last_used_block()
+    {
+        thread_local last_used_block last_used{ 0, nullptr };
+        return last_used;
+    }
+
+    // the calling thread's block. a thread counting for one circuit at a time finds it without
+    // leaving this function; find_thread_counters takes the lock when it moves on to another circuit
+    thread_counters& get_thread_counters()
+    {
+        last_used_block& last_used{ get_last_used_block() };
+        return last_used.counters_id == counters_id ? *last_used.block : find_thread_counters();
+    }
+    thread_counters& find_thread_counters();
+
+public:
+    simulation_counters();
+    ~simulation_counters();
+
+    simulation_counters(const simulation_counters&) = delete;
+    simulation_counters& operator=(const simulation_counters&) = delete;
+
+    void add(const counter_id& counter, const std::uint64_t& amount)
+    {
+        std::atomic<std::uint64_t>& count{ get_thread_counters().counts[static_cast<int>(counter)] };
+        count.store(count.load(std::memory_order_relaxed) + amount, std::memory_order_relaxed);
+    }
+    void count_element_evaluations(const std::vector<int>& element_positions);
+    counter_totals collect() const;
+    void reset();
+};
+
+
+// adds the time between its construction and destruction to a counter
+class scoped_timer
+{
+private:
+    simulation_counters& counters;
+    counter_id counter;
+    std::chrono::steady_clock::time_point start_time;
+
+public:
+    scoped_timer(simulation_counters& set_counters, const counter_id& set_counter) :
+        counters{ set_counters }, counter{ set_counter }, start_time{ std::chrono::steady_clock::now() } {}
+    ~scoped_timer()
+    {
+        counters.add(counter, static_cast<std::uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now() - start_time).count()));
+    }
+};
+
+
+// counters is the simulation_counters object to add to
+#ifdef LCS_INSTRUMENTATION
+#define COUNT(counters, counter, amount) (counters).add(counter_id::counter, (amount))
+#define COUNT_ELEMENT_EVALUATIONS(counters, positions) (counters).count_element_evaluations(positions)
+#define TIME_SCOPE(counters, counter) scoped_timer counter##_timer((counters), counter_id::counter)
+#else
+#define COUNT(counters, counter, amount) ((void)0)
+#define COUNT_ELEMENT_EVALUATIONS(counters, positions) ((void)0)
+#define TIME_SCOPE(counters, counter) ((void)0)
+#endif
+
+#endif
@@ -0,0 +1,425 @@
+// lut_mapping.cpp (last modified: 18/10/26)
+// Contains definition of all lut_mapper class members not defined in lut_mapping.h
+// mapping follows the usual priority-cut approach: a few good cuts are kept per gate,
+// a depth-optimal cover is chosen first, then gates off the critical path switch to cuts
+// with the lowest area flow as long as the depth of the cover does not increase
+
+#include <iostream>
+#include <vector>
+#include <string>
+#include <unordered_map>
+#include <algorithm>
+#include <random>
+#include <iterator>
+#include <cstdint>
+#include "lut_mapping.h"
+#include "circuit.h"
+#include "tracing.h"
+#include "bit_matrix.h"
+#include "universal_functions.h"
+#include "evaluation_plan.h"
+
+
+// number of cuts kept for each gate, and number of partial cuts kept while merging a gate's inputs
+const int cut_limit{ 8 };
+const int merge_limit{ 64 };
+
+// number of area recovery passes run after the depth-optimal cover is found
+const int area_recovery_passes{ 2 };
+
+// circuits with up to this many inputs are checked on every input vector, larger ones on random vectors
+const int exhaustive_check_inputs{ 16 };
+const int random_check_vectors{ 1 << 16 };
+
+
+lut_mapper::lut_mapper(const int& set_lut_size) :
+    lut_size{ std::min(std::max(set_lut_size, 1), maximum_lut_inputs) },
+    source_input_positions{}, source_input_values{}, source_output_positions{},
+    gate_codes{}, lut_masks{}, element_inputs{}, fanout_counts{}, topological_order{},
+    element_cuts{}, chosen_cuts{}, arrival_times{}, area_flows{},
+    lut_roots{}, lut_truth_tables{}, mapped_positions{}, mapped_names{} {}
+
+
+// finds a cover of the circuit with lut gates of at most lut_size inputs
+// returns false if a gate of the circuit has more inputs than a lut can take
+bool lut_mapper::map(const circuit& source)
+{
+    TRACE_SCOPE("lut_mapping");
+    int number_of_elements{ source.get_circuit_size() };
+    source_input_positions = source.get_input_positions();
+    source_input_values = source.get_current_input_values();
+    source_output_positions = source.get_output_positions();
+
+    gate_codes.assign(number_of_elements, gate_code::input);
+    lut_masks.assign(number_of_elements, 0);
+    element_inputs.assign(number_of_elements, std::vector<int>{});
+    fanout_counts.assign(number_of_elements, 0);
+
+    for (int position{}; position < number_of_elements; position++) {
+        std::string gate_type{ source.get_element_gate_type(position) };
+        gate_codes[position] = get_gate_code(gate_type);
+        if (gate_codes[position] == gate_code::input) {
+            continue;
+        }
+        if (gate_codes[position] == gate_code::module_instance) {
+            std::cerr << "\nError: element '" << source.get_element_name(position)
+                << "' is a module instance, which must be flattened before mapping onto luts\n";
+            return false;
+        }
+        if (gate_codes[position] > gate_code::lut) {
+            std::cerr << "\nError: element '" << source.get_element_name(position)
+                << "' is part of a bus cell, which cannot be mapped onto luts\n";
+            return false;
+        }
+        if (gate_codes[position] == gate_code::lut) {
+            int number_of_gate_inputs{};
+            parse_lut_gate_type(gate_type, number_of_gate_inputs, lut_masks[position]);
+        }
+        element_inputs[position] = source.get_element_input_positions(position);
+
+        std::vector<int> distinct_inputs{ element_inputs[position] };
+        std::sort(distinct_inputs.begin(), distinct_inputs.end());
+        distinct_inputs.erase(std::unique(distinct_inputs.begin(), distinct_inputs.end()), distinct_inputs.end());
+        if (static_cast<int>(distinct_inputs.size()) > lut_size) {
+            std::cerr << "\nError: element '" << source.get_element_name(position) << "' has "
+                << distinct_inputs.size() << " inputs, more than a " << lut_size << "-input lut can take\n";
+            return false;
+        }
+        for (const int& input : distinct_inputs) {
+            fanout_counts[input]++;
+        }
+    }
+
+    // circuit levels give a topological order, whatever order the elements were added in
+    std::vector<std::vector<int>> elements_by_level(source.get_number_of_levels());
+    for (int position{}; position < number_of_elements; position++) {
+        elements_by_level[source.get_element_level(position)].push_back(position);
+    }
+    topological_order.clear();
+    for (const std::vector<int>& level : elements_by_level) {
+        topological_order.insert(topological_order.end(), level.begin(), level.end());
+    }
+
+    element_cuts.assign(number_of_elements, std::vector<cut>{});
+    chosen_cuts.assign(number_of_elements, -1);
+    arrival_times.assign(number_of_elements, 0);
+    area_flows.assign(number_of_elements, 0.0);
+
+    for (const int& position : topological_order) {
+        if (gate_codes[position] != gate_code::input) {
+            enumerate_cuts(position);
+        }
+    }
+    select_cover();
+
+    for (int pass{}; pass < area_recovery_passes; pass++) {
+        recover_area();
+        select_cover();
+    }
+
+    lut_truth_tables.clear();
+    mapped_positions.assign(number_of_elements, -1);
+    mapped_names.clear();
+    for (size_t i{}; i < source_input_positions.size(); i++) {
+        mapped_positions[source_input_positions[i]] = static_cast<int>(i);
+        mapped_names.push_back(source.get_element_name(source_input_positions[i]));
+    }
+    for (size_t i{}; i < lut_roots.size(); i++) {
+        const int& root{ lut_roots[i] };
+        lut_truth_tables.push_back(get_cut_truth_table(root, element_cuts[root][chosen_cuts[root]].leaves));
+        mapped_positions[root] = static_cast<int>(source_input_positions.size() + i);
+        mapped_names.push_back(source.get_element_name(root));
+    }
+    return true;
+}
+
+
+// combines the cuts of a gate's inputs into the cuts of the gate
+// keeps the cut_limit cuts with the lowest depth, then area flow, and chooses the best of them
+void lut_mapper::enumerate_cuts(const int& position)
+{
+    std::vector<int> distinct_inputs{ element_inputs[position] };
+    std::sort(distinct_inputs.begin(), distinct_inputs.end());
+    distinct_inputs.erase(std::unique(distinct_inputs.begin(), distinct_inputs.end()), distinct_inputs.end());
+
+    std::vector<std::vector<int>> merged_cuts{ std::vector<int>{} };
+    for (const int& input : distinct_inputs) {
+        // an input can always be a leaf itself, or be replaced by the leaves of one of its cuts
+        std::vector<std::vector<int>> input_cuts{ std::vector<int>{ input } };
+        for (const cut& input_cut : element_cuts[input]) {
+            input_cuts.push_back(input_cut.leaves);
+        }
+
+        std::vector<std::vector<int>> next_cuts;
+        for (const std::vector<int>& partial_cut : merged_cuts) {
+            for (const std::vector<int>& input_cut : input_cuts) {
+                std::vector<int> leaves;
+                std::set_union(partial_cut.begin(), partial_cut.end(),
+                    input_cut.begin(), input_cut.end(), std::back_inserter(leaves));
+                if (static_cast<int>(leaves.size()) <= lut_size) {
+                    next_cuts.push_back(leaves);
+                }
+            }
+        }
+
+        std::sort(next_cuts.begin(), next_cuts.end());
+        next_cuts.erase(std::unique(next_cuts.begin(), next_cuts.end()), next_cuts.end());
+        if (static_cast<int>(next_cuts.size()) > merge_limit) {
+            std::stable_sort(next_cuts.begin(), next_cuts.end(),
+                [](const std::vector<int>& a, const std::vector<int>& b) { return a.size() < b.size(); });
+            next_cuts.resize(merge_limit);
+        }
+        merged_cuts = next_cuts;
+    }
+
+    // a cut is dropped if a smaller cut uses a subset of its leaves
+    std::stable_sort(merged_cuts.begin(), merged_cuts.end(),
+        [](const std::vector<int>& a, const std::vector<int>& b) { return a.size() < b.size(); });
+    std::vector<cut> cuts;
+    for (const std::vector<int>& leaves : merged_cuts) {
+        bool is_dominated{ false };
+        for (const cut& kept_cut : cuts) {
+            if (std::includes(leaves.begin(), leaves.end(), kept_cut.leaves.begin(), kept_cut.leaves.end())) {
+                is_dominated = true;
+                break;
+            }
+        }
+        if (!is_dominated) {
+            cuts.push_back(cut{ leaves, 0, 0.0 });
+            evaluate_cut(cuts.back());
+        }
+    }
+
+    std::stable_sort(cuts.begin(), cuts.end(), [](const cut& a, const cut& b) {
+        if (a.depth != b.depth) {
+            return a.depth < b.depth;
+        }
+        if (a.area_flow != b.area_flow) {
+            return a.area_flow < b.area_flow;
+        }
+        return a.leaves.size() < b.leaves.size();
+    });
+    if (static_cast<int>(cuts.size()) > cut_limit) {
+        cuts.resize(cut_limit);
+    }
+
+    element_cuts[position] = cuts;
+    chosen_cuts[position] = 0;
+    arrival_times[position] = cuts[0].depth;
+    area_flows[position] = cuts[0].area_flow / std::max(fanout_counts[position], 1);
+}
+
+
+// depth and area flow of a cut, from the current arrival times and area flows of its leaves
+void lut_mapper::evaluate_cut(cut& element_cut) const
+{
+    element_cut.depth = 0;
+    element_cut.area_flow = 1.0;
+    for (const int& leaf : element_cut.leaves) {
+        element_cut.depth = std::max(element_cut.depth, arrival_times[leaf]);
+        element_cut.area_flow += area_flows[leaf];
+    }
+    element_cut.depth++;
+}
+
+
+// chooses the cut with the lowest area flow for each gate that still meets its required time
+// required times come from the current cover, so the cut already chosen always qualifies
+void lut_mapper::recover_area()
+{
+    int mapped_depth{ get_mapped_depth() };
+    std::vector<int> required_times(gate_codes.size(), mapped_depth);
+
+    for (auto it = lut_roots.rbegin(); it != lut_roots.rend(); it++) {
+        for (const int& leaf : element_cuts[*it][chosen_cuts[*it]].leaves) {
+            required_times[leaf] = std::min(required_times[leaf], required_times[*it] - 1);
+        }
+    }
+
+    for (const int& position : topological_order) {
+        if (gate_codes[position] == gate_code::input) {
+            continue;
+        }
+
+        std::vector<cut>& cuts{ element_cuts[position] };
+        int best_cut{ -1 };
+        for (int i{}; i < static_cast<int>(cuts.size()); i++) {
+            evaluate_cut(cuts[i]);
+            if (cuts[i].depth > required_times[position]) {
+                continue;
+            }
+            if (best_cut == -1 || cuts[i].area_flow < cuts[best_cut].area_flow
+                || (cuts[i].area_flow == cuts[best_cut].area_flow && cuts[i].depth < cuts[best_cut].depth)) {
+                best_cut = i;
+            }
+        }
+        if (best_cut == -1) {
+            best_cut = chosen_cuts[position];
+        }
+
+        chosen_cuts[position] = best_cut;
+        arrival_times[position] = cuts[best_cut].depth;
+        area_flows[position] = cuts[best_cut].area_flow / std::max(fanout_counts[position], 1);
+    }
+}
+
+
+// collects the gates whose chosen cuts are needed to produce the circuit outputs
+void lut_mapper::select_cover()
+{
+    std::vector<char> is_root(gate_codes.size(), false);
+    std::vector<int> unvisited;
+
+    for (const int& output : source_output_positions) {
+        if (gate_codes[output] != gate_code::input && !is_root[output]) {
+            is_root[output] = true;
+            unvisited.push_back(output);
+        }
+    }
+    while (!unvisited.empty()) {
+        int root{ unvisited.back() };
+        unvisited.pop_back();
+        for (const int& leaf : element_cuts[root][chosen_cuts[root]].leaves) {
+            if (gate_codes[leaf] != gate_code::input && !is_root[leaf]) {
+                is_root[leaf] = true;
+                unvisited.push_back(leaf);
+            }
+        }
+    }
+
+    lut_roots.clear();
+    for (const int& position : topological_order) {
+        if (is_root[position]) {
+            lut_roots.push_back(position);
+        }
+    }
+}
+
+
+// truth table of root as a function of the leaves of one of its cuts
+// the first leaf is the most significant bit of the row number, as in make_lut_gate_type
+std::uint64_t lut_mapper::get_cut_truth_table(const int& root, const std::vector<int>& leaves) const
+{
+    int number_of_leaves{ static_cast<int>(leaves.size()) };
+    std::unordered_map<int, std::uint64_t> values;
+    for (int i{}; i < number_of_leaves; i++) {
+        values[leaves[i]] = get_truth_table_input_word(number_of_leaves - 1 - i, 0);
+    }
+
+    // evaluates the cone between the leaves and the root without recursion, as cones can be long chains
+    std::vector<int> unvisited{ root };
+    while (!unvisited.empty()) {
+        int position{ unvisited.back() };
+        if (values.count(position) != 0) {
+            unvisited.pop_back();
+            continue;
+        }
+
+        bool are_inputs_ready{ true };
+        for (const int& input : element_inputs[position]) {
+            if (values.count(input) == 0) {
+                unvisited.push_back(input);
+                are_inputs_ready = false;
+            }
+        }
+        if (are_inputs_ready) {
+            std::vector<std::uint64_t> input_values;
+            for (const int& input : element_inputs[position]) {
+                input_values.push_back(values[input]);
+            }
+            values[position] = evaluate_gate_word(gate_codes[position], lut_masks[position],
+                input_values.data(), static_cast<int>(input_values.size()));
+            unvisited.pop_back();
+        }
+    }
+
+    std::uint64_t used_rows{ number_of_leaves == 6 ? ~std::uint64_t{ 0 } : (std::uint64_t{ 1 } << (1 << number_of_leaves)) - 1 };
+    return values[root] & used_rows;
+}
+
+
+// adds the mapped circuit to target, which should be empty
+// inputs come first, in the same order and with the same values as in the source circuit,
+// followed by one lut gate per element of the cover; every element keeps its name from the source
+void lut_mapper::build_mapped_circuit(circuit& target) const
+{
+    int number_of_inputs{ static_cast<int>(source_input_positions.size()) };
+
+    for (size_t i{}; i < mapped_names.size(); i++) {
+        target.set_element_name(static_cast<int>(i), mapped_names[i]);
+    }
+    target.begin_netlist();
+    for (int i{}; i < number_of_inputs; i++) {
+        target.add_netlist_element(i, source_input_values[i]);
+    }
+    for (size_t i{}; i < lut_roots.size(); i++) {
+        const std::vector<int>& leaves{ element_cuts[lut_roots[i]][chosen_cuts[lut_roots[i]]].leaves };
+        std::vector<int> lut_inputs;
+        for (const int& leaf : leaves) {
+            lut_inputs.push_back(mapped_positions[leaf]);
+        }
+        target.add_netlist_element(number_of_inputs + static_cast<int>(i),
+            make_lut_gate_type(static_cast<int>(leaves.size()), lut_truth_tables[i]), lut_inputs);
+    }
+    target.finish_netlist(std::cerr);
+}
+
+
+// checks every output of the mapped circuit against the source circuit,
+// on every input vector for small circuits and on a fixed set of random vectors otherwise
+bool lut_mapper::verify_mapping(const circuit& source, const circuit& mapped) const
+{
+    int number_of_inputs{ static_cast<int>(source_input_positions.size()) };
+    bool is_exhaustive{ number_of_inputs <= exhaustive_check_inputs };
+    int number_of_vectors{ is_exhaustive ? 1 << number_of_inputs : random_check_vectors };
+    bit_matrix input_vectors(number_of_inputs, number_of_vectors);
+    std::mt19937_64 random_words{ 2026 };
+
+    for (int i{}; i < number_of_inputs; i++) {
+        // as in truth tables, the first input is the most significant bit of the vector number
+        int bit{ number_of_inputs - 1 - i };
+        for (int word{}; word < input_vectors.get_words_per_row(); word++) {
+            input_vectors.set_word(i, word, is_exhaustive ? get_truth_table_input_word(bit, word) : random_words());
+        }
+    }
+
+    bit_matrix source_outputs{ source.evaluate_batch(input_vectors) };
+    bit_matrix mapped_outputs{ mapped.evaluate_batch(input_vectors) };
+    std::vector<int> mapped_output_positions{ mapped.get_output_positions() };
+
+    for (size_t i{}; i < source_output_positions.size(); i++) {
+        auto mapped_row = std::find(mapped_output_positions.begin(), mapped_output_positions.end(),
+            mapped_positions[source_output_positions[i]]);
+        if (mapped_row == mapped_output_positions.end()) {
+            std::cerr << "\nError: output '" << source.get_element_name(source_output_positions[i])
+                << "' is missing from the mapped circuit\n";
+            return false;
+        }
+
+        int row{ static_cast<int>(mapped_row - mapped_output_positions.begin()) };
+        for (int word{}; word < source_outputs.get_words_per_row(); word++) {
+            if (source_outputs.get_word(static_cast<int>(i), word) != mapped_outputs.get_word(row, word)) {
+                std::cerr << "\nError: output '" << source.get_element_name(source_output_positions[i])
+                    << "' of the mapped circuit differs from the original circuit\n";
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+
+int lut_mapper::get_number_of_luts() const
+{
+    return static_cast<int>(lut_roots.size());
+}
+
+// number of lut levels between the circuit inputs and the deepest output
+int lut_mapper::get_mapped_depth() const
+{
+    int mapped_depth{};
+    for (const int& output : source_output_positions) {
+        mapped_depth = std::max(mapped_depth, arrival_times[output]);
+    }
+    return mapped_depth;
+}
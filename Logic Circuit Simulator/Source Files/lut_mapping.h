@@ -0,0 +1,69 @@
+// lut_mapping.h (last modified: 18/10/26)
+// header file for the lut_mapper class definition and class member declarations
+// a lut_mapper covers a circuit with k-input look-up table gates: every group of gates that
+// depends on at most k signals (a k-feasible cut) can be replaced by a single lut gate
+
+#ifndef LUT_MAPPING_H
+#define LUT_MAPPING_H
+
+#include <vector>
+#include <string>
+#include <cstdint>
+#include "circuit.h"
+#include "universal_functions.h"
+
+
+class lut_mapper
+{
+private:
+    // a cut of an element: a set of elements (leaves) whose values decide the element's value
+    struct cut
+    {
+        std::vector<int> leaves;    // sorted element positions
+        int depth;                  // lut levels from the circuit inputs if this cut is used
+        double area_flow;           // estimated number of luts needed, shared between fanouts
+    };
+
+    int lut_size;
+    std::vector<int> source_input_positions;
+    std::vector<bool> source_input_values;
+    std::vector<int> source_output_positions;
+
+    // structure of the source circuit, by element position
+    std::vector<gate_code> gate_codes;
+    std::vector<std::uint64_t> lut_masks;
+    std::vector<std::vector<int>> element_inputs;
+    std::vector<int> fanout_counts;
+    std::vector<int> topological_order;
+
+    // cuts kept for each gate, and the cut currently chosen to implement it
+    std::vector<std::vector<cut>> element_cuts;
+    std::vector<int> chosen_cuts;
+    std::vector<int> arrival_times;
+    std::vector<double> area_flows;
+
+    // the elements implemented as luts, in topological order, and the cover's truth tables
+    std::vector<int> lut_roots;
+    std::vector<std::uint64_t> lut_truth_tables;
+    std::vector<int> mapped_positions;
+    std::vector<std::string> mapped_names;  // names of the mapped circuit's elements, taken from the source
+
+    void enumerate_cuts(const int&);
+    void evaluate_cut(cut&) const;
+    void recover_area();
+    void select_cover();
+    std::uint64_t get_cut_truth_table(const int&, const std::vector<int>&) const;
+
+public:
+    lut_mapper(const int& set_lut_size);
+    ~lut_mapper() {};
+
+    bool map(const circuit&);
+    void build_mapped_circuit(circuit&) const;
+    bool verify_mapping(const circuit& source, const circuit& mapped) const;
+
+    int get_number_of_luts() const;
+    int get_mapped_depth() const;
+};
+
+#endif
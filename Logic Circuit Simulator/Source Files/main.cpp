@@ -1,6 +1,6 @@
 // main.cpp
 // OOP in c++ project: Logic Circuits
-// Dominic Bradley (last modified: 03/07/22)
+// Dominic Bradley (last modified: 18/10/26)
 // Allows user to create, modify, and view information about digital circuits,
 // via a type-based menu interface.
 // main.cpp handles the interface, and contains functions used only for the interface
@@ -13,9 +13,20 @@
 #include <cmath>
 #include <sstream>
 #include <type_traits>
+#include <cctype>
+#include <cstdint>
+#include <fstream>
 #include "universal_functions.h"
 #include "elements.h"
 #include "circuit.h"
+#include "lut_mapping.h"
+#include "netlist_reader.h"
+#include "tracing.h"
+#include "memory_usage.h"
+#include "vcd_writer.h"
+#include "differential_simulation.h"
+#include "tree_balancing.h"
+#include "activity_estimation.h"
 
 
 // declaring functions used in the interface
@@ -23,8 +34,11 @@ template <class class_type> class_type get_user_option(const std::vector<class_t
 template <class class_type> void print_options(const std::vector<class_type>& options);
 void create_gate(std::unordered_map<std::string, std::string>& gate_library,
     const std::string& gate_type);
-std::vector<std::string> get_all_element_letters(const int& circuit_size);
-int get_element_position(const std::string& element_letter);
+void create_custom_gate(std::unordered_map<std::string, std::string>& gate_library);
+void create_wide_gate(std::unordered_map<std::string, std::string>& gate_library);
+void create_bus_cell(std::unordered_map<std::string, std::string>& gate_library);
+std::string get_user_text();
+int get_user_element(const circuit& user_circuit, const bool& inputs_only);
 void print_gate_truth_table(const std::string& gate_type);
 
 
@@ -35,12 +49,27 @@ int main()
     bool end_program_condition{ false };
     circuit user_circuit;
     static bool does_circuit_exist{ false };
+
+    // waveform of the input changes made with option 8, one time step per change
+    vcd_writer waveform;
+    std::uint64_t waveform_time{};
     std::unordered_map<std::string, std::string> gate_library;
 
     std::vector<std::string> available_logic_gate_options{
-        "all","not","buffer","and","or","nand","nor","xor","xnor" };
+        "all","not","buffer","and","or","nand","nor","xor","xnor","custom","wide","bus" };
     const std::vector<std::string> yes_no_options{ "y","n"};
 
+    // gate options that define a new gate each time, so stay available after use
+    const std::vector<std::string> repeatable_gate_options{ "custom","wide","bus" };
+    auto is_repeatable_gate_option = [&repeatable_gate_options](const std::string& option) {
+        for (const std::string& repeatable_option : repeatable_gate_options) {
+            if (option == repeatable_option) {
+                return true;
+            }
+        }
+        return false;
+    };
+
     std::cout << "Welcome to Logic Circuit Simulator!\n";
 
 
@@ -59,8 +88,18 @@ int main()
             << "(7)--Print truth table for a logic gate in the library\n"
             << "(8)--Change value of an input\n"
             << "(9)--Exit program\n"
+            << "(10)-Four-valued (0/1/X/Z) analysis of the circuit\n"
+            << "(11)-Map circuit onto look-up table gates\n"
+            << "(12)-Read circuit from a netlist file\n"
+            << "(13)-Simulation statistics\n"
+            << "(14)-Record a timeline trace\n"
+            << "(15)-Memory usage and budget\n"
+            << "(16)-Record input changes as a waveform (VCD) file\n"
+            << "(17)-Compare the circuit against a revised netlist\n"
+            << "(18)-Reduce logic depth by balancing gate chains\n"
+            << "(19)-Estimate signal probabilities and switching activity\n"
             << "(0)--help";
-        std::vector<int> main_menu_options{ 1,2,3,4,5,6,7,8,9,0 };
+        std::vector<int> main_menu_options{ 1,2,3,4,5,6,7,8,9,10,11,12,13,14,15,16,17,18,19,0 };
 
         
         // switch statement handles all user interaction
@@ -81,7 +120,8 @@ int main()
                         gate_library.clear();
                         std::cout << "Gate library cleared!\n\n";
                         available_logic_gate_options = {
-                            "all","not","buffer","and","or","nand","nor","xor","xnor" };
+                            "all","not","buffer","and","or","nand","nor","xor","xnor","custom","wide","bus" };
+                        waveform.close();
                         user_circuit.reset_circuit();
                         std::cout << "\nNew circuit created! Now create some logic gates.\n\n";
                     }
@@ -102,21 +142,19 @@ int main()
                     break;
                 }
 
-                if (gate_library.size() == 8) {
-                    cout << "Gate library already contains all gate types!\n\n";
-                    break;
-                }
-
                 string new_gate_option{ "y" };
                 while (new_gate_option != "n") {
                     cout << "What logic gate would you like to add?\n"
-                        << "Type 'all' to add all gates to the library.";
+                        << "Type 'all' to add all gates to the library,"
+                        << " 'custom' to define a gate by its truth table,\n"
+                        << "'wide' for an and/or/xor gate with more than 2 inputs,"
+                        << " or 'bus' for a word-level adder, comparator, multiplexer or shifter.";
 
                     string gate_type_option{ get_user_option(available_logic_gate_options) };
 
                     for (auto it = available_logic_gate_options.begin();
                             it != available_logic_gate_options.end(); it++) {
-                        if (gate_type_option == *it) {
+                        if (gate_type_option == *it && !is_repeatable_gate_option(gate_type_option)) {
                             it = available_logic_gate_options.erase(it);
                             break;
                         }
@@ -124,10 +162,25 @@ int main()
 
                     if (gate_type_option == "all") {
                         for (const string& option : available_logic_gate_options) {
-                            create_gate(gate_library, option);
-                            cout << "\n" << gate_library[option]
-                                << " gate added to the gate library.";
+                            if (!is_repeatable_gate_option(option)) {
+                                create_gate(gate_library, option);
+                                cout << "\n" << gate_library[option]
+                                    << " gate added to the gate library.";
+                            }
                         }
+                        available_logic_gate_options = repeatable_gate_options;
+                    }
+
+                    else if (gate_type_option == "custom") {
+                        create_custom_gate(gate_library);
+                    }
+
+                    else if (gate_type_option == "wide") {
+                        create_wide_gate(gate_library);
+                    }
+
+                    else if (gate_type_option == "bus") {
+                        create_bus_cell(gate_library);
                     }
                     
                     else {
@@ -136,9 +189,10 @@ int main()
                             << " gate added to the gate library.\n";
                     }
 
-                    if (gate_library.size() == 8) {
-                        cout << "\n\nGate library now contains all gate types!\n\n";
-                        break;
+                    if (available_logic_gate_options.size() == repeatable_gate_options.size()
+                            && !is_repeatable_gate_option(gate_type_option)) {
+                        cout << "\n\nGate library now contains all built-in gate types!"
+                            << " You can still add custom, wide and bus gates.\n\n";
                     }
 
                     cout << "Would you like to add another gate?";
@@ -160,7 +214,7 @@ int main()
                 string new_element_option{ "y" };
                 while (new_element_option != "n") {
                     cout << "You can add inputs and gates [hint: add an input first]\n"
-                        << "Each input/gate will be given a reference letter (a,b,c,d,e etc)"
+                        << "Each input/gate will be given a reference name (a,b,c,d,e etc)"
                         << " and can output to many other components.\n"
                         << "What type of gate would you like to add to the circuit?";
 
@@ -172,15 +226,14 @@ int main()
                     }
 
                     string gate_type_option{ get_user_option(element_options) };
-                    string element_type{ get_element_type(gate_type_option) };
+                    string element_type{ gate_type_option == "input" ?
+                        "input" : get_element_type(gate_library[gate_type_option]) };
 
-                    // gets the letter of the element the user wants to use as an input
+                    // gets the position of the element the user wants to use as an input
                     auto get_input_element = [&user_circuit](string gate_type) {
                         cout << "\nWhich element would you like to input to the "
                             << gate_type << " gate?";
-                        vector<string> options{ get_all_element_letters((user_circuit.get_circuit_size())) };
-                        string option = get_user_option(options);
-                        return option;
+                        return get_user_element(user_circuit, false);
                     };
 
                     if (element_type == "input") {
@@ -195,7 +248,7 @@ int main()
                         user_circuit.add_element(input_value);
                         cout << "Input added with input value " << input_value
                             << ". Refer to this as '"
-                            << get_element_letter(user_circuit.get_circuit_size() - 1)
+                            << user_circuit.get_element_name(user_circuit.get_circuit_size() - 1)
                             << "'.";
                     }
                     
@@ -206,36 +259,107 @@ int main()
                     else if (element_type == "unary") {
 
                         cout << "\nThis gate can have 1 input";
-                        int element_input = get_element_position(get_input_element(gate_library[gate_type_option]));
-
-                        user_circuit.add_element(gate_library[gate_type_option], element_input);
+                        int element_input = get_input_element(gate_library[gate_type_option]);
 
-                        cout << gate_library[gate_type_option]
-                            << " gate added with an input from gate '"
-                            << get_element_letter(element_input)
-                            << "'. Refer to this as '"
-                            << get_element_letter(user_circuit.get_circuit_size() - 1)
-                            << "'.";
+                        if (!user_circuit.add_element(gate_library[gate_type_option], element_input)) {
+                            cout << "The gate was not added.";
+                        }
+                        else {
+                            cout << gate_library[gate_type_option]
+                                << " gate added with an input from gate '"
+                                << user_circuit.get_element_name(element_input)
+                                << "'. Refer to this as '"
+                                << user_circuit.get_element_name(user_circuit.get_circuit_size() - 1)
+                                << "'.";
+                        }
                     }
                     
                     else if (element_type == "binary") {
 
                         cout << "\nThis gate can have 2 inputs.\nFor the 1st input:";
-                        int element_input1 = get_element_position(get_input_element(gate_library[gate_type_option]));
+                        int element_input1 = get_input_element(gate_library[gate_type_option]);
                         cout << "For the 2nd input:";
-                        int element_input2 = get_element_position(get_input_element(gate_library[gate_type_option]));
-
-                        user_circuit.add_element(gate_library[gate_type_option],
-                            element_input1, element_input2);
-
-                        cout << gate_library[gate_type_option]
-                            << " gate added with inputs from gates '"
-                            << get_element_letter(element_input1)
-                            << "' and '"
-                            << get_element_letter(element_input2)
-                            << "'. Refer to this as '"
-                            << get_element_letter(user_circuit.get_circuit_size() - 1)
-                            << "'.";
+                        int element_input2 = get_input_element(gate_library[gate_type_option]);
+
+                        if (!user_circuit.add_element(gate_library[gate_type_option],
+                            element_input1, element_input2)) {
+                            cout << "The gate was not added.";
+                        }
+                        else {
+                            cout << gate_library[gate_type_option]
+                                << " gate added with inputs from gates '"
+                                << user_circuit.get_element_name(element_input1)
+                                << "' and '"
+                                << user_circuit.get_element_name(element_input2)
+                                << "'. Refer to this as '"
+                                << user_circuit.get_element_name(user_circuit.get_circuit_size() - 1)
+                                << "'.";
+                        }
+                    }
+
+                    else if (element_type == "lut" || element_type == "wide") {
+
+                        int number_of_gate_inputs{ get_number_of_gate_inputs(gate_library[gate_type_option]) };
+                        cout << "\nThis gate has " << number_of_gate_inputs << " inputs.";
+                        vector<int> element_inputs;
+
+                        for (int i{}; i < number_of_gate_inputs; i++) {
+                            cout << "\nFor input " << i + 1 << ":";
+                            element_inputs.push_back(get_input_element(gate_type_option));
+                        }
+
+                        if (!user_circuit.add_element(gate_library[gate_type_option], element_inputs)) {
+                            cout << "The gate was not added.";
+                        }
+                        else {
+                            cout << gate_type_option << " gate added. Refer to this as '"
+                                << user_circuit.get_element_name(user_circuit.get_circuit_size() - 1)
+                                << "'.";
+                        }
+                    }
+
+                    else if (element_type == "bus") {
+
+                        // operands are entered least significant bit first
+                        string bus_gate_type{ gate_library[gate_type_option] };
+                        string base_type;
+                        int width{};
+                        parse_sized_gate_type(bus_gate_type, base_type, width);
+                        int number_of_gate_inputs{ get_number_of_gate_inputs(bus_gate_type) };
+                        vector<int> element_inputs;
+
+                        for (int i{}; i < number_of_gate_inputs; i++) {
+                            if (i < width) {
+                                cout << "\nFor bit " << i << " of the first operand:";
+                            }
+                            else if (i < 2 * width && base_type != "SHL" && base_type != "SHR") {
+                                cout << "\nFor bit " << i - width << " of the second operand:";
+                            }
+                            else if (base_type == "MUX") {
+                                cout << "\nFor the select input (1 chooses the second operand):";
+                            }
+                            else {
+                                cout << "\nFor bit " << i - width << " of the shift amount:";
+                            }
+                            element_inputs.push_back(get_input_element(gate_type_option));
+                        }
+
+                        int first_output{ user_circuit.get_circuit_size() + 1 };
+                        if (!user_circuit.add_bus_cell(bus_gate_type, element_inputs)) {
+                            cout << "The " << gate_type_option << " was not added.";
+                        }
+                        else {
+                            cout << gate_type_option << " added. Its outputs, least significant first, are '"
+                                << user_circuit.get_element_name(first_output) << "' to '"
+                                << user_circuit.get_element_name(user_circuit.get_circuit_size() - 1) << "'";
+                            if (base_type == "ADD") {
+                                cout << " (the last is the carry)";
+                            }
+                            else if (base_type == "CMP") {
+                                cout << " (equal, less than, greater than)";
+                            }
+                            cout << ".";
+                        }
                     }
 
                     cout << "\nWould you like to add another gate?";
@@ -245,7 +369,7 @@ int main()
             }
 
 
-            case 4: { // prints the value of every input and output and the logic formula of every output
+            case 4: { // prints the value of every input and output and the logic formula of every output, also minimized
                 
                 if (user_circuit.get_circuit_size() == 0) {
                     std::cout << "Please add some gates to a circuit first!\n\n";
@@ -254,13 +378,14 @@ int main()
 
                 std::vector<int> input_positions = user_circuit.get_input_positions();
                 for (int i{}; i < input_positions.size(); i++) {
-                    std::cout << "Input " << get_element_letter(input_positions[i])
+                    std::cout << "Input " << user_circuit.get_element_name(input_positions[i])
                         << " is " << user_circuit.get_element_output(input_positions[i]) << "\n";
                 }
                 std::cout << "\n";
 
                 user_circuit.print_circuit_output();
                 user_circuit.circuit_formula();
+                user_circuit.minimized_formula();
 
                 break;
             }
@@ -295,12 +420,10 @@ int main()
                 while (print_truth_table_option != "n") {
                     cout << "Which gate in the circuit would you like to see a truth table for?";
 
-                    vector<string> element_options{ get_all_element_letters(
-                        (user_circuit.get_circuit_size())) };
-                    string user_element_option{ get_user_option(element_options) };
+                    int element_position{ get_user_element(user_circuit, false) };
                     cout << "\n";
 
-                    user_circuit.element_truth_table(get_element_position(user_element_option));
+                    user_circuit.element_truth_table(element_position);
 
                     cout << "\n\nWould you like to view the truth table for"
                         << " another gate in the circuit? ";
@@ -354,23 +477,27 @@ int main()
 
                 while (change_input_option != "n") {
                     cout << "Which input would you like to change?";
-                    vector<string> input_options{};
-                    vector<int> input_positions{ user_circuit.get_input_positions() };
-
-                    for (const int& position : input_positions) {
-                        input_options.push_back(get_element_letter(position));
-                    }
-                    string user_input_option{ get_user_option(input_options) };
-                    int input_position = get_element_position(user_input_option);
+                    int input_position{ get_user_element(user_circuit, true) };
                     bool previous_value{ user_circuit.get_element_output(input_position) };
 
+                    user_circuit.take_changed_outputs(); // forgets changes made before this one
                     user_circuit.change_input(input_position); // also sequentially updates the rest of the circuit
+                    waveform.dump(++waveform_time);
 
-                    cout << "input '" << user_input_option
+                    cout << "input '" << user_circuit.get_element_name(input_position)
                         << "' swapped from " << previous_value << " to "
-                        << user_circuit.get_element_output(input_position)
+                        << user_circuit.get_element_output(input_position) << "\n";
 
-                        << "\n\nWould you like to change another input?";
+                    vector<int> changed_outputs{ user_circuit.take_changed_outputs() };
+                    if (changed_outputs.empty()) {
+                        cout << "No outputs changed.\n";
+                    }
+                    for (const int& output : changed_outputs) {
+                        cout << "Output " << user_circuit.get_element_name(output) << " is now "
+                            << user_circuit.get_element_output(output) << "\n";
+                    }
+
+                    cout << "\nWould you like to change another input?";
                     change_input_option = get_user_option(yes_no_options);
                 }
                 break;
@@ -389,6 +516,390 @@ int main()
             }
 
 
+            case 10: { // evaluates the circuit with unknown (X) or undriven (Z) inputs
+
+                using namespace std;
+
+                if (user_circuit.get_circuit_size() == 0) {
+                    cout << "Please add some gates to a circuit first!\n\n";
+                    break;
+                }
+
+                cout << "Type 'table' to print the truth table including unknown (X) inputs,"
+                    << " or 'values' to choose a 0/1/X/Z value for each input.";
+                const vector<string> analysis_options{ "table", "values" };
+
+                if (get_user_option(analysis_options) == "table") {
+                    user_circuit.four_valued_truth_table();
+                    cout << "\n";
+                    break;
+                }
+
+                const vector<string> value_options{ "0", "1", "x", "z" };
+                vector<logic_value> input_values;
+
+                for (const int& position : user_circuit.get_input_positions()) {
+                    cout << "Set a value for input '" << user_circuit.get_element_name(position) << "'.";
+                    string value_option{ get_user_option(value_options) };
+
+                    if (value_option == "0") {
+                        input_values.push_back(logic_value::zero);
+                    }
+                    else if (value_option == "1") {
+                        input_values.push_back(logic_value::one);
+                    }
+                    else if (value_option == "x") {
+                        input_values.push_back(logic_value::x);
+                    }
+                    else {
+                        input_values.push_back(logic_value::z);
+                    }
+                }
+                user_circuit.four_valued_formula(input_values);
+                break;
+            }
+
+
+            case 11: { // covers the circuit with k-input look-up table gates, which can replace the circuit
+
+                using namespace std;
+
+                if (user_circuit.get_circuit_size() == 0) {
+                    cout << "Please add some gates to a circuit first!\n\n";
+                    break;
+                }
+
+                cout << "How many inputs should each look-up table gate have?";
+                vector<int> lut_size_options;
+                for (int i{ 2 }; i <= maximum_lut_inputs; i++) {
+                    lut_size_options.push_back(i);
+                }
+                lut_mapper mapper(get_user_option(lut_size_options));
+
+                // luts are mapped onto primitive gates, so module instances are flattened first,
+                // in a copy so the current circuit keeps sharing its modules unless it is replaced
+                circuit flattened_circuit;
+                if (!user_circuit.copy_circuit(flattened_circuit)) {
+                    break;
+                }
+                int instances_flattened{ flattened_circuit.flatten_module_instances() };
+                if (instances_flattened > 0) {
+                    cout << "\n" << instances_flattened << " module instances are mapped as their gates.\n";
+                }
+
+                circuit mapped_circuit;
+                if (!mapper.map(flattened_circuit)) {
+                    break;
+                }
+                mapper.build_mapped_circuit(mapped_circuit);
+
+                int number_of_gates{ flattened_circuit.get_circuit_size()
+                    - static_cast<int>(flattened_circuit.get_input_positions().size()) };
+                cout << "\n" << number_of_gates << " gates with a depth of " << flattened_circuit.get_number_of_levels() - 1
+                    << " can be replaced by " << mapper.get_number_of_luts()
+                    << " look-up table gates with a depth of " << mapper.get_mapped_depth() << ".\n";
+
+                if (!mapper.verify_mapping(flattened_circuit, mapped_circuit)) {
+                    break;
+                }
+                cout << "The mapped circuit gives the same outputs as the current circuit.\n\n"
+                    << "Replace the current circuit with the mapped circuit? Inputs and outputs keep their names.";
+
+                if (get_user_option(yes_no_options) == "y") {
+                    waveform.close();
+                    user_circuit.reset_circuit();
+                    mapper.build_mapped_circuit(user_circuit);
+                    cout << "Circuit replaced.\n\n";
+                }
+                break;
+            }
+
+
+            case 12: { // adds the elements of a netlist file to the circuit, keeping the file's names
+
+                using namespace std;
+
+                cout << "Type the name of the netlist file.\n\n";
+                string file_name{ get_user_text() };
+                int previous_size{ user_circuit.get_circuit_size() };
+
+                if (read_netlist(file_name, user_circuit)) {
+                    cout << "\n" << user_circuit.get_circuit_size() - previous_size
+                        << " elements read from '" << file_name << "'.\n\n";
+                }
+                break;
+            }
+
+
+            case 13: { // shows how much simulation work has been done, to find slow parts of a circuit
+
+                using namespace std;
+
+                cout << "Type 'show' to print the simulation counters, 'json' to save them to a file,"
+                    << " or 'reset' to set them back to 0.";
+                const vector<string> statistics_options{ "show", "json", "reset" };
+                string statistics_option{ get_user_option(statistics_options) };
+
+                if (statistics_option == "show") {
+                    user_circuit.print_statistics();
+                }
+                else if (statistics_option == "json") {
+                    cout << "Type the name of the file to write.\n\n";
+                    string file_name{ get_user_text() };
+                    ofstream statistics_file(file_name);
+                    statistics_file << user_circuit.get_statistics_json();
+
+                    if (statistics_file) {
+                        cout << "Statistics written to '" << file_name << "'.\n\n";
+                    }
+                    else {
+                        cerr << "\nError: could not write to '" << file_name << "'\n";
+                    }
+                }
+                else {
+                    user_circuit.reset_statistics();
+                    cout << "Counters reset.\n\n";
+                }
+                break;
+            }
+
+
+            case 14: { // records what every thread does over time, to be viewed in a trace viewer
+
+                using namespace std;
+
+#ifndef LCS_INSTRUMENTATION
+                cout << "Timeline tracing was left out of this build (LCS_NO_INSTRUMENTATION).\n\n";
+                break;
+#endif
+                if (!is_tracing()) {
+                    start_tracing();
+                    cout << "Tracing started. Use the other options, then choose option 14 again to save the trace.\n\n";
+                    break;
+                }
+
+                cout << "Type the name of the file to save the trace to.\n\n";
+                string file_name{ get_user_text() };
+
+                if (write_trace(file_name)) {
+                    cout << "Trace saved to '" << file_name << "'. Open it in chrome://tracing or ui.perfetto.dev.\n\n";
+                }
+                break;
+            }
+
+
+            case 15: { // shows what the circuit's memory is used for, and limits it
+
+                using namespace std;
+
+                user_circuit.print_memory_usage();
+                cout << "Type a memory budget such as 512M or 2G, 'none' to remove the budget, or 'keep'.\n\n";
+
+                while (true) {
+                    string budget_text{ get_user_text() };
+                    size_t budget{};
+
+                    if (budget_text == "keep") {
+                        break;
+                    }
+                    if (budget_text == "none") {
+                        user_circuit.set_memory_budget(0);
+                        cout << "Memory budget removed.\n\n";
+                        break;
+                    }
+                    if (parse_memory_size(budget_text, budget) && budget > 0) {
+                        user_circuit.set_memory_budget(budget);
+                        cout << "Memory budget set to " << format_memory_size(budget) << ".\n\n";
+                        break;
+                    }
+                    cout << "\nPlease type a size such as 512M, or 'none' or 'keep'.\n\n";
+                }
+                break;
+            }
+
+
+            case 16: { // records every signal while inputs are changed with option 8, for a waveform viewer
+
+                using namespace std;
+
+                if (waveform.is_open()) {
+                    cout << waveform.get_number_of_value_changes() << " value changes over " << waveform_time
+                        << " input changes recorded.\n";
+                    if (waveform.close()) {
+                        cout << "Waveform file closed.\n\n";
+                    }
+                    break;
+                }
+                if (user_circuit.get_circuit_size() == 0) {
+                    cout << "Please add some inputs to a circuit first!\n\n";
+                    break;
+                }
+
+                cout << "Type the name of the file to save the waveform to.\n\n";
+                string file_name{ get_user_text() };
+
+                if (waveform.open(file_name, user_circuit)) {
+                    waveform_time = 0;
+                    cout << "Recording started. Change inputs with option 8, then choose option 16 again to finish.\n"
+                        << "The file can be opened in a waveform viewer such as GTKWave.\n\n";
+                }
+                break;
+            }
+
+
+            case 17: { // simulates a revised version of the circuit against it, re-evaluating only what changed
+
+                using namespace std;
+
+                if (user_circuit.get_circuit_size() == 0) {
+                    cout << "Please add some gates to a circuit first!\n\n";
+                    break;
+                }
+
+                cout << "Type the name of the revised netlist file.\n\n";
+                string file_name{ get_user_text() };
+                circuit revised_circuit;
+                differential_simulator differences;
+                if (!read_netlist(file_name, revised_circuit) || !differences.match(user_circuit, revised_circuit)) {
+                    break;
+                }
+
+                int number_of_inputs{ static_cast<int>(user_circuit.get_input_positions().size()) };
+                bool is_exhaustive{ is_comparison_exhaustive(number_of_inputs) };
+                bit_matrix input_vectors{ get_comparison_vectors(number_of_inputs) };
+                if (!differences.simulate(user_circuit, input_vectors)) {
+                    break;
+                }
+
+                cout << "\n" << differences.get_number_of_shared_elements() << " elements of the revised circuit are unchanged, "
+                    << differences.get_number_of_reevaluated_elements() << " were simulated again on "
+                    << input_vectors.get_number_of_columns() << (is_exhaustive ? " (all)" : " random") << " input vectors.\n\n";
+                for (int output{}; output < differences.get_number_of_compared_outputs(); output++) {
+                    cout << differences.get_output_name(output) << ": ";
+                    if (differences.get_first_mismatch(output) == -1) {
+                        cout << "same\n";
+                        continue;
+                    }
+                    cout << "differs first on input vector " << differences.get_first_mismatch(output) << " (";
+                    for (int i{}; i < number_of_inputs; i++) {
+                        cout << input_vectors.get_bit(i, differences.get_first_mismatch(output));
+                    }
+                    cout << ")\n";
+                }
+                for (const string& output : differences.get_unmatched_outputs()) {
+                    cout << output << ": not in the current circuit\n";
+                }
+                cout << "\n";
+                break;
+            }
+
+
+            case 18: { // rebuilds chains of and/or/xor gates as balanced trees, which can replace the circuit
+
+                using namespace std;
+
+                if (user_circuit.get_circuit_size() == 0) {
+                    cout << "Please add some gates to a circuit first!\n\n";
+                    break;
+                }
+
+                tree_balancer balancer;
+                if (!balancer.balance(user_circuit)) {
+                    break;
+                }
+                circuit balanced_circuit;
+                balancer.build_balanced_circuit(balanced_circuit);
+
+                const tree_balancer::depth_statistics& before{ balancer.get_source_statistics() };
+                const tree_balancer::depth_statistics& after{ balancer.get_balanced_statistics() };
+                cout << "\n" << balancer.get_number_of_rebuilt_trees() << " gate chains or trees can be balanced.\n"
+                    << "Depth: " << before.depth << " before, " << after.depth << " after.\n"
+                    << "Elements on a critical path: " << before.critical_elements << " before, "
+                    << after.critical_elements << " after.\n"
+                    << "Outputs at the full depth: " << before.critical_outputs << " before, "
+                    << after.critical_outputs << " after.\n";
+
+                if (balancer.get_number_of_rebuilt_trees() == 0 || !balancer.verify_balancing(user_circuit, balanced_circuit)) {
+                    cout << "\n";
+                    break;
+                }
+                cout << "The balanced circuit gives the same outputs as the current circuit.\n\n"
+                    << "Replace the current circuit with the balanced circuit? Inputs and outputs keep their names.";
+
+                if (get_user_option(yes_no_options) == "y") {
+                    waveform.close();
+                    user_circuit.reset_circuit();
+                    balancer.build_balanced_circuit(user_circuit);
+                    cout << "Circuit replaced.\n\n";
+                }
+                break;
+            }
+
+
+            case 19: { // estimates how often each element is 1 and changes, from random input values
+
+                using namespace std;
+
+                vector<int> input_positions{ user_circuit.get_input_positions() };
+                if (input_positions.empty()) {
+                    cout << "Please add some inputs to a circuit first!\n\n";
+                    break;
+                }
+
+                // reads a probability from 0 to 1, asking again until one is typed
+                auto get_user_probability = []() {
+                    while (true) {
+                        string probability_text{ get_user_text() };
+                        istringstream probability_stream(probability_text);
+                        double probability{};
+                        if (probability_stream >> probability && probability_stream.eof()
+                                && probability >= 0 && probability <= 1) {
+                            return probability;
+                        }
+                        cout << "\nPlease type a number from 0 to 1, such as 0.5.\n\n";
+                    }
+                };
+
+                cout << "Should every input be 1 with the same probability?";
+                vector<double> input_probabilities;
+                if (get_user_option(yes_no_options) == "y") {
+                    cout << "Type the probability of an input being 1 in each clock cycle.\n\n";
+                    input_probabilities.assign(input_positions.size(), get_user_probability());
+                }
+                else {
+                    for (const int& position : input_positions) {
+                        cout << "Type the probability of input " << user_circuit.get_element_name(position)
+                            << " being 1 in each clock cycle.\n\n";
+                        input_probabilities.push_back(get_user_probability());
+                    }
+                }
+
+                activity_estimator estimator;
+                if (!estimator.estimate(user_circuit, input_probabilities)) {
+                    break;
+                }
+                cout << "\n" << estimator.get_number_of_cycles() << " random clock cycles simulated ("
+                    << estimator.get_cycles_per_second() / 1e6 << " million per second).\n";
+                if (estimator.is_converged()) {
+                    cout << "Every estimate is within +/- " << estimator.get_target_error() << ", 19 times out of 20.\n\n";
+                }
+                else {
+                    cout << "Some estimates had not settled when the simulation stopped.\n\n";
+                }
+                estimator.print_activity(20);
+
+                cout << "Save the estimates for every element to a file?";
+                if (get_user_option(yes_no_options) == "y") {
+                    cout << "Type the name of the file to write.\n\n";
+                    string file_name{ get_user_text() };
+                    if (estimator.write_activity(file_name)) {
+                        cout << "Estimates written to '" << file_name << "'.\n\n";
+                    }
+                }
+                break;
+            }
+
+
             case 0: //  provides additional detail on using the program
 
                 std::cout << "\n-To get started, create a circuit option 1, then create some gates with option 2.\n\n"
@@ -397,8 +908,31 @@ int main()
                     << "-You will need to have at least one input and select it's input value (1 or 0).\n\n"
                     << "-For any gates you make, you will need to choose its inputs.\n\n"
                     << "-Some gates require a single input and some require two\n\n"
+                    << "-Custom gates with up to " << maximum_lut_inputs
+                    << " inputs can be defined by their truth table with option 2.\n\n"
+                    << "-Option 2 also makes and/or/xor gates with up to " << maximum_wide_gate_inputs
+                    << " inputs, and bus cells (adders, comparators, multiplexers, shifters) up to "
+                    << maximum_bus_width << " bits wide.\n\n"
                     << "-You then have several options to view circuit information (input/output values, truth tables, logic formulae).\n\n"
                     << "-You can also swap the value of an input from 1 to 0 or vice versa.\n\n"
+                    << "-Option 10 shows how unknown (X) or undriven (Z) inputs propagate through the circuit.\n\n"
+                    << "-Option 11 rebuilds the circuit from look-up table gates, which usually needs fewer, shallower gates.\n\n"
+                    << "-Option 12 reads a netlist file, with lines such as 'input carry_in 0' or 'sum = XOR a b'.\n"
+                    << " Elements can have any names without spaces, and can be listed in any order.\n"
+                    << " A block from 'module adder a b c -> sum carry' to 'endmodule' defines a module, which later\n"
+                    << " lines can use like a gate; its gates are stored once however many times it is used.\n\n"
+                    << "-Option 13 counts the simulation work done, such as how many gates each input change re-evaluates.\n\n"
+                    << "-Option 14 records a timeline of the work done by each thread, to see where time goes.\n\n"
+                    << "-Option 15 shows the memory the circuit uses and sets a limit on it. Truth tables too large\n"
+                    << " for the limit are printed row by row instead of being stored.\n\n"
+                    << "-Option 16 records each input change made with option 8, and the signal changes it causes,\n"
+                    << " as a VCD file for a waveform viewer.\n\n"
+                    << "-Option 17 reads an edited copy of the circuit's netlist and reports, for each output, the first\n"
+                    << " input vector on which the two differ. Logic the edit left alone is only simulated once.\n\n"
+                    << "-Option 18 rebuilds chains of and/or/xor gates (such as a gate added two inputs at a time)\n"
+                    << " as balanced trees, so signals pass through fewer gates.\n\n"
+                    << "-Option 19 drives each input with random values (1 with a probability you choose) for as many\n"
+                    << " clock cycles as it takes to estimate how often every element is 1 and how often it switches.\n\n"
                     << "-When you are finised, you can create a new circuit with option '1' or exit with option '9'.\n\n";
 
                 break;
@@ -437,7 +971,8 @@ template <class class_type> class_type get_user_option(const std::vector<class_t
                 throw invalid_input;
             } 
             else if (is_integral<class_type>::value) {
-                if (user_input.size() != 1 || user_input.find_first_of("0123456789") == string::npos) {
+                if (user_input.empty() || user_input.size() > 2
+                    || user_input.find_first_not_of("0123456789") != string::npos) {
                     throw invalid_input;
                 }
             } 
@@ -519,31 +1054,166 @@ void create_gate(std::unordered_map<std::string, std::string>& gate_library,
 }
 
 
-// creates a vector of letter-values for all circuit elements
-// used for listing element options to the user
-std::vector<std::string> get_all_element_letters(const int& circuit_size)
+// adds an and/or/xor gate (or its inverse) with any number of inputs to the gate_library
+// named after its type, eg. and8 for an 8-input AND gate
+void create_wide_gate(std::unordered_map<std::string, std::string>& gate_library)
+{
+    using namespace std;
+
+    cout << "\nWhich type of gate should it be?";
+    const vector<string> base_options{ "and","or","nand","nor","xor","xnor" };
+    string base_option{ get_user_option(base_options) };
+
+    cout << "How many inputs should the gate have?";
+    vector<int> input_count_options;
+    for (int i{ 3 }; i <= maximum_wide_gate_inputs; i++) {
+        input_count_options.push_back(i);
+    }
+    int number_of_gate_inputs{ get_user_option(input_count_options) };
+
+    string gate_name{ base_option + to_string(number_of_gate_inputs) };
+    string gate_type{ gate_name };
+    for (char& letter : gate_type) {
+        letter = static_cast<char>(toupper(letter));
+    }
+    gate_library[gate_name] = gate_type;
+    cout << "\n" << gate_name << " gate added to the gate library.\n";
+}
+
+
+// adds a word-level bus cell to the gate_library, named after its type, eg. add8 for an 8-bit adder
+void create_bus_cell(std::unordered_map<std::string, std::string>& gate_library)
 {
-    std::vector<std::string> letters;
+    using namespace std;
+
+    cout << "\nWhich bus cell would you like? (add: sum and carry, cmp: equal/less/greater,"
+        << " mux: choose between two operands, shl/shr: shift left/right)";
+    const vector<string> cell_options{ "add","cmp","mux","shl","shr" };
+    string cell_option{ get_user_option(cell_options) };
 
-    for (int i{}; i < circuit_size; i++) {
-        letters.push_back(get_element_letter(i));
+    cout << "How many bits wide should its operands be?";
+    vector<int> width_options;
+    for (int i{ 1 }; i <= maximum_bus_width; i++) {
+        width_options.push_back(i);
     }
-    return letters;
+    int width{ get_user_option(width_options) };
+
+    string gate_name{ cell_option + to_string(width) };
+    string gate_type{ gate_name };
+    for (char& letter : gate_type) {
+        letter = static_cast<char>(toupper(letter));
+    }
+    gate_library[gate_name] = gate_type;
+    cout << "\n" << gate_name << " bus cell added to the gate library.\n";
 }
 
 
-// converts element letter into its position in the circuit
-// (a,b,c --> 0,1,2 and so on)
-int get_element_position(const std::string& element_letter)
+// adds a user-defined gate to the gate_library, stored as a look-up table gate type
+// the user names the gate, then gives its output for every row of its truth table
+void create_custom_gate(std::unordered_map<std::string, std::string>& gate_library)
 {
-    int element_position{};
-    int value_of_letter{ 1 };
+    using namespace std;
+
+    cout << "\nType a name for the new gate.\n\n";
+    string gate_name{ get_user_text() };
+    while (gate_library.count(gate_name) != 0 || gate_name == "input" || gate_name.size() < 2) {
+        cout << "\n'" << gate_name << "' is already used or too short. Please type another name.\n\n";
+        gate_name = get_user_text();
+    }
 
-    for (auto it = element_letter.rbegin(); it != element_letter.rend(); it++) {
-        element_position += value_of_letter * static_cast<int>(alphabet.find(*it));
-        value_of_letter += 1;
+    cout << "How many inputs should the gate have?";
+    vector<int> input_count_options;
+    for (int i{ 1 }; i <= maximum_lut_inputs; i++) {
+        input_count_options.push_back(i);
+    }
+    int number_of_gate_inputs{ get_user_option(input_count_options) };
+    int number_of_rows{ 1 << number_of_gate_inputs };
+
+    // shows the rows in the order the outputs should be typed
+    vector<vector<bool>> inputs{ truth_table_inputs_generator(number_of_gate_inputs) };
+    for (int i{}; i < number_of_gate_inputs; i++) {
+        cout << "Input " << i + 1 << "|";
+    }
+    cout << "\n";
+    for (int row{}; row < number_of_rows; row++) {
+        for (int i{}; i < number_of_gate_inputs; i++) {
+            cout << "   " << inputs[i][row] << "   |";
+        }
+        cout << "\n";
+    }
+
+    cout << "\nType the output for each row above, in order, as one string of "
+        << number_of_rows << " 0s and 1s.\n\n";
+    string outputs{ get_user_text() };
+    while (outputs.size() != static_cast<size_t>(number_of_rows) || outputs.find_first_not_of("01") != string::npos) {
+        cout << "\nPlease type exactly " << number_of_rows << " 0s and 1s.\n\n";
+        outputs = get_user_text();
+    }
+
+    uint64_t truth_table_mask{};
+    for (int row{}; row < number_of_rows; row++) {
+        if (outputs[row] == '1') {
+            truth_table_mask |= uint64_t{ 1 } << row;
+        }
+    }
+
+    gate_library[gate_name] = make_lut_gate_type(number_of_gate_inputs, truth_table_mask);
+    cout << "\n" << gate_name << " gate added to the gate library.\n";
+}
+
+
+// gets a line of text with no spaces from the user
+std::string get_user_text()
+{
+    using namespace std;
+
+    while (true) {
+        string user_input{};
+        cin.clear();
+        getline(cin, user_input);
+        cout << "------------------------------------------------------------------------------\n";
+
+        if (!user_input.empty() && user_input.find(" ") == string::npos) {
+            return user_input;
+        }
+        cout << "\nPlease type some text without spaces.\n\n";
+    }
+}
+
+
+// gets the position of a circuit element (or circuit input) from its name
+// names are only listed for small circuits, as a circuit read from a netlist file can have millions
+int get_user_element(const circuit& user_circuit, const bool& inputs_only)
+{
+    using namespace std;
+
+    const int maximum_listed_names{ 64 };
+    vector<int> input_positions{ user_circuit.get_input_positions() };
+    int number_of_options{ inputs_only ?
+        static_cast<int>(input_positions.size()) : user_circuit.get_circuit_size() };
+
+    while (true) {
+        if (number_of_options <= maximum_listed_names) {
+            cout << "\n\nOptions:\n";
+            for (int i{}; i < number_of_options; i++) {
+                cout << user_circuit.get_element_name(inputs_only ? input_positions[i] : i)
+                    << (i + 1 < number_of_options ? ", " : "");
+            }
+            cout << "\n\n";
+        }
+        else {
+            cout << "\n\nType the name of " << (inputs_only ? "an input" : "an element") << ".\n\n";
+        }
+
+        string name{ get_user_text() };
+        int position{ user_circuit.find_element(name) };
+        if (position != -1 && (!inputs_only
+            || get_element_type(user_circuit.get_element_gate_type(position)) == "input")) {
+            return position;
+        }
+        cout << "\n'" << name << "' is not " << (inputs_only ? "an input" : "an element")
+            << " of the circuit.";
     }
-    return element_position;
 }
 
 
@@ -582,4 +1252,61 @@ void print_gate_truth_table(const std::string& gate_type)
 
         print_truth_table(inputs, outputs);
     }
+
+    else if (element_type == "bus") {
+
+        std::cout << gate_type << " is a bus cell working on whole words, with " << get_number_of_gate_inputs(gate_type)
+            << " inputs and " << get_number_of_gate_outputs(gate_type)
+            << " outputs. Its output bits are shown by the circuit's truth table instead.\n";
+        return;
+    }
+
+    else if (element_type == "wide" && get_number_of_gate_inputs(gate_type) > maximum_lut_inputs) {
+
+        std::cout << gate_type << " has " << get_number_of_gate_inputs(gate_type)
+            << " inputs, so its truth table is too large to print.\n";
+        return;
+    }
+
+    else if (element_type == "lut" || element_type == "wide") {
+
+        int number_of_gate_inputs{ get_number_of_gate_inputs(gate_type) };
+        std::cout << gate_type << " gate truth table:\n\n";
+        std::vector<std::vector<bool>> inputs = truth_table_inputs_generator(number_of_gate_inputs);
+        std::vector<std::vector<bool>> outputs(1);
+
+        for (std::size_t i{}; i < inputs[0].size(); i++) {
+            std::vector<bool> input;
+            for (int j{}; j < number_of_gate_inputs; j++) {
+                input.push_back(inputs[j][i]);
+            }
+            outputs[0].push_back(logic_operation(gate_type, input));
+        }
+
+        print_truth_table(inputs, outputs);
+        return;
+    }
+
+    // the same table again, including unknown (X) and undriven (Z) input values
+    int number_of_gate_inputs{ element_type == "unary" ? 1 : 2 };
+    const std::vector<logic_value> values{ logic_value::zero, logic_value::one, logic_value::x, logic_value::z };
+    std::vector<std::vector<logic_value>> four_valued_inputs(number_of_gate_inputs);
+    std::vector<std::vector<logic_value>> four_valued_outputs(1);
+
+    for (const logic_value& value1 : values) {
+        for (const logic_value& value2 : values) {
+            std::vector<logic_value> input{ value1, value2 };
+            input.resize(number_of_gate_inputs);
+            if (number_of_gate_inputs == 1 && value2 != logic_value::zero) {
+                continue;
+            }
+            for (int i{}; i < number_of_gate_inputs; i++) {
+                four_valued_inputs[i].push_back(input[i]);
+            }
+            four_valued_outputs[0].push_back(four_valued_logic_operation(gate_type, input));
+        }
+    }
+
+    std::cout << "\n" << gate_type << " gate truth table with unknown (X) and undriven (Z) inputs:\n\n";
+    print_four_valued_truth_table(four_valued_inputs, four_valued_outputs);
 }
\ No newline at end of file
@@ -0,0 +1,96 @@
+// memory_usage.cpp (last modified: 18/10/26)
+// Contains definition of the memory_usage member and the functions declared in memory_usage.h
+
+#include <vector>
+#include <string>
+#include <sstream>
+#include <iomanip>
+#include <limits>
+#include <cctype>
+#include <cstdint>
+#include <cstddef>
+#include "memory_usage.h"
+
+
+std::size_t memory_usage::get_total() const
+{
+    return netlist + names + evaluation_plan + value_arrays + truth_table_buffers + result_cache + modules;
+}
+
+
+std::size_t get_vector_memory(const std::vector<bool>& values)
+{
+    return values.capacity() / 8;
+}
+
+
+std::size_t get_truth_table_memory(const int& number_of_inputs, const std::size_t& number_of_columns)
+{
+    const std::size_t unlimited{ std::numeric_limits<std::size_t>::max() };
+    if (number_of_inputs >= std::numeric_limits<std::size_t>::digits - 3) {
+        return unlimited;
+    }
+    std::size_t bytes_per_column{ (std::size_t{ 1 } << number_of_inputs) / 8 + 1 };
+    if (number_of_columns > 0 && bytes_per_column > unlimited / number_of_columns) {
+        return unlimited;
+    }
+    return bytes_per_column * number_of_columns;
+}
+
+
+std::string format_memory_size(const std::size_t& bytes)
+{
+    const std::vector<std::string> units{ "bytes", "KiB", "MiB", "GiB", "TiB" };
+    double size{ static_cast<double>(bytes) };
+    size_t unit{};
+
+    while (size >= 1024 && unit + 1 < units.size()) {
+        size /= 1024;
+        unit++;
+    }
+    std::stringstream text;
+    if (unit == 0) {
+        text << bytes << " " << units[unit];
+    }
+    else {
+        text << std::fixed << std::setprecision(1) << size << " " << units[unit];
+    }
+    return text.str();
+}
+
+
+bool parse_memory_size(const std::string& text, std::size_t& bytes)
+{
+    std::istringstream words(text);
+    double size{};
+    std::string unit;
+
+    if (!(words >> size) || size < 0) {
+        return false;
+    }
+    words >> unit;
+    std::string extra_word;
+    if (words >> extra_word) {
+        return false;
+    }
+
+    const std::string unit_letters{ "KMGT" };
+    double multiplier{ 1 };
+    if (!unit.empty()) {
+        size_t power{ unit_letters.find(static_cast<char>(toupper(unit[0]))) };
+        std::string rest{ unit.substr(1) };
+        if (power == std::string::npos || !(rest.empty() || rest == "B" || rest == "iB" || rest == "b")) {
+            return false;
+        }
+        for (size_t i{}; i <= power; i++) {
+            multiplier *= 1024;
+        }
+    }
+
+    double size_in_bytes{ size * multiplier };
+    if (size_in_bytes >= static_cast<double>(std::numeric_limits<std::size_t>::max())) {
+        return false;
+    }
+    bytes = static_cast<std::size_t>(size_in_bytes);
+    return true;
+}
@@ -0,0 +1,49 @@
+// memory_usage.h (last modified: 18/10/26)
+// header file for the memory_usage struct, which breaks down the memory a circuit uses by part,
+// and for functions that estimate and print memory sizes
+
+#ifndef MEMORY_USAGE_H
+#define MEMORY_USAGE_H
+
+#include <vector>
+#include <string>
+#include <cstdint>
+#include <cstddef>
+
+
+// bytes used by each part of a circuit
+struct memory_usage
+{
+    std::size_t netlist;                // elements, their connections, levels and cone hashes
+    std::size_t names;                  // element names and the tables mapping them to positions
+    std::size_t evaluation_plan;        // levelized copy of the circuit used for whole-circuit evaluation
+    std::size_t value_arrays;           // element values used while evaluating the plan, and published copies
+    std::size_t truth_table_buffers;    // largest truth table held at once since the statistics were last reset
+    std::size_t result_cache;           // cached formulae and truth table columns
+    std::size_t modules;                // modules used by module instances, each counted once
+
+    std::size_t get_total() const;
+};
+
+
+// memory held by a vector, counting its spare capacity
+template <class value_type> std::size_t get_vector_memory(const std::vector<value_type>& values)
+{
+    return values.capacity() * sizeof(value_type);
+}
+
+// memory held by a vector<bool>, which stores one bit per value
+std::size_t get_vector_memory(const std::vector<bool>& values);
+
+// bytes needed by a truth table of 2^number_of_inputs rows with the given number of bit columns,
+// or SIZE_MAX if that does not fit in a size_t
+std::size_t get_truth_table_memory(const int& number_of_inputs, const std::size_t& number_of_columns);
+
+// a number of bytes written with the largest suitable unit, eg. "1.5 MiB"
+std::string format_memory_size(const std::size_t& bytes);
+
+// reads sizes such as "512", "64K", "1.5M" or "2G" (units are powers of 1024)
+// returns false if text is not a size
+bool parse_memory_size(const std::string& text, std::size_t& bytes);
+
+#endif
@@ -0,0 +1,303 @@
+// module_definition.cpp (last modified: 18/10/26)
+// Contains definition of all module_definition, module_library and module_library_scope class members
+
+#include <iostream>
+#include <vector>
+#include <string>
+#include <memory>
+#include <atomic>
+#include <mutex>
+#include <unordered_map>
+#include <algorithm>
+#include <functional>
+#include <cctype>
+#include <cstdint>
+#include <cstddef>
+#include "module_definition.h"
+#include "circuit.h"
+#include "evaluation_plan.h"
+#include "result_cache.h"
+#include "universal_functions.h"
+#include "memory_usage.h"
+
+
+module_definition::module_definition(const std::string& set_name, std::unique_ptr<circuit> set_body,
+    const std::vector<int>& set_output_positions) :
+    name{ set_name }, body{ std::move(set_body) }, output_positions{ set_output_positions }, structure_hash{ 0 },
+    kernel{ nullptr }, input_indices{}, output_indices{}, scratch_values{}, is_scratch_in_use{ false }
+{
+    // the hash covers everything that decides what the module does, so a module read again
+    // from the same netlist can be recognised as the one already defined
+    structure_hash = combine_hash(std::hash<std::string>()(name), body->get_input_positions().size());
+    for (int position{}; position < body->get_circuit_size(); position++) {
+        structure_hash = combine_hash(structure_hash, std::hash<std::string>()(body->get_element_gate_type(position)));
+        if (get_element_type(body->get_element_gate_type(position)) != "input") {
+            for (const int& input : body->get_element_input_positions(position)) {
+                structure_hash = combine_hash(structure_hash, input);
+            }
+        }
+    }
+    for (const int& output : output_positions) {
+        structure_hash = combine_hash(structure_hash, output);
+    }
+
+    // the plan is built once here, so evaluating never changes the body
+    kernel = &body->get_evaluation_plan();
+    for (const int& input : body->get_input_positions()) {
+        input_indices.push_back(kernel->get_evaluation_index(input));
+    }
+    for (const int& output : output_positions) {
+        output_indices.push_back(kernel->get_evaluation_index(output));
+    }
+    scratch_values.assign(kernel->get_size(), 0);
+}
+
+
+const std::string& module_definition::get_name() const
+{
+    return name;
+}
+
+const circuit& module_definition::get_body() const
+{
+    return *body;
+}
+
+const std::vector<int>& module_definition::get_output_positions() const
+{
+    return output_positions;
+}
+
+int module_definition::get_number_of_inputs() const
+{
+    return static_cast<int>(input_indices.size());
+}
+
+int module_definition::get_number_of_outputs() const
+{
+    return static_cast<int>(output_indices.size());
+}
+
+std::uint64_t module_definition::get_structure_hash() const
+{
+    return structure_hash;
+}
+
+std::size_t module_definition::get_memory_used() const
+{
+    return sizeof(*this) + name.capacity() + body->get_memory_usage().get_total() + get_vector_memory(output_positions)
+        + get_vector_memory(input_indices) + get_vector_memory(output_indices) + get_vector_memory(scratch_values);
+}
+
+
+// evaluates the module for one set of input values, bit i of input_word being input i
+// returns the outputs packed the same way
+// the kernel's inputs are its level 0, so its gates start at the evaluation index after the last input
+std::uint64_t module_definition::evaluate(const std::uint64_t& input_word) const
+{
+    bool is_scratch_taken{ !is_scratch_in_use.exchange(true) };
+    std::vector<unsigned char> local_values;
+    if (!is_scratch_taken) {
+        local_values.assign(kernel->get_size(), 0);
+    }
+    std::vector<unsigned char>& values{ is_scratch_taken ? scratch_values : local_values };
+
+    for (int i{}; i < get_number_of_inputs(); i++) {
+        values[input_indices[i]] = static_cast<unsigned char>((input_word >> i) & 1);
+    }
+    kernel->evaluate_range(values, get_number_of_inputs(), kernel->get_size());
+
+    std::uint64_t output_word{};
+    for (int k{}; k < get_number_of_outputs(); k++) {
+        output_word |= static_cast<std::uint64_t>(values[output_indices[k]]) << k;
+    }
+    if (is_scratch_taken) {
+        is_scratch_in_use.store(false);
+    }
+    return output_word;
+}
+
+// evaluates the module for 64 sets of input values at once, one per bit of each input's word
+// values is scratch space for the kernel, which callers keep so each instance does not allocate its own
+void module_definition::evaluate_words(const std::uint64_t* input_words, std::uint64_t* output_words,
+    std::vector<std::uint64_t>& values) const
+{
+    values.assign(kernel->get_size(), 0);
+    for (int i{}; i < get_number_of_inputs(); i++) {
+        values[input_indices[i]] = input_words[i];
+    }
+    kernel->evaluate_words(values);
+    for (int k{}; k < get_number_of_outputs(); k++) {
+        output_words[k] = values[output_indices[k]];
+    }
+}
+
+// evaluates the module for 64 four-valued patterns in the dual-rail encoding of evaluate_dual_rail
+// can_be_zero and can_be_one are scratch space for the kernel, as for evaluate_words
+void module_definition::evaluate_dual_rail(const std::uint64_t* inputs_can_be_zero,
+    const std::uint64_t* inputs_can_be_one, std::uint64_t* outputs_can_be_zero, std::uint64_t* outputs_can_be_one,
+    std::vector<std::uint64_t>& can_be_zero, std::vector<std::uint64_t>& can_be_one) const
+{
+    can_be_zero.assign(kernel->get_size(), 0);
+    can_be_one.assign(kernel->get_size(), 0);
+    for (int i{}; i < get_number_of_inputs(); i++) {
+        can_be_zero[input_indices[i]] = inputs_can_be_zero[i];
+        can_be_one[input_indices[i]] = inputs_can_be_one[i];
+    }
+    kernel->evaluate_dual_rail(can_be_zero, can_be_one);
+    for (int k{}; k < get_number_of_outputs(); k++) {
+        outputs_can_be_zero[k] = can_be_zero[output_indices[k]];
+        outputs_can_be_one[k] = can_be_one[output_indices[k]];
+    }
+}
+
+
+module_library::module_library() : library_lock{}, modules{}, is_empty{ true } {}
+
+
+// the default library is made on first use and never destroyed, so circuits destroyed after main returns
+// can still find the modules their instances use
+module_library& get_default_module_library()
+{
+    static module_library* library{ new module_library() };
+    return *library;
+}
+
+
+// module names are used as gate types, so must be single words that are not already gate types
+static bool is_valid_module_name(const std::string& name)
+{
+    if (name.empty() || !std::isalpha(static_cast<unsigned char>(name[0]))) {
+        return false;
+    }
+    for (const char& character : name) {
+        if (!std::isalnum(static_cast<unsigned char>(character)) && character != '_') {
+            return false;
+        }
+    }
+    return !is_builtin_gate_type(name);
+}
+
+
+// adds a module to the library, made from body: its inputs (in position order) are the module's inputs,
+// and the elements at output_positions its outputs, in order. the module is then a gate type,
+// so elements of circuits using the library can be instances of it.
+// defining a module again with the same body does nothing, so netlists defining it can be read again;
+// a module of the same name that is already in scope (see module_library_scope) counts as defined.
+// returns false, writing why to error_output, if the module cannot be defined
+bool module_library::define_module(const std::string& name, std::unique_ptr<circuit> body,
+    const std::vector<int>& output_positions, std::ostream& error_output)
+{
+    if (!is_valid_module_name(name)) {
+        error_output << "\nError: '" << name << "' cannot be used as a module name\n";
+        return false;
+    }
+    int number_of_inputs{ static_cast<int>(body->get_input_positions().size()) };
+    int number_of_outputs{ static_cast<int>(output_positions.size()) };
+    if (number_of_inputs < 1 || number_of_inputs > maximum_module_ports
+            || number_of_outputs < 1 || number_of_outputs > maximum_module_ports) {
+        error_output << "\nError: module '" << name << "' has " << number_of_inputs << " inputs and "
+            << number_of_outputs << " outputs, but modules need 1 to " << maximum_module_ports << " of each\n";
+        return false;
+    }
+    for (const int& output : output_positions) {
+        if (output < 0 || output >= body->get_circuit_size()) {
+            error_output << "\nError: an output of module '" << name << "' is not in its body\n";
+            return false;
+        }
+    }
+
+    std::shared_ptr<const module_definition> definition{
+        std::make_shared<module_definition>(name, std::move(body), output_positions) };
+
+    std::shared_ptr<const module_definition> existing_module{ ::find_module(name) };
+    std::lock_guard<std::mutex> lock(library_lock);
+    if (!existing_module) {
+        auto library_module = modules.find(name);
+        if (library_module != modules.end()) {
+            existing_module = library_module->second;
+        }
+    }
+    if (existing_module) {
+        if (existing_module->get_structure_hash() != definition->get_structure_hash()) {
+            error_output << "\nError: a different module named '" << name << "' is already defined\n";
+            return false;
+        }
+        return true;
+    }
+    modules[name] = definition;
+    is_empty.store(false);
+    return true;
+}
+
+
+// adds every module of another library, such as the modules of a netlist once the netlist is accepted
+// modules with a name this library already has are left out
+void module_library::add_modules(const module_library& new_modules)
+{
+    std::lock(library_lock, new_modules.library_lock);
+    std::lock_guard<std::mutex> lock(library_lock, std::adopt_lock);
+    std::lock_guard<std::mutex> new_modules_lock(new_modules.library_lock, std::adopt_lock);
+    for (const auto& module : new_modules.modules) {
+        modules.insert(module);
+    }
+    if (!modules.empty()) {
+        is_empty.store(false);
+    }
+}
+
+
+// the module with the given name, or null if the library has none
+// gate types are looked up often, so no lock is taken while the library is empty
+std::shared_ptr<const module_definition> module_library::find_module(const std::string& name) const
+{
+    if (is_empty.load()) {
+        return nullptr;
+    }
+    std::lock_guard<std::mutex> lock(library_lock);
+    auto module = modules.find(name);
+    return module != modules.end() ? module->second : nullptr;
+}
+
+
+std::vector<std::string> module_library::get_module_names() const
+{
+    std::lock_guard<std::mutex> lock(library_lock);
+    std::vector<std::string> names;
+    for (const auto& module : modules) {
+        names.push_back(module.first);
+    }
+    std::sort(names.begin(), names.end());
+    return names;
+}
+
+
+
+// the innermost scope of each thread
+static thread_local const module_library_scope* innermost_scope{ nullptr };
+
+module_library_scope::module_library_scope(const module_library& set_library) :
+    library{ set_library }, enclosing_scope{ innermost_scope }
+{
+    innermost_scope = this;
+}
+
+module_library_scope::~module_library_scope()
+{
+    innermost_scope = enclosing_scope;
+}
+
+
+std::shared_ptr<const module_definition> find_module(const std::string& name)
+{
+    if (innermost_scope == nullptr) {
+        return get_default_module_library().find_module(name);
+    }
+    for (const module_library_scope* scope{ innermost_scope }; scope != nullptr; scope = scope->enclosing_scope) {
+        std::shared_ptr<const module_definition> module{ scope->library.find_module(name) };
+        if (module) {
+            return module;
+        }
+    }
+    return nullptr;
+}
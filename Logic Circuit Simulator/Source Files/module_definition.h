@@ -0,0 +1,120 @@
+// module_definition.h (last modified: 18/10/26)
+// header file for the module_definition and module_library class definitions and class member declarations
+// a module is a circuit used as a gate type: its body is stored once, with one compiled evaluation
+// plan (its kernel), however many module instances use it. an instance only keeps its own inputs and
+// output word, so memory grows with the number of different modules rather than of instances.
+// instances are flattened into copies of their body's gates only when an analysis needs primitive gates
+
+#ifndef MODULE_DEFINITION_H
+#define MODULE_DEFINITION_H
+
+#include <vector>
+#include <string>
+#include <memory>
+#include <atomic>
+#include <mutex>
+#include <unordered_map>
+#include <ostream>
+#include <cstdint>
+#include <cstddef>
+#include "circuit.h"
+#include "evaluation_plan.h"
+
+
+// largest number of inputs or outputs of a module, so each fits in a 64-bit word
+const int maximum_module_ports{ 64 };
+
+
+class module_definition
+{
+private:
+    std::string name;
+    std::unique_ptr<circuit> body;
+    std::vector<int> output_positions;  // body positions of the module's outputs, in output order
+    std::uint64_t structure_hash;
+
+    // the body's evaluation plan, and where each module input and output is in it
+    const evaluation_plan* kernel;
+    std::vector<int> input_indices;
+    std::vector<int> output_indices;
+
+    // values used by evaluate, unless another thread is already using them
+    mutable std::vector<unsigned char> scratch_values;
+    mutable std::atomic<bool> is_scratch_in_use;
+
+public:
+    module_definition(const std::string& set_name, std::unique_ptr<circuit> set_body,
+        const std::vector<int>& set_output_positions);
+    ~module_definition() {};
+
+    module_definition(const module_definition&) = delete;
+    module_definition& operator=(const module_definition&) = delete;
+
+    const std::string& get_name() const;
+    const circuit& get_body() const;
+    const std::vector<int>& get_output_positions() const;
+    int get_number_of_inputs() const;
+    int get_number_of_outputs() const;
+    std::uint64_t get_structure_hash() const;
+    std::size_t get_memory_used() const;
+
+    std::uint64_t evaluate(const std::uint64_t& input_word) const;
+    void evaluate_words(const std::uint64_t* input_words, std::uint64_t* output_words,
+        std::vector<std::uint64_t>& values) const;
+    void evaluate_dual_rail(const std::uint64_t* inputs_can_be_zero, const std::uint64_t* inputs_can_be_one,
+        std::uint64_t* outputs_can_be_zero, std::uint64_t* outputs_can_be_one,
+        std::vector<std::uint64_t>& can_be_zero, std::vector<std::uint64_t>& can_be_one) const;
+};
+
+
+// a set of modules, by name. modules cannot be changed once defined.
+// each circuit uses a library: the default one, shared by the circuits of the program,
+// unless it is given its own (as the simulation server does, so its clients' modules stay apart)
+class module_library
+{
+private:
+    mutable std::mutex library_lock;
+    std::unordered_map<std::string, std::shared_ptr<const module_definition>> modules;
+    std::atomic<bool> is_empty;
+
+public:
+    module_library();
+    ~module_library() {};
+
+    module_library(const module_library&) = delete;
+    module_library& operator=(const module_library&) = delete;
+
+    bool define_module(const std::string& name, std::unique_ptr<circuit> body, const std::vector<int>& output_positions,
+        std::ostream& error_output);
+    void add_modules(const module_library&);
+    std::shared_ptr<const module_definition> find_module(const std::string& name) const;
+    std::vector<std::string> get_module_names() const;
+};
+
+
+// makes a library's modules usable as gate types by the current thread, for as long as the scope lasts.
+// scopes nest, and a module is looked up in the innermost scope first, then the ones around it;
+// the default library is only used while the thread has no scope
+class module_library_scope
+{
+private:
+    const module_library& library;
+    const module_library_scope* enclosing_scope;
+
+public:
+    explicit module_library_scope(const module_library& set_library);
+    ~module_library_scope();
+
+    module_library_scope(const module_library_scope&) = delete;
+    module_library_scope& operator=(const module_library_scope&) = delete;
+
+    friend std::shared_ptr<const module_definition> find_module(const std::string& name);
+};
+
+
+module_library& get_default_module_library();
+
+// the module with the given name in the current thread's libraries, or null if there is none
+std::shared_ptr<const module_definition> find_module(const std::string& name);
+
+#endif
@@ -0,0 +1,288 @@
+// netlist_reader.cpp (last modified: 18/10/26)
+// Contains definition of the netlist file reader declared in netlist_reader.h
+
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <istream>
+#include <ostream>
+#include <vector>
+#include <string>
+#include <memory>
+#include <cstdint>
+#include "netlist_reader.h"
+#include "circuit.h"
+#include "module_definition.h"
+#include "symbol_table.h"
+#include "universal_functions.h"
+#include "tracing.h"
+
+
+// one element read from a netlist file, with its inputs still given by name
+struct netlist_line
+{
+    int line_number;
+    std::string name;
+    std::string gate_type;
+    std::vector<std::string> input_names;
+    bool input_value;
+};
+
+
+static bool report_netlist_error(std::ostream& error_output, const std::string& source_name,
+    const int& line_number, const std::string& message)
+{
+    error_output << "\nError: " << source_name << " line " << line_number << ": " << message << "\n";
+    return false;
+}
+
+
+static bool read_netlist_lines(std::istream& netlist_text, const std::string& source_name, circuit& target,
+    module_library& new_modules, std::ostream& error_output);
+
+
+// reads a module block whose 'module' line has just been read, up to its 'endmodule' line,
+// and adds the module to new_modules. the module's inputs are added to its body first, then
+// the lines between are read as a netlist of their own; they are read after blank lines
+// standing in for the lines before them, so errors give the line numbers of the file
+static bool read_module(std::istream& netlist_text, std::istringstream& header_words, int& line_number,
+    const std::string& source_name, module_library& new_modules, std::ostream& error_output)
+{
+    int module_line_number{ line_number };
+    std::string module_name;
+    std::vector<std::string> input_names;
+    std::vector<std::string> output_names;
+    std::string word;
+    bool is_arrow_read{ false };
+    header_words >> module_name;
+    while (header_words >> word) {
+        if (word == "->" && !is_arrow_read) {
+            is_arrow_read = true;
+        }
+        else {
+            (is_arrow_read ? output_names : input_names).push_back(word);
+        }
+    }
+    if (module_name.empty() || !is_arrow_read || input_names.empty() || output_names.empty()) {
+        return report_netlist_error(error_output, source_name, line_number,
+            "expected 'module <name> <input names> -> <output names>'");
+    }
+
+    std::string body_text(module_line_number, '\n');
+    std::string text;
+    bool is_end_read{ false };
+    while (!is_end_read && std::getline(netlist_text, text)) {
+        line_number++;
+        std::istringstream words(text.substr(0, text.find('#')));
+        std::string first_word;
+        words >> first_word;
+        if (first_word == "endmodule") {
+            is_end_read = true;
+        }
+        else if (first_word == "module") {
+            return report_netlist_error(error_output, source_name, line_number, "modules cannot be defined inside modules");
+        }
+        else if (first_word == "input") {
+            return report_netlist_error(error_output, source_name, line_number,
+                "the inputs of a module are listed on its 'module' line");
+        }
+        body_text += (is_end_read ? "" : text) + "\n";
+    }
+    if (!is_end_read) {
+        return report_netlist_error(error_output, source_name, module_line_number,
+            "module '" + module_name + "' has no 'endmodule' line");
+    }
+
+    std::unique_ptr<circuit> body{ new circuit() };
+    for (size_t i{}; i < input_names.size(); i++) {
+        if (!body->set_element_name(static_cast<int>(i), input_names[i])) {
+            return report_netlist_error(error_output, source_name, module_line_number,
+                "'" + input_names[i] + "' is an input of module '" + module_name + "' more than once");
+        }
+        body->add_element(false);
+    }
+    std::istringstream body_lines(body_text);
+    if (!read_netlist_lines(body_lines, source_name, *body, new_modules, error_output)) {
+        return false;
+    }
+
+    std::vector<int> output_positions;
+    for (const std::string& output_name : output_names) {
+        output_positions.push_back(body->find_element(output_name));
+        if (output_positions.back() == -1) {
+            return report_netlist_error(error_output, source_name, module_line_number,
+                "output '" + output_name + "' of module '" + module_name + "' is not defined");
+        }
+    }
+    return new_modules.define_module(module_name, std::move(body), output_positions, error_output);
+}
+
+
+// adds the elements of a netlist file to target, after any elements it already has
+// names are looked up in a symbol_table, so reading takes linear time however many signals there are.
+// the file is checked completely before anything is added:
+// returns false, leaving target unchanged, if it cannot be read or does not describe a valid circuit
+bool read_netlist(const std::string& file_name, circuit& target)
+{
+    std::ifstream netlist_file(file_name);
+    if (!netlist_file) {
+        std::cerr << "\nError: could not open '" << file_name << "'\n";
+        return false;
+    }
+    return read_netlist(netlist_file, file_name, target, std::cerr);
+}
+
+
+// reads netlist text from any stream, such as a netlist sent to the simulation server
+// errors in the text are written to error_output, naming the text as source_name.
+// the netlist's modules are kept apart until the whole netlist is accepted, then added to target's library
+bool read_netlist(std::istream& netlist_text, const std::string& source_name, circuit& target,
+    std::ostream& error_output)
+{
+    TRACE_SCOPE("read_netlist");
+    module_library_scope target_modules_scope(target.get_module_library());
+    module_library new_modules;
+    module_library_scope new_modules_scope(new_modules);
+
+    if (!read_netlist_lines(netlist_text, source_name, target, new_modules, error_output)) {
+        return false;
+    }
+    target.get_module_library().add_modules(new_modules);
+    return true;
+}
+
+
+// reads the lines of a netlist, or of a module's body, into target
+// modules defined by the lines are added to new_modules, which must be in scope
+static bool read_netlist_lines(std::istream& netlist_text, const std::string& source_name, circuit& target,
+    module_library& new_modules, std::ostream& error_output)
+{
+    auto report_error = [&source_name, &error_output](const int& line_number, const std::string& message) {
+        return report_netlist_error(error_output, source_name, line_number, message);
+    };
+
+    // first pass: reads every line and gives each new name the next position (name ids are given
+    // out in order, so the position of a name is first_position + its id).
+    // this lets an element use inputs that are defined further down the file
+    int first_position{ target.get_circuit_size() };
+    symbol_table new_names;
+    std::vector<netlist_line> lines;
+
+    auto add_new_name = [&](const std::string& name, const int& line_number) {
+        if (target.find_element(name) != -1 || new_names.find_name(name) != -1) {
+            return report_error(line_number, "'" + name + "' is defined more than once");
+        }
+        new_names.add_name(name);
+        return true;
+    };
+
+    std::string text;
+    int line_number{};
+    while (std::getline(netlist_text, text)) {
+        line_number++;
+        size_t comment_start{ text.find('#') };
+        if (comment_start != std::string::npos) {
+            text.erase(comment_start);
+        }
+
+        std::istringstream words(text);
+        std::string first_word;
+        if (!(words >> first_word)) {
+            continue;
+        }
+        netlist_line line{ line_number, "", "", {}, false };
+
+        // modules are added to new_modules as soon as they are read, so later lines can use them
+        if (first_word == "module") {
+            if (!read_module(netlist_text, words, line_number, source_name, new_modules, error_output)) {
+                return false;
+            }
+            continue;
+        }
+        if (first_word == "endmodule") {
+            return report_error(line_number, "'endmodule' without a 'module' line");
+        }
+
+        if (first_word == "input") {
+            std::string value;
+            std::string extra_word;
+            if (!(words >> line.name >> value) || (value != "0" && value != "1") || (words >> extra_word)) {
+                return report_error(line_number, "expected 'input <name> <0 or 1>'");
+            }
+            line.gate_type = "Input";
+            line.input_value = value == "1";
+        }
+        else {
+            std::string equals_sign;
+            line.name = first_word;
+            if (!(words >> equals_sign >> line.gate_type) || equals_sign != "=") {
+                return report_error(line_number, "expected '<name> = <gate type> <input names>'");
+            }
+            if (!is_gate_type(line.gate_type)) {
+                return report_error(line_number, "'" + line.gate_type + "' is not a gate type");
+            }
+
+            std::string input_name;
+            while (words >> input_name) {
+                line.input_names.push_back(input_name);
+            }
+            int expected_inputs{ get_number_of_gate_inputs(line.gate_type) };
+            if (static_cast<int>(line.input_names.size()) != expected_inputs) {
+                return report_error(line_number, "a " + line.gate_type + " gate needs "
+                    + std::to_string(expected_inputs) + " inputs");
+            }
+        }
+
+        // '[' is kept for the names of bus cell and module instance outputs
+        if (line.name.find('[') != std::string::npos) {
+            return report_error(line_number, "'" + line.name + "' cannot be used as a name");
+        }
+        if (!add_new_name(line.name, line_number)) {
+            return false;
+        }
+        if (is_multi_output_type(line.gate_type)) {
+            for (int bit{}; bit < get_number_of_gate_outputs(line.gate_type); bit++) {
+                if (!add_new_name(line.name + "[" + std::to_string(bit) + "]", line_number)) {
+                    return false;
+                }
+            }
+        }
+        lines.push_back(line);
+    }
+
+    // second pass: every name is known now, so inputs can be turned into positions
+    std::vector<std::vector<int>> line_inputs(lines.size());
+    for (size_t i{}; i < lines.size(); i++) {
+        for (const std::string& input_name : lines[i].input_names) {
+            int name_id{ new_names.find_name(input_name) };
+            int input_position{ name_id != -1 ? first_position + name_id : target.find_element(input_name) };
+
+            if (input_position == -1) {
+                return report_error(lines[i].line_number, "'" + input_name + "' is not defined");
+            }
+            line_inputs[i].push_back(input_position);
+        }
+    }
+
+    target.begin_netlist();
+    for (size_t i{}; i < lines.size(); i++) {
+        const netlist_line& line{ lines[i] };
+        int position{ first_position + new_names.find_name(line.name) };
+
+        if (line.gate_type == "Input") {
+            target.add_netlist_element(position, line.input_value);
+            continue;
+        }
+        target.add_netlist_element(position, line.gate_type, line_inputs[i]);
+
+        if (is_multi_output_type(line.gate_type)) {
+            for (int bit{}; bit < get_number_of_gate_outputs(line.gate_type); bit++) {
+                target.add_netlist_element(position + 1 + bit, "BIT" + std::to_string(bit), { position });
+            }
+        }
+    }
+    for (int name_id{}; name_id < new_names.get_size(); name_id++) {
+        target.set_element_name(first_position + name_id, new_names.get_name(name_id));
+    }
+    return target.finish_netlist(error_output);
+}
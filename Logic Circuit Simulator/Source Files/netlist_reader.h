@@ -0,0 +1,28 @@
+// netlist_reader.h (last modified: 18/10/26)
+// header file for declaration of the functions that read a circuit from a netlist file or other text stream
+// a netlist file has one element per line, named however the file likes:
+//     input <name> <0 or 1>
+//     <name> = <gate type> <input names...>
+// gate types are those of the gate library (NOT, AND, OR8, LUT3:e8, ADD4 ...). elements can be
+// listed in any order, and '#' starts a comment. bus cell outputs are named <name>[0], <name>[1] ...
+// a module block defines a module (see module_definition.h), which lines after it can use as a gate type:
+//     module <name> <input names...> -> <output names...>
+//     <elements of the module, using its inputs>
+//     endmodule
+// the outputs of a module instance are named like those of a bus cell, in the order they are listed.
+// modules join the library of the circuit read into only once the whole netlist has been accepted
+
+#ifndef NETLIST_READER_H
+#define NETLIST_READER_H
+
+#include <string>
+#include <istream>
+#include <ostream>
+#include "circuit.h"
+
+
+bool read_netlist(const std::string& file_name, circuit& target);
+bool read_netlist(std::istream& netlist_text, const std::string& source_name, circuit& target,
+    std::ostream& error_output);
+
+#endif
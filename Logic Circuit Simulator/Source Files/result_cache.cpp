@@ -0,0 +1,154 @@
+// result_cache.cpp (last modified: 18/10/26)
+// Contains definition of all result_cache class members not defined in result_cache.h
+
+#include <vector>
+#include <string>
+#include <list>
+#include <unordered_map>
+#include <cstdint>
+#include <cstddef>
+#include <utility>
+#include "result_cache.h"
+
+
+// memory used by a cache with no set limit
+const std::size_t default_cache_memory_limit{ 64 * 1024 * 1024 };
+
+// approximate bookkeeping memory of one entry (list node, index node and the entry itself)
+const std::size_t cache_entry_overhead{ 96 };
+
+
+// mixing step from the 64-bit finalizer of MurmurHash3, so similar inputs give unrelated hashes
+std::uint64_t combine_hash(const std::uint64_t& seed, const std::uint64_t& value)
+{
+    std::uint64_t hash{ seed ^ (value + 0x9e3779b97f4a7c15ull + (seed << 6) + (seed >> 2)) };
+    hash ^= hash >> 33;
+    hash *= 0xff51afd7ed558ccdull;
+    hash ^= hash >> 33;
+    hash *= 0xc4ceb9fe1a85ec53ull;
+    hash ^= hash >> 33;
+    return hash;
+}
+
+
+result_cache::result_cache() :
+    entries{}, entry_index{}, memory_limit{ default_cache_memory_limit }, memory_used{ 0 },
+    number_of_hits{ 0 }, number_of_misses{ 0 } {}
+
+
+// looks up key, moving a found entry to the front of the least-recently-used order
+result_cache::cache_entry* result_cache::find_entry(const std::uint64_t& key)
+{
+    auto found = entry_index.find(key);
+    if (found == entry_index.end()) {
+        number_of_misses++;
+        return nullptr;
+    }
+
+    number_of_hits++;
+    entries.splice(entries.begin(), entries, found->second);
+    return &entries.front();
+}
+
+// adds entry as the most recently used, then evicts from the back until it fits the memory limit
+// an entry bigger than the whole limit is not stored
+void result_cache::store_entry(cache_entry entry)
+{
+    auto found = entry_index.find(entry.key);
+    if (found != entry_index.end()) {
+        memory_used -= found->second->size;
+        entries.erase(found->second);
+        entry_index.erase(found);
+    }
+
+    if (entry.size > memory_limit) {
+        return;
+    }
+
+    memory_used += entry.size;
+    entries.push_front(std::move(entry));
+    entry_index[entries.front().key] = entries.begin();
+
+    while (memory_used > memory_limit) {
+        memory_used -= entries.back().size;
+        entry_index.erase(entries.back().key);
+        entries.pop_back();
+    }
+}
+
+
+bool result_cache::find_formula(const std::uint64_t& key, std::string& formula)
+{
+    cache_entry* entry{ find_entry(key) };
+    if (entry == nullptr) {
+        return false;
+    }
+    formula = entry->formula;
+    return true;
+}
+
+bool result_cache::find_truth_table(const std::uint64_t& key, std::vector<bool>& truth_table)
+{
+    cache_entry* entry{ find_entry(key) };
+    if (entry == nullptr) {
+        return false;
+    }
+    truth_table = entry->truth_table;
+    return true;
+}
+
+void result_cache::store_formula(const std::uint64_t& key, const std::string& formula)
+{
+    store_entry(cache_entry{ key, formula, {}, formula.capacity() + cache_entry_overhead });
+}
+
+void result_cache::store_truth_table(const std::uint64_t& key, const std::vector<bool>& truth_table)
+{
+    store_entry(cache_entry{ key, "", truth_table, truth_table.size() / 8 + cache_entry_overhead });
+}
+
+
+// a smaller limit takes effect immediately, evicting the least recently used entries
+void result_cache::set_memory_limit(const std::size_t& bytes)
+{
+    memory_limit = bytes;
+
+    while (memory_used > memory_limit) {
+        memory_used -= entries.back().size;
+        entry_index.erase(entries.back().key);
+        entries.pop_back();
+    }
+}
+
+std::size_t result_cache::get_memory_limit() const
+{
+    return memory_limit;
+}
+
+std::size_t result_cache::get_memory_used() const
+{
+    return memory_used;
+}
+
+std::uint64_t result_cache::get_number_of_hits() const
+{
+    return number_of_hits;
+}
+
+std::uint64_t result_cache::get_number_of_misses() const
+{
+    return number_of_misses;
+}
+
+void result_cache::reset_counts()
+{
+    number_of_hits = 0;
+    number_of_misses = 0;
+}
+
+void result_cache::clear()
+{
+    entries.clear();
+    entry_index.clear();
+    memory_used = 0;
+}
@@ -0,0 +1,60 @@
+// result_cache.h (last modified: 18/10/26)
+// header file for the result_cache class definition and class member declarations
+// a result_cache keeps recently computed formulae and truth table columns, keyed by a structural hash,
+// and evicts the least recently used results once its memory limit is reached
+
+#ifndef RESULT_CACHE_H
+#define RESULT_CACHE_H
+
+#include <vector>
+#include <string>
+#include <list>
+#include <unordered_map>
+#include <cstdint>
+#include <cstddef>
+
+
+// mixes value into seed, used to build structural hashes from the hashes of their parts
+std::uint64_t combine_hash(const std::uint64_t& seed, const std::uint64_t& value);
+
+
+class result_cache
+{
+private:
+    struct cache_entry
+    {
+        std::uint64_t key;
+        std::string formula;
+        std::vector<bool> truth_table;
+        std::size_t size;
+    };
+
+    std::list<cache_entry> entries;     // most recently used first
+    std::unordered_map<std::uint64_t, std::list<cache_entry>::iterator> entry_index;
+    std::size_t memory_limit;
+    std::size_t memory_used;
+    std::uint64_t number_of_hits;
+    std::uint64_t number_of_misses;
+
+    cache_entry* find_entry(const std::uint64_t& key);
+    void store_entry(cache_entry entry);
+
+public:
+    result_cache();
+    ~result_cache() {};
+
+    bool find_formula(const std::uint64_t& key, std::string& formula);
+    bool find_truth_table(const std::uint64_t& key, std::vector<bool>& truth_table);
+    void store_formula(const std::uint64_t& key, const std::string& formula);
+    void store_truth_table(const std::uint64_t& key, const std::vector<bool>& truth_table);
+
+    void set_memory_limit(const std::size_t& bytes);
+    std::size_t get_memory_limit() const;
+    std::size_t get_memory_used() const;
+    std::uint64_t get_number_of_hits() const;
+    std::uint64_t get_number_of_misses() const;
+    void reset_counts();
+    void clear();
+};
+
+#endif
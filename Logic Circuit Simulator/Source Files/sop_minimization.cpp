@@ -0,0 +1,642 @@
+// sop_minimization.cpp (last modified: 18/10/26)
+// Contains definition of the two-level minimization functions declared in sop_minimization.h
+// a product term's minterms lie in the words whose index matches its literals on inputs 6 and up,
+// and within each such word are the bits matching its literals on inputs 0 to 5 (its low word),
+// so checking a product against a truth table only visits the words it covers
+
+#include <iostream>
+#include <sstream>
+#include <vector>
+#include <string>
+#include <unordered_set>
+#include <algorithm>
+#include <bitset>
+#include <utility>
+#include <limits>
+#include <cstdint>
+#include "sop_minimization.h"
+
+
+// minterms with input i set, within one word, for inputs 0 to 5
+static const std::uint64_t input_words[]{
+    0xaaaaaaaaaaaaaaaa, 0xcccccccccccccccc, 0xf0f0f0f0f0f0f0f0,
+    0xff00ff00ff00ff00, 0xffff0000ffff0000, 0xffffffff00000000 };
+
+// Espresso passes stop once a pass does not improve the cover, or after this many.
+// each pass compares every pair of products, so larger covers are left as they come from Minato-Morreale
+const int maximum_espresso_passes{ 8 };
+const std::size_t maximum_espresso_cover{ 2048 };
+
+// the exact cover search stops after visiting this many nodes, keeping the cheapest cover found by then
+// (at worst the heuristic one it starts from), so dense functions cannot hold up the caller for seconds
+const long long maximum_cover_search_nodes{ 20000 };
+
+
+static int count_bits(const std::uint32_t& mask)
+{
+    return static_cast<int>(std::bitset<32>(mask).count());
+}
+
+// fewer products first, then fewer literals
+static std::pair<int, int> get_cover_cost(const std::vector<product_term>& cover)
+{
+    return std::pair<int, int>{ static_cast<int>(cover.size()), get_number_of_literals(cover) };
+}
+
+static product_term add_literal(const product_term& term, const int& input, const bool& value)
+{
+    std::uint32_t bit{ std::uint32_t{ 1 } << input };
+    return product_term{ term.literal_mask | bit, value ? term.value_mask | bit : term.value_mask };
+}
+
+static product_term remove_literal(const product_term& term, const int& input)
+{
+    std::uint32_t bit{ std::uint32_t{ 1 } << input };
+    return product_term{ term.literal_mask & ~bit, term.value_mask & ~bit };
+}
+
+// true if every minterm of contained is a minterm of term
+static bool does_contain(const product_term& term, const product_term& contained)
+{
+    return (term.literal_mask & ~contained.literal_mask) == 0
+        && ((term.value_mask ^ contained.value_mask) & term.literal_mask) == 0;
+}
+
+static bool do_intersect(const product_term& a, const product_term& b)
+{
+    return ((a.value_mask ^ b.value_mask) & a.literal_mask & b.literal_mask) == 0;
+}
+
+
+static std::uint64_t get_low_word(const product_term& term)
+{
+    std::uint64_t low_word{ ~std::uint64_t{ 0 } };
+    for (int input{}; input < 6; input++) {
+        if ((term.literal_mask >> input) & 1) {
+            low_word &= ((term.value_mask >> input) & 1) ? input_words[input] : ~input_words[input];
+        }
+    }
+    return low_word;
+}
+
+// the term's bits in word number word of a truth table
+static std::uint64_t get_term_word(const product_term& term, const std::uint64_t& low_word, const std::uint32_t& word)
+{
+    std::uint32_t high_literals{ term.literal_mask >> 6 };
+    return ((word ^ (term.value_mask >> 6)) & high_literals) == 0 ? low_word : 0;
+}
+
+// calls visit with the number of each truth table word the term has minterms in, until visit returns false
+// returns false if visit did
+template <class visitor> static bool visit_term_words(const product_term& term, const int& number_of_inputs, visitor visit)
+{
+    if (number_of_inputs <= 6) {
+        return visit(std::uint32_t{ 0 });
+    }
+    std::uint32_t high_inputs{ (std::uint32_t{ 1 } << (number_of_inputs - 6)) - 1 };
+    std::uint32_t free_inputs{ high_inputs & ~(term.literal_mask >> 6) };
+    std::uint32_t fixed_values{ (term.value_mask & term.literal_mask) >> 6 };
+    std::uint32_t subset{};
+    do {
+        if (!visit(fixed_values | subset)) {
+            return false;
+        }
+        subset = (subset - free_inputs) & free_inputs;
+    } while (subset != 0);
+    return true;
+}
+
+static bool is_implicant(const product_term& term, const std::vector<std::uint64_t>& truth_table, const int& number_of_inputs)
+{
+    std::uint64_t low_word{ get_low_word(term) };
+    return visit_term_words(term, number_of_inputs, [&](const std::uint32_t& word) {
+        return (low_word & ~truth_table[word]) == 0;
+    });
+}
+
+
+// cofactors of a function of inputs 0 to 5 held in one word, with the input set to 0 or 1
+static std::uint64_t get_word_cofactor(const std::uint64_t& function_word, const int& input, const bool& value)
+{
+    int shift{ 1 << input };
+    if (value) {
+        std::uint64_t half{ function_word & input_words[input] };
+        return half | (half >> shift);
+    }
+    std::uint64_t half{ function_word & ~input_words[input] };
+    return half | (half << shift);
+}
+
+static void add_literal_to_terms(std::vector<product_term>& cover, const std::size_t& first_term,
+    const int& input, const bool& value)
+{
+    for (std::size_t i{ first_term }; i < cover.size(); i++) {
+        cover[i] = add_literal(cover[i], input, value);
+    }
+}
+
+// Minato-Morreale irredundant sum of products of a function between lower and upper (lower implies upper),
+// for functions of inputs below number_of_inputs held in one word. adds its products to cover and
+// returns the function they cover
+static std::uint64_t get_word_isop(const std::uint64_t& lower, const std::uint64_t& upper, const int& number_of_inputs,
+    std::vector<product_term>& cover)
+{
+    if (lower == 0) {
+        return 0;
+    }
+    if (upper == ~std::uint64_t{ 0 }) {
+        cover.push_back(product_term{ 0, 0 });
+        return upper;
+    }
+
+    int input{ number_of_inputs - 1 };
+    while (get_word_cofactor(lower, input, false) == get_word_cofactor(lower, input, true)
+            && get_word_cofactor(upper, input, false) == get_word_cofactor(upper, input, true)) {
+        input--;
+    }
+    std::uint64_t lower_0{ get_word_cofactor(lower, input, false) };
+    std::uint64_t lower_1{ get_word_cofactor(lower, input, true) };
+    std::uint64_t upper_0{ get_word_cofactor(upper, input, false) };
+    std::uint64_t upper_1{ get_word_cofactor(upper, input, true) };
+
+    std::size_t first_term{ cover.size() };
+    std::uint64_t covered_0{ get_word_isop(lower_0 & ~upper_1, upper_0, input, cover) };
+    add_literal_to_terms(cover, first_term, input, false);
+    first_term = cover.size();
+    std::uint64_t covered_1{ get_word_isop(lower_1 & ~upper_0, upper_1, input, cover) };
+    add_literal_to_terms(cover, first_term, input, true);
+    std::uint64_t covered_both{ get_word_isop((lower_0 & ~covered_0) | (lower_1 & ~covered_1), upper_0 & upper_1, input, cover) };
+
+    return (covered_0 & ~input_words[input]) | (covered_1 & input_words[input]) | covered_both;
+}
+
+// as above, for functions of 7 or more inputs held in 2^(number_of_inputs - 6) words;
+// the two cofactors of the highest input are the two halves of the words
+static void get_isop(const std::uint64_t* lower, const std::uint64_t* upper, const int& number_of_inputs,
+    std::vector<product_term>& cover, std::uint64_t* covered)
+{
+    if (number_of_inputs <= 6) {
+        covered[0] = get_word_isop(lower[0], upper[0], number_of_inputs, cover);
+        return;
+    }
+    std::size_t size{ std::size_t{ 1 } << (number_of_inputs - 6) };
+    std::size_t half{ size / 2 };
+    if (std::all_of(lower, lower + size, [](const std::uint64_t& word) { return word == 0; })) {
+        std::fill(covered, covered + size, 0);
+        return;
+    }
+    if (std::all_of(upper, upper + size, [](const std::uint64_t& word) { return word == ~std::uint64_t{ 0 }; })) {
+        cover.push_back(product_term{ 0, 0 });
+        std::fill(covered, covered + size, ~std::uint64_t{ 0 });
+        return;
+    }
+
+    int input{ number_of_inputs - 1 };
+    if (std::equal(lower, lower + half, lower + half) && std::equal(upper, upper + half, upper + half)) {
+        get_isop(lower, upper, input, cover, covered);
+        std::copy(covered, covered + half, covered + half);
+        return;
+    }
+
+    std::vector<std::uint64_t> next_lower(half);
+    std::vector<std::uint64_t> covered_0(half);
+    std::vector<std::uint64_t> covered_1(half);
+    std::vector<std::uint64_t> covered_both(half);
+
+    std::size_t first_term{ cover.size() };
+    for (std::size_t i{}; i < half; i++) {
+        next_lower[i] = lower[i] & ~upper[half + i];
+    }
+    get_isop(next_lower.data(), upper, input, cover, covered_0.data());
+    add_literal_to_terms(cover, first_term, input, false);
+
+    first_term = cover.size();
+    for (std::size_t i{}; i < half; i++) {
+        next_lower[i] = lower[half + i] & ~upper[i];
+    }
+    get_isop(next_lower.data(), upper + half, input, cover, covered_1.data());
+    add_literal_to_terms(cover, first_term, input, true);
+
+    std::vector<std::uint64_t> next_upper(half);
+    for (std::size_t i{}; i < half; i++) {
+        next_lower[i] = (lower[i] & ~covered_0[i]) | (lower[half + i] & ~covered_1[i]);
+        next_upper[i] = upper[i] & upper[half + i];
+    }
+    get_isop(next_lower.data(), next_upper.data(), input, cover, covered_both.data());
+
+    for (std::size_t i{}; i < half; i++) {
+        covered[i] = covered_0[i] | covered_both[i];
+        covered[half + i] = covered_1[i] | covered_both[i];
+    }
+}
+
+
+// the products of the cover other than term that share minterms with it, and their low words
+static void get_intersecting_terms(const std::vector<product_term>& cover, const std::size_t& term,
+    std::vector<std::size_t>& terms, std::vector<std::uint64_t>& low_words)
+{
+    for (std::size_t j{}; j < cover.size(); j++) {
+        if (j != term && do_intersect(cover[term], cover[j])) {
+            terms.push_back(j);
+            low_words.push_back(get_low_word(cover[j]));
+        }
+    }
+}
+
+// Espresso's irredundant step: drops each product whose minterms the other products all cover,
+// trying the smallest products (most literals) first
+static void make_irredundant(std::vector<product_term>& cover, const int& number_of_inputs)
+{
+    std::stable_sort(cover.begin(), cover.end(), [](const product_term& a, const product_term& b) {
+        return count_bits(a.literal_mask) > count_bits(b.literal_mask);
+    });
+    for (std::size_t i{}; i < cover.size();) {
+        std::uint64_t low_word{ get_low_word(cover[i]) };
+        std::vector<std::size_t> others_terms;
+        std::vector<std::uint64_t> others_low_words;
+        get_intersecting_terms(cover, i, others_terms, others_low_words);
+        bool is_redundant{ visit_term_words(cover[i], number_of_inputs, [&](const std::uint32_t& word) {
+            std::uint64_t others{};
+            for (std::size_t j{}; j < others_terms.size(); j++) {
+                others |= get_term_word(cover[others_terms[j]], others_low_words[j], word);
+            }
+            return (low_word & ~others) == 0;
+        }) };
+        if (is_redundant) {
+            cover.erase(cover.begin() + i);
+        }
+        else {
+            i++;
+        }
+    }
+}
+
+// Espresso's reduce step: shrinks each product in turn to the smallest product containing the minterms
+// no other product covers, so the expand step can grow it in another direction
+static void reduce_cover(std::vector<product_term>& cover, const int& number_of_inputs)
+{
+    int low_inputs{ std::min(number_of_inputs, 6) };
+    for (std::size_t i{}; i < cover.size();) {
+        std::uint64_t low_word{ get_low_word(cover[i]) };
+        std::vector<std::size_t> others_terms;
+        std::vector<std::uint64_t> others_low_words;
+        get_intersecting_terms(cover, i, others_terms, others_low_words);
+        std::uint32_t inputs_with_1{};
+        std::uint32_t inputs_with_0{};
+        visit_term_words(cover[i], number_of_inputs, [&](const std::uint32_t& word) {
+            std::uint64_t others{};
+            for (std::size_t j{}; j < others_terms.size(); j++) {
+                others |= get_term_word(cover[others_terms[j]], others_low_words[j], word);
+            }
+            std::uint64_t unique_minterms{ low_word & ~others };
+            if (unique_minterms != 0) {
+                for (int input{}; input < low_inputs; input++) {
+                    inputs_with_1 |= (unique_minterms & input_words[input]) != 0 ? std::uint32_t{ 1 } << input : 0;
+                    inputs_with_0 |= (unique_minterms & ~input_words[input]) != 0 ? std::uint32_t{ 1 } << input : 0;
+                }
+                inputs_with_1 |= word << 6;
+                inputs_with_0 |= ~word << 6;
+            }
+            return true;
+        });
+
+        std::uint32_t all_inputs{ number_of_inputs == 32 ? ~std::uint32_t{ 0 } : (std::uint32_t{ 1 } << number_of_inputs) - 1 };
+        if ((inputs_with_1 | inputs_with_0) == 0) {
+            cover.erase(cover.begin() + i);
+            continue;
+        }
+        std::uint32_t fixed_inputs{ (inputs_with_1 ^ inputs_with_0) & all_inputs };
+        cover[i] = product_term{ fixed_inputs, inputs_with_1 & fixed_inputs };
+        i++;
+    }
+}
+
+// Espresso's expand step: grows each product into a prime implicant by removing literals while it
+// stays inside the function, largest products first, and drops the products it then contains
+static void expand_cover(std::vector<product_term>& cover, const std::vector<std::uint64_t>& truth_table,
+    const int& number_of_inputs)
+{
+    std::stable_sort(cover.begin(), cover.end(), [](const product_term& a, const product_term& b) {
+        return count_bits(a.literal_mask) < count_bits(b.literal_mask);
+    });
+    for (std::size_t i{}; i < cover.size(); i++) {
+        for (int input{}; input < number_of_inputs; input++) {
+            if ((cover[i].literal_mask >> input) & 1) {
+                product_term expanded{ remove_literal(cover[i], input) };
+                if (is_implicant(expanded, truth_table, number_of_inputs)) {
+                    cover[i] = expanded;
+                }
+            }
+        }
+        for (std::size_t j{}; j < cover.size();) {
+            if (j != i && does_contain(cover[i], cover[j])) {
+                cover.erase(cover.begin() + j);
+                if (j < i) {
+                    i--;
+                }
+            }
+            else {
+                j++;
+            }
+        }
+    }
+}
+
+
+static void minimize_heuristically(const std::vector<std::uint64_t>& truth_table, const int& number_of_inputs,
+    std::vector<product_term>& cover)
+{
+    std::vector<std::uint64_t> covered(truth_table.size());
+    get_isop(truth_table.data(), truth_table.data(), number_of_inputs, cover, covered.data());
+
+    for (int pass{}; pass < maximum_espresso_passes && cover.size() <= maximum_espresso_cover; pass++) {
+        std::vector<product_term> improved_cover{ cover };
+        reduce_cover(improved_cover, number_of_inputs);
+        expand_cover(improved_cover, truth_table, number_of_inputs);
+        make_irredundant(improved_cover, number_of_inputs);
+        if (get_cover_cost(improved_cover) >= get_cover_cost(cover)) {
+            break;
+        }
+        cover = improved_cover;
+    }
+}
+
+
+// chooses a cheapest set of prime implicants covering every minterm, by branch and bound
+// within a budget of search nodes, after which the cheapest cover found so far is kept
+class prime_cover_search
+{
+private:
+    std::vector<product_term> primes;
+    std::vector<int> prime_literals;
+    std::vector<std::vector<std::uint64_t>> covered_minterms;   // by prime, bits over the minterm list
+    std::vector<std::vector<int>> covering_primes;              // by minterm
+    std::vector<int> chosen_primes;
+    std::vector<product_term> best_cover;
+    std::pair<int, int> best_cost;
+    long long visited_nodes;
+
+    int count_newly_covered(const std::vector<std::uint64_t>& uncovered, const int& prime) const
+    {
+        int newly_covered{};
+        for (std::size_t word{}; word < uncovered.size(); word++) {
+            newly_covered += static_cast<int>(std::bitset<64>(uncovered[word] & covered_minterms[prime][word]).count());
+        }
+        return newly_covered;
+    }
+
+    // minterms no two of which share a prime each need a prime of their own, with at least
+    // as many literals as the smallest prime covering them
+    std::pair<int, int> get_lower_bound(const std::vector<std::uint64_t>& uncovered) const
+    {
+        std::vector<char> is_prime_used(primes.size(), false);
+        std::pair<int, int> lower_bound{ 0, 0 };
+        for (std::size_t minterm{}; minterm < covering_primes.size(); minterm++) {
+            if (((uncovered[minterm / 64] >> (minterm % 64)) & 1) == 0) {
+                continue;
+            }
+            bool is_independent{ true };
+            int fewest_literals{ std::numeric_limits<int>::max() };
+            for (const int& prime : covering_primes[minterm]) {
+                is_independent = is_independent && !is_prime_used[prime];
+                fewest_literals = std::min(fewest_literals, prime_literals[prime]);
+            }
+            if (is_independent) {
+                lower_bound.first++;
+                lower_bound.second += fewest_literals;
+                for (const int& prime : covering_primes[minterm]) {
+                    is_prime_used[prime] = true;
+                }
+            }
+        }
+        return lower_bound;
+    }
+
+    void search(const std::vector<std::uint64_t>& uncovered, const int& chosen_literals)
+    {
+        if (++visited_nodes > maximum_cover_search_nodes) {
+            return;
+        }
+        std::pair<int, int> lower_bound{ get_lower_bound(uncovered) };
+        std::pair<int, int> cost_bound{ static_cast<int>(chosen_primes.size()) + lower_bound.first,
+            chosen_literals + lower_bound.second };
+        if (cost_bound >= best_cost) {
+            return;
+        }
+        if (lower_bound.first == 0) {
+            best_cost = cost_bound;
+            best_cover.clear();
+            for (const int& prime : chosen_primes) {
+                best_cover.push_back(primes[prime]);
+            }
+            return;
+        }
+
+        // branches on the uncovered minterm with fewest primes, trying primes covering most first.
+        // a prime covering no more of what is left than another, with no fewer literals, is not tried
+        int branch_minterm{ -1 };
+        for (std::size_t minterm{}; minterm < covering_primes.size(); minterm++) {
+            if (((uncovered[minterm / 64] >> (minterm % 64)) & 1) != 0 && (branch_minterm == -1
+                    || covering_primes[minterm].size() < covering_primes[branch_minterm].size())) {
+                branch_minterm = static_cast<int>(minterm);
+            }
+        }
+        const std::vector<int>& candidates{ covering_primes[branch_minterm] };
+        std::vector<std::pair<int, int>> branches;
+        for (std::size_t i{}; i < candidates.size(); i++) {
+            bool is_dominated{ false };
+            for (std::size_t j{}; j < candidates.size() && !is_dominated; j++) {
+                if (j == i || prime_literals[candidates[j]] > prime_literals[candidates[i]]) {
+                    continue;
+                }
+                bool is_contained{ true };
+                for (std::size_t word{}; word < uncovered.size() && is_contained; word++) {
+                    std::uint64_t left{ uncovered[word] & covered_minterms[candidates[i]][word] };
+                    is_contained = (left & ~covered_minterms[candidates[j]][word]) == 0;
+                }
+                // of two primes dominating each other, the first is kept
+                is_dominated = is_contained && (prime_literals[candidates[j]] < prime_literals[candidates[i]]
+                    || count_newly_covered(uncovered, candidates[j]) > count_newly_covered(uncovered, candidates[i])
+                    || j < i);
+            }
+            if (!is_dominated) {
+                branches.push_back(std::pair<int, int>{ -count_newly_covered(uncovered, candidates[i]), candidates[i] });
+            }
+        }
+        std::sort(branches.begin(), branches.end());
+
+        std::vector<std::uint64_t> still_uncovered(uncovered.size());
+        for (const auto& branch : branches) {
+            int prime{ branch.second };
+            for (std::size_t word{}; word < uncovered.size(); word++) {
+                still_uncovered[word] = uncovered[word] & ~covered_minterms[prime][word];
+            }
+            chosen_primes.push_back(prime);
+            search(still_uncovered, chosen_literals + prime_literals[prime]);
+            chosen_primes.pop_back();
+        }
+    }
+
+public:
+    // initial_cover is a known cover, which the search starts from and only replaces with a cheaper one
+    prime_cover_search(const std::vector<product_term>& set_primes, const std::vector<int>& minterms,
+        const std::vector<product_term>& initial_cover) :
+        primes{ set_primes }, prime_literals{}, covered_minterms{}, covering_primes(minterms.size()),
+        chosen_primes{}, best_cover{ initial_cover },
+        best_cost{ static_cast<int>(initial_cover.size()), get_number_of_literals(initial_cover) },
+        visited_nodes{ 0 }
+    {
+        std::size_t words{ (minterms.size() + 63) / 64 };
+        for (std::size_t prime{}; prime < primes.size(); prime++) {
+            prime_literals.push_back(count_bits(primes[prime].literal_mask));
+            covered_minterms.push_back(std::vector<std::uint64_t>(words, 0));
+            for (std::size_t i{}; i < minterms.size(); i++) {
+                if ((static_cast<std::uint32_t>(minterms[i]) & primes[prime].literal_mask) == primes[prime].value_mask) {
+                    covered_minterms[prime][i / 64] |= std::uint64_t{ 1 } << (i % 64);
+                    covering_primes[i].push_back(static_cast<int>(prime));
+                }
+            }
+        }
+    }
+
+    std::vector<product_term> find_cover()
+    {
+        std::vector<std::uint64_t> uncovered((covering_primes.size() + 63) / 64, 0);
+        for (std::size_t i{}; i < covering_primes.size(); i++) {
+            uncovered[i / 64] |= std::uint64_t{ 1 } << (i % 64);
+        }
+        search(uncovered, 0);
+        return best_cover;
+    }
+};
+
+// Quine-McCluskey: products that differ only in one input are merged, level by level,
+// and the products that could not be merged are the prime implicants
+static void minimize_exactly(const std::vector<std::uint64_t>& truth_table, const int& number_of_inputs,
+    std::vector<product_term>& cover)
+{
+    std::uint32_t all_inputs{ (std::uint32_t{ 1 } << number_of_inputs) - 1 };
+    std::vector<int> minterms;
+    for (int minterm{}; minterm < (1 << number_of_inputs); minterm++) {
+        if ((truth_table[minterm / 64] >> (minterm % 64)) & 1) {
+            minterms.push_back(minterm);
+        }
+    }
+    if (minterms.empty()) {
+        return;
+    }
+
+    auto get_key = [](const product_term& term) {
+        return (static_cast<std::uint64_t>(term.literal_mask) << 32) | term.value_mask;
+    };
+    std::vector<product_term> primes;
+    std::vector<product_term> products;
+    std::unordered_set<std::uint64_t> product_keys;
+    for (const int& minterm : minterms) {
+        products.push_back(product_term{ all_inputs, static_cast<std::uint32_t>(minterm) });
+        product_keys.insert(get_key(products.back()));
+    }
+    while (!products.empty()) {
+        std::vector<product_term> merged_products;
+        std::unordered_set<std::uint64_t> merged_keys;
+        for (const product_term& product : products) {
+            bool is_merged{ false };
+            for (int input{}; input < number_of_inputs; input++) {
+                if (((product.literal_mask >> input) & 1) == 0) {
+                    continue;
+                }
+                product_term partner{ product.literal_mask, product.value_mask ^ (std::uint32_t{ 1 } << input) };
+                if (product_keys.count(get_key(partner)) != 0) {
+                    is_merged = true;
+                    product_term merged{ remove_literal(product, input) };
+                    if (merged_keys.insert(get_key(merged)).second) {
+                        merged_products.push_back(merged);
+                    }
+                }
+            }
+            if (!is_merged) {
+                primes.push_back(product);
+            }
+        }
+        products = merged_products;
+        product_keys = merged_keys;
+    }
+
+    // the heuristic cover bounds the search from the start
+    std::vector<product_term> heuristic_cover;
+    minimize_heuristically(truth_table, number_of_inputs, heuristic_cover);
+    prime_cover_search search(primes, minterms, heuristic_cover);
+    cover = search.find_cover();
+}
+
+
+// finds a sum of products equal to the function, with as few products as it can and then as few literals
+// exact minimization is only possible for functions of up to maximum_exact_minimization_inputs inputs
+// returns false if the function has too many inputs
+bool minimize_sum_of_products(const std::vector<std::uint64_t>& truth_table, const int& number_of_inputs,
+    const minimization_mode& mode, std::vector<product_term>& cover)
+{
+    cover.clear();
+    int maximum_inputs{ mode == minimization_mode::exact ? maximum_exact_minimization_inputs : maximum_minimization_inputs };
+    if (number_of_inputs < 0 || number_of_inputs > maximum_inputs) {
+        std::cerr << "\nError: only functions of up to " << maximum_inputs << " inputs can be minimized"
+            << (mode == minimization_mode::exact ? " exactly" : "") << "\n";
+        return false;
+    }
+
+    if (mode == minimization_mode::exact) {
+        minimize_exactly(truth_table, number_of_inputs, cover);
+    }
+    else {
+        minimize_heuristically(truth_table, number_of_inputs, cover);
+    }
+    std::sort(cover.begin(), cover.end(), [](const product_term& a, const product_term& b) {
+        return std::pair<std::uint32_t, std::uint32_t>{ a.literal_mask, a.value_mask }
+            < std::pair<std::uint32_t, std::uint32_t>{ b.literal_mask, b.value_mask };
+    });
+    return true;
+}
+
+
+int get_number_of_literals(const std::vector<product_term>& cover)
+{
+    int number_of_literals{};
+    for (const product_term& term : cover) {
+        number_of_literals += count_bits(term.literal_mask);
+    }
+    return number_of_literals;
+}
+
+// writes a cover in the style of the circuit's logic formulae, eg. (a AND (NOT b)) OR c
+// input i of the function is input_names[i]; an empty cover is 0, and a product with no literals is 1
+std::string format_sum_of_products(const std::vector<product_term>& cover, const std::vector<std::string>& input_names)
+{
+    if (cover.empty()) {
+        return "0";
+    }
+    std::stringstream formula;
+    for (std::size_t i{}; i < cover.size(); i++) {
+        formula << (i == 0 ? "" : " OR ");
+        int number_of_literals{ count_bits(cover[i].literal_mask) };
+        if (number_of_literals == 0) {
+            formula << "1";
+            continue;
+        }
+        formula << (number_of_literals > 1 ? "(" : "");
+        bool is_first_literal{ true };
+        for (std::size_t input{}; input < input_names.size(); input++) {
+            if ((cover[i].literal_mask >> input) & 1) {
+                formula << (is_first_literal ? "" : " AND ");
+                if ((cover[i].value_mask >> input) & 1) {
+                    formula << input_names[input];
+                }
+                else {
+                    formula << "(NOT " << input_names[input] << ")";
+                }
+                is_first_literal = false;
+            }
+        }
+        formula << (number_of_literals > 1 ? ")" : "");
+    }
+    return formula.str();
+}
@@ -0,0 +1,44 @@
+// sop_minimization.h (last modified: 18/10/26)
+// header file for two-level (sum-of-products) minimization of functions given by their truth table
+// heuristic minimization starts from an irredundant cover of prime implicants (Minato-Morreale),
+// then improves it with Espresso's reduce, expand and irredundant steps. exact minimization finds
+// every prime implicant (Quine-McCluskey) and picks a smallest set of them by branch and bound, keeping
+// the best set found if the search runs out of its budget (so the result is then only near-minimal).
+// both work on truth tables packed 64 minterms to a word, so most cube checks are a few word operations
+
+#ifndef SOP_MINIMIZATION_H
+#define SOP_MINIMIZATION_H
+
+#include <vector>
+#include <string>
+#include <cstdint>
+
+
+// largest number of inputs of a function that can be minimized, and that can be minimized exactly
+const int maximum_minimization_inputs{ 20 };
+const int maximum_exact_minimization_inputs{ 8 };
+
+
+enum class minimization_mode : unsigned char
+{
+    heuristic, exact
+};
+
+
+// a product of literals: input i is in the product if bit i of literal_mask is set,
+// uncomplemented if bit i of value_mask is also set. a product with no literals is always 1
+struct product_term
+{
+    std::uint32_t literal_mask;
+    std::uint32_t value_mask;
+};
+
+
+// truth_table has bit m of the function set for each minterm m (input i being bit i of m), 64 to a word;
+// functions of fewer than 6 inputs take one word, repeating every 2^number_of_inputs bits
+bool minimize_sum_of_products(const std::vector<std::uint64_t>& truth_table, const int& number_of_inputs,
+    const minimization_mode& mode, std::vector<product_term>& cover);
+int get_number_of_literals(const std::vector<product_term>& cover);
+std::string format_sum_of_products(const std::vector<product_term>& cover, const std::vector<std::string>& input_names);
+
+#endif
@@ -0,0 +1,356 @@
+// static_circuit.h (last modified: 18/10/26)
+// header file for circuits described at compile time, for small fixed circuits in test code
+// a static_circuit is a type built from static_input, static_gate and static_lut types, using the gate
+// types of logic_operation. its outputs, truth table and equivalence to another description are all
+// constexpr, so checks on them can be static_asserts that cost nothing when the program runs.
+// the same description can also build a circuit, to check the simulator against it. eg. a full adder:
+//     using a_xor_b = static_xor<static_input<0>, static_input<1>>;
+//     using full_adder = static_circuit<3, static_xor<a_xor_b, static_input<2>>,
+//         static_or<static_and<static_input<0>, static_input<1>>, static_and<a_xor_b, static_input<2>>>>;
+//     static_assert(full_adder::evaluate(1, 0b011), "0 + 1 + 1 carries");
+// rows are numbered as in truth tables, with the first input as the most significant bit.
+// this example and others are checked whenever the benchmarks are built (Benchmarks/static_circuit_checks.cpp)
+
+#ifndef STATIC_CIRCUIT_H
+#define STATIC_CIRCUIT_H
+
+#include <vector>
+#include <string>
+#include <algorithm>
+#include <initializer_list>
+#include <cstdint>
+#include "circuit.h"
+#include "bit_matrix.h"
+#include "differential_simulation.h"
+#include "universal_functions.h"
+
+
+// largest number of inputs of a static_circuit, so its truth table can be found while compiling
+const int maximum_static_inputs{ 16 };
+
+
+// values of the inputs on one truth table row, each as a word of all 0s or all 1s
+struct static_row_values
+{
+    int number_of_inputs;
+    std::uint64_t row;
+
+    constexpr std::uint64_t get_input_word(const int& input) const
+    {
+        return ((row >> (number_of_inputs - 1 - input)) & 1) ? ~std::uint64_t{ 0 } : 0;
+    }
+};
+
+// values of the inputs on 64 truth table rows at once, rows 64 * word to 64 * word + 63,
+// row r being bit (r % 64). with fewer than 6 inputs, the rows repeat through the word
+struct static_truth_table_values
+{
+    int number_of_inputs;
+    std::uint64_t word;
+
+    constexpr std::uint64_t get_input_word(const int& input) const
+    {
+        int bit{ number_of_inputs - 1 - input };
+        if (bit < 6) {
+            const std::uint64_t low_bit_words[]{ 0xaaaaaaaaaaaaaaaa, 0xcccccccccccccccc, 0xf0f0f0f0f0f0f0f0,
+                0xff00ff00ff00ff00, 0xffff0000ffff0000, 0xffffffff00000000 };
+            return low_bit_words[bit];
+        }
+        return ((word >> (bit - 6)) & 1) ? ~std::uint64_t{ 0 } : 0;
+    }
+};
+
+
+// the operation of each gate type on 64 rows at a time, specialized for each gate_code
+template <gate_code code> struct static_gate_operation;
+
+template <> struct static_gate_operation<gate_code::not_gate>
+{
+    static constexpr int minimum_operands{ 1 };
+    static constexpr int maximum_operands{ 1 };
+    static constexpr std::uint64_t apply(const std::uint64_t* words, const int&) { return ~words[0]; }
+    static std::string get_gate_type(const int&) { return "NOT"; }
+};
+
+template <> struct static_gate_operation<gate_code::buffer_gate>
+{
+    static constexpr int minimum_operands{ 1 };
+    static constexpr int maximum_operands{ 1 };
+    static constexpr std::uint64_t apply(const std::uint64_t* words, const int&) { return words[0]; }
+    static std::string get_gate_type(const int&) { return "BUFFER"; }
+};
+
+template <> struct static_gate_operation<gate_code::and_gate>
+{
+    static constexpr int minimum_operands{ 2 };
+    static constexpr int maximum_operands{ maximum_wide_gate_inputs };
+    static constexpr std::uint64_t apply(const std::uint64_t* words, const int& number_of_operands)
+    {
+        std::uint64_t result{ words[0] };
+        for (int i{ 1 }; i < number_of_operands; i++) {
+            result &= words[i];
+        }
+        return result;
+    }
+    static std::string get_gate_type(const int& number_of_operands)
+    {
+        return number_of_operands == 2 ? "AND" : "AND" + std::to_string(number_of_operands);
+    }
+};
+
+template <> struct static_gate_operation<gate_code::or_gate>
+{
+    static constexpr int minimum_operands{ 2 };
+    static constexpr int maximum_operands{ maximum_wide_gate_inputs };
+    static constexpr std::uint64_t apply(const std::uint64_t* words, const int& number_of_operands)
+    {
+        std::uint64_t result{ words[0] };
+        for (int i{ 1 }; i < number_of_operands; i++) {
+            result |= words[i];
+        }
+        return result;
+    }
+    static std::string get_gate_type(const int& number_of_operands)
+    {
+        return number_of_operands == 2 ? "OR" : "OR" + std::to_string(number_of_operands);
+    }
+};
+
+template <> struct static_gate_operation<gate_code::xor_gate>
+{
+    static constexpr int minimum_operands{ 2 };
+    static constexpr int maximum_operands{ maximum_wide_gate_inputs };
+    static constexpr std::uint64_t apply(const std::uint64_t* words, const int& number_of_operands)
+    {
+        std::uint64_t result{ words[0] };
+        for (int i{ 1 }; i < number_of_operands; i++) {
+            result ^= words[i];
+        }
+        return result;
+    }
+    static std::string get_gate_type(const int& number_of_operands)
+    {
+        return number_of_operands == 2 ? "XOR" : "XOR" + std::to_string(number_of_operands);
+    }
+};
+
+template <> struct static_gate_operation<gate_code::nand_gate>
+{
+    static constexpr int minimum_operands{ 2 };
+    static constexpr int maximum_operands{ maximum_wide_gate_inputs };
+    static constexpr std::uint64_t apply(const std::uint64_t* words, const int& number_of_operands)
+    {
+        return ~static_gate_operation<gate_code::and_gate>::apply(words, number_of_operands);
+    }
+    static std::string get_gate_type(const int& number_of_operands)
+    {
+        return number_of_operands == 2 ? "NAND" : "NAND" + std::to_string(number_of_operands);
+    }
+};
+
+template <> struct static_gate_operation<gate_code::nor_gate>
+{
+    static constexpr int minimum_operands{ 2 };
+    static constexpr int maximum_operands{ maximum_wide_gate_inputs };
+    static constexpr std::uint64_t apply(const std::uint64_t* words, const int& number_of_operands)
+    {
+        return ~static_gate_operation<gate_code::or_gate>::apply(words, number_of_operands);
+    }
+    static std::string get_gate_type(const int& number_of_operands)
+    {
+        return number_of_operands == 2 ? "NOR" : "NOR" + std::to_string(number_of_operands);
+    }
+};
+
+template <> struct static_gate_operation<gate_code::xnor_gate>
+{
+    static constexpr int minimum_operands{ 2 };
+    static constexpr int maximum_operands{ maximum_wide_gate_inputs };
+    static constexpr std::uint64_t apply(const std::uint64_t* words, const int& number_of_operands)
+    {
+        return ~static_gate_operation<gate_code::xor_gate>::apply(words, number_of_operands);
+    }
+    static std::string get_gate_type(const int& number_of_operands)
+    {
+        return number_of_operands == 2 ? "XNOR" : "XNOR" + std::to_string(number_of_operands);
+    }
+};
+
+
+// input number index of the circuit. in a built circuit, inputs are the first elements, in order
+template <int index> struct static_input
+{
+    static_assert(index >= 0, "static_input numbers start from 0");
+
+    static constexpr int get_number_of_inputs_used() { return index + 1; }
+
+    template <class input_values> static constexpr std::uint64_t evaluate(const input_values& values)
+    {
+        return values.get_input_word(index);
+    }
+
+    static int add_to_circuit(circuit&) { return index; }
+};
+
+// a gate of the given type reading the given operands (static_input, static_gate or static_lut types)
+template <gate_code code, class... operands> struct static_gate
+{
+    static_assert(sizeof...(operands) >= static_gate_operation<code>::minimum_operands
+        && sizeof...(operands) <= static_gate_operation<code>::maximum_operands, "wrong number of gate operands");
+
+    static constexpr int get_number_of_inputs_used()
+    {
+        return std::max({ operands::get_number_of_inputs_used()... });
+    }
+
+    template <class input_values> static constexpr std::uint64_t evaluate(const input_values& values)
+    {
+        const std::uint64_t words[]{ operands::evaluate(values)... };
+        return static_gate_operation<code>::apply(words, static_cast<int>(sizeof...(operands)));
+    }
+
+    // adds the gate, after its operands, and returns its position. shared operands are added once per use
+    static int add_to_circuit(circuit& target)
+    {
+        std::vector<int> input_positions{ operands::add_to_circuit(target)... };
+        std::string gate_type{ static_gate_operation<code>::get_gate_type(static_cast<int>(input_positions.size())) };
+        if (input_positions.size() == 1) {
+            target.add_element(gate_type, input_positions[0]);
+        }
+        else if (input_positions.size() == 2) {
+            target.add_element(gate_type, input_positions[0], input_positions[1]);
+        }
+        else {
+            target.add_element(gate_type, input_positions);
+        }
+        return target.get_circuit_size() - 1;
+    }
+};
+
+template <class operand> using static_not = static_gate<gate_code::not_gate, operand>;
+template <class operand> using static_buffer = static_gate<gate_code::buffer_gate, operand>;
+template <class... operands> using static_and = static_gate<gate_code::and_gate, operands...>;
+template <class... operands> using static_or = static_gate<gate_code::or_gate, operands...>;
+template <class... operands> using static_nand = static_gate<gate_code::nand_gate, operands...>;
+template <class... operands> using static_nor = static_gate<gate_code::nor_gate, operands...>;
+template <class... operands> using static_xor = static_gate<gate_code::xor_gate, operands...>;
+template <class... operands> using static_xnor = static_gate<gate_code::xnor_gate, operands...>;
+
+// a look-up table gate, as made by make_lut_gate_type: bit r of truth_table_mask is its output
+// on truth table row r of its operands, the first operand being the most significant bit
+template <std::uint64_t truth_table_mask, class... operands> struct static_lut
+{
+    static_assert(sizeof...(operands) >= 1 && sizeof...(operands) <= maximum_lut_inputs, "wrong number of gate operands");
+
+    static constexpr int get_number_of_inputs_used()
+    {
+        return std::max({ operands::get_number_of_inputs_used()... });
+    }
+
+    template <class input_values> static constexpr std::uint64_t evaluate(const input_values& values)
+    {
+        const std::uint64_t words[]{ operands::evaluate(values)... };
+        int number_of_operands{ static_cast<int>(sizeof...(operands)) };
+        std::uint64_t result{};
+        for (int row{}; row < (1 << number_of_operands); row++) {
+            if (((truth_table_mask >> row) & 1) == 0) {
+                continue;
+            }
+            std::uint64_t row_word{ ~std::uint64_t{ 0 } };
+            for (int i{}; i < number_of_operands; i++) {
+                row_word &= ((row >> (number_of_operands - 1 - i)) & 1) ? words[i] : ~words[i];
+            }
+            result |= row_word;
+        }
+        return result;
+    }
+
+    static int add_to_circuit(circuit& target)
+    {
+        std::vector<int> input_positions{ operands::add_to_circuit(target)... };
+        target.add_element(make_lut_gate_type(static_cast<int>(input_positions.size()), truth_table_mask), input_positions);
+        return target.get_circuit_size() - 1;
+    }
+};
+
+
+// a circuit of number_of_inputs inputs, with one output for each description in outputs
+template <int number_of_inputs, class... outputs> struct static_circuit
+{
+    static_assert(number_of_inputs >= 0 && number_of_inputs <= maximum_static_inputs, "too many static_circuit inputs");
+    static_assert(sizeof...(outputs) >= 1, "a static_circuit needs at least one output");
+    static_assert(std::max({ outputs::get_number_of_inputs_used()... }) <= number_of_inputs,
+        "an output reads an input the static_circuit does not have");
+
+    static constexpr int get_number_of_inputs() { return number_of_inputs; }
+    static constexpr int get_number_of_outputs() { return static_cast<int>(sizeof...(outputs)); }
+    static constexpr int get_number_of_truth_table_words()
+    {
+        return number_of_inputs <= 6 ? 1 : 1 << (number_of_inputs - 6);
+    }
+
+    static constexpr bool evaluate(const int& output, const std::uint64_t& row)
+    {
+        const static_row_values values{ number_of_inputs, row };
+        const std::uint64_t words[]{ outputs::evaluate(values)... };
+        return (words[output] & 1) != 0;
+    }
+
+    // rows 64 * word to 64 * word + 63 of an output's truth table column, row r being bit (r % 64).
+    // with n < 6 inputs, the 2^n rows repeat through the word, so the low 2^n bits are its look-up table mask
+    static constexpr std::uint64_t get_truth_table_word(const int& output, const std::uint64_t& word)
+    {
+        const static_truth_table_values values{ number_of_inputs, word };
+        const std::uint64_t words[]{ outputs::evaluate(values)... };
+        return words[output];
+    }
+
+    // whether another description, with as many inputs and outputs, gives the same output for every row
+    template <class other> static constexpr bool is_equivalent_to()
+    {
+        if (other::get_number_of_inputs() != number_of_inputs || other::get_number_of_outputs() != get_number_of_outputs()) {
+            return false;
+        }
+        for (int output{}; output < get_number_of_outputs(); output++) {
+            for (int word{}; word < get_number_of_truth_table_words(); word++) {
+                if (get_truth_table_word(output, word) != other::get_truth_table_word(output, word)) {
+                    return false;
+                }
+            }
+        }
+        return true;
+    }
+
+    // adds the description to an empty circuit, inputs first (set to 0), and returns the output positions.
+    // each output's description is added as a tree, so logic shared between descriptions is added again
+    static std::vector<int> build_circuit(circuit& target)
+    {
+        for (int input{}; input < number_of_inputs; input++) {
+            target.add_element(false);
+        }
+        return std::vector<int>{ outputs::add_to_circuit(target)... };
+    }
+
+    // simulates source on every input vector, and checks the given elements against the outputs' truth tables
+    static bool matches_circuit(const circuit& source, const std::vector<int>& output_positions)
+    {
+        if (static_cast<int>(source.get_input_positions().size()) != number_of_inputs
+                || static_cast<int>(output_positions.size()) != get_number_of_outputs()) {
+            return false;
+        }
+        bit_matrix output_vectors{ source.evaluate_batch(get_comparison_vectors(number_of_inputs), output_positions) };
+        int rows{ 1 << number_of_inputs };
+        std::uint64_t used_bits{ rows >= 64 ? ~std::uint64_t{ 0 } : (std::uint64_t{ 1 } << rows) - 1 };
+
+        for (int output{}; output < get_number_of_outputs(); output++) {
+            for (int word{}; word < get_number_of_truth_table_words(); word++) {
+                if (output_vectors.get_word(output, word) != (get_truth_table_word(output, word) & used_bits)) {
+                    return false;
+                }
+            }
+        }
+        return true;
+    }
+};
+
+#endif
@@ -0,0 +1,126 @@
+// symbol_table.cpp (last modified: 18/10/26)
+// Contains definition of all symbol_table class members not defined in symbol_table.h
+
+#include <vector>
+#include <string>
+#include <cstring>
+#include <cstdint>
+#include <cstddef>
+#include "symbol_table.h"
+
+
+// the index is kept at most half full, so probe sequences stay short however many names there are
+const int minimum_index_size{ 16 };
+
+
+// 64-bit FNV-1a over the characters of a name, followed by a final mix so that
+// names differing only in their last characters still spread across the whole index
+static std::uint64_t hash_name(const std::string& name)
+{
+    std::uint64_t hash{ 0xcbf29ce484222325 };
+    for (const char& character : name) {
+        hash = (hash ^ static_cast<unsigned char>(character)) * 0x100000001b3;
+    }
+    hash ^= hash >> 33;
+    hash *= 0xff51afd7ed558ccd;
+    hash ^= hash >> 33;
+    return hash;
+}
+
+
+symbol_table::symbol_table() :
+    name_characters{}, name_starts{ 0 }, name_hashes{}, hash_slots{} {}
+
+
+// slot holding the id of name, or the empty slot where it would be added
+int symbol_table::find_slot(const std::string& name, const std::uint64_t& hash) const
+{
+    int mask{ static_cast<int>(hash_slots.size()) - 1 };
+    int slot{ static_cast<int>(hash & static_cast<std::uint64_t>(mask)) };
+
+    while (hash_slots[slot] != -1) {
+        int name_id{ hash_slots[slot] };
+        int name_length{ name_starts[name_id + 1] - name_starts[name_id] };
+
+        if (name_hashes[name_id] == hash && name_length == static_cast<int>(name.size())
+            && std::memcmp(name_characters.data() + name_starts[name_id], name.data(), name.size()) == 0) {
+            return slot;
+        }
+        slot = (slot + 1) & mask;
+    }
+    return slot;
+}
+
+// doubles the size of the hash index and puts every id back, using the stored hashes
+void symbol_table::grow_index()
+{
+    int new_size{ hash_slots.empty() ? minimum_index_size : static_cast<int>(hash_slots.size()) * 2 };
+    int mask{ new_size - 1 };
+    hash_slots.assign(new_size, -1);
+
+    for (int name_id{}; name_id < get_size(); name_id++) {
+        int slot{ static_cast<int>(name_hashes[name_id] & static_cast<std::uint64_t>(mask)) };
+        while (hash_slots[slot] != -1) {
+            slot = (slot + 1) & mask;
+        }
+        hash_slots[slot] = name_id;
+    }
+}
+
+
+// returns the id of name, adding it first if it is new
+// ids are given out in order from 0, so they can index other vectors
+int symbol_table::add_name(const std::string& name)
+{
+    if ((get_size() + 1) * 2 > static_cast<int>(hash_slots.size())) {
+        grow_index();
+    }
+
+    std::uint64_t hash{ hash_name(name) };
+    int slot{ find_slot(name, hash) };
+    if (hash_slots[slot] != -1) {
+        return hash_slots[slot];
+    }
+
+    int name_id{ get_size() };
+    name_characters.insert(name_characters.end(), name.begin(), name.end());
+    name_starts.push_back(static_cast<int>(name_characters.size()));
+    name_hashes.push_back(hash);
+    hash_slots[slot] = name_id;
+    return name_id;
+}
+
+// returns the id of name, or -1 if it has never been added
+int symbol_table::find_name(const std::string& name) const
+{
+    if (hash_slots.empty()) {
+        return -1;
+    }
+    return hash_slots[find_slot(name, hash_name(name))];
+}
+
+std::string symbol_table::get_name(const int& name_id) const
+{
+    return std::string(name_characters.data() + name_starts[name_id],
+        name_characters.data() + name_starts[name_id + 1]);
+}
+
+
+int symbol_table::get_size() const
+{
+    return static_cast<int>(name_hashes.size());
+}
+
+std::size_t symbol_table::get_memory_used() const
+{
+    return name_characters.capacity() * sizeof(char) + name_starts.capacity() * sizeof(int)
+        + name_hashes.capacity() * sizeof(std::uint64_t) + hash_slots.capacity() * sizeof(int);
+}
+
+void symbol_table::clear()
+{
+    name_characters.clear();
+    name_starts.assign(1, 0);
+    name_hashes.clear();
+    hash_slots.clear();
+}
@@ -0,0 +1,39 @@
+// symbol_table.h (last modified: 18/10/26)
+// header file for the symbol_table class definition and class member declarations
+// a symbol_table interns names: each distinct name is stored once, in one shared character pool,
+// and given an id. a flat open-addressing hash index finds the id of a name in constant time
+
+#ifndef SYMBOL_TABLE_H
+#define SYMBOL_TABLE_H
+
+#include <vector>
+#include <string>
+#include <cstdint>
+#include <cstddef>
+
+
+class symbol_table
+{
+private:
+    std::vector<char> name_characters;          // every name, one after another
+    std::vector<int> name_starts;               // name id -> start of its characters (one extra entry at the end)
+    std::vector<std::uint64_t> name_hashes;     // name id -> hash, so growing the index never rehashes strings
+    std::vector<int> hash_slots;                // name ids, or -1 for an empty slot; the size is a power of 2
+
+    int find_slot(const std::string& name, const std::uint64_t& hash) const;
+    void grow_index();
+
+public:
+    symbol_table();
+    ~symbol_table() {};
+
+    int add_name(const std::string& name);
+    int find_name(const std::string& name) const;
+    std::string get_name(const int& name_id) const;
+
+    int get_size() const;
+    std::size_t get_memory_used() const;
+    void clear();
+};
+
+#endif
@@ -0,0 +1,128 @@
+// thread_pool.cpp (last modified: 18/10/26)
+// Contains definition of all thread_pool class members not defined in thread_pool.h
+
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <functional>
+#include <cstdint>
+#include "thread_pool.h"
+#include "tracing.h"
+
+
+// number of times an idle worker checks for a new job before going to sleep
+// jobs issued level after level usually arrive within this window
+const int worker_spin_limit{ 4096 };
+
+
+// the calling thread also works on every job, so number_of_threads - 1 workers are started
+thread_pool::thread_pool(const int& number_of_threads) :
+    workers{}, is_stopping{ false }, work_state{ 0 }, chunks_done{ 0 },
+    current_task{ nullptr }, job_generation{ 0 }
+{
+    for (int i{ 1 }; i < number_of_threads; i++) {
+        workers.emplace_back(&thread_pool::worker_loop, this);
+    }
+}
+
+thread_pool::~thread_pool()
+{
+    {
+        std::lock_guard<std::mutex> lock(pool_mutex);
+        is_stopping = true;
+    }
+    work_available.notify_all();
+
+    for (std::thread& worker : workers) {
+        worker.join();
+    }
+}
+
+int thread_pool::get_number_of_threads() const
+{
+    return static_cast<int>(workers.size()) + 1;
+}
+
+
+// runs task(0) ... task(number_of_chunks - 1) across the workers and the calling thread
+// returns once every chunk has finished, so consecutive calls act as a barrier
+void thread_pool::run_chunks(const int& number_of_chunks, const std::function<void(int)>& task)
+{
+    if (number_of_chunks <= 0) {
+        return;
+    }
+
+    current_task = &task;
+    chunks_done.store(0, std::memory_order_relaxed);
+    job_generation++;
+    {
+        std::lock_guard<std::mutex> lock(pool_mutex);
+        work_state.store((static_cast<std::uint64_t>(job_generation) << 32)
+            | static_cast<std::uint32_t>(number_of_chunks), std::memory_order_release);
+    }
+    work_available.notify_all();
+
+    run_available_chunks(job_generation);
+
+    // time spent here is time the calling thread waits for slower workers
+    TRACE_SCOPE("wait_for_workers");
+    while (chunks_done.load(std::memory_order_acquire) != number_of_chunks) {
+        std::this_thread::yield();
+    }
+}
+
+
+// claims chunks of the given job until none are left
+// a chunk is only claimed while its job is still current, so a late worker never runs a stale task
+void thread_pool::run_available_chunks(const std::uint32_t& generation)
+{
+    std::uint64_t state{ work_state.load(std::memory_order_acquire) };
+
+    while (static_cast<std::uint32_t>(state >> 32) == generation
+        && static_cast<std::uint32_t>(state) != 0) {
+        if (work_state.compare_exchange_weak(state, state - 1, std::memory_order_acq_rel)) {
+            int chunk{ static_cast<int>(static_cast<std::uint32_t>(state) - 1) };
+            {
+                TRACE_SCOPE_ARGUMENT("pool_chunk", "chunk", chunk);
+                (*current_task)(chunk);
+            }
+            chunks_done.fetch_add(1, std::memory_order_release);
+            state = work_state.load(std::memory_order_acquire);
+        }
+    }
+}
+
+
+// workers spin briefly waiting for the next job, then sleep until one is issued
+void thread_pool::worker_loop()
+{
+    std::uint32_t last_generation{ 0 };
+
+    while (true) {
+        std::uint32_t generation{ last_generation };
+
+        for (int i{}; i < worker_spin_limit && generation == last_generation; i++) {
+            generation = static_cast<std::uint32_t>(work_state.load(std::memory_order_acquire) >> 32);
+            if (generation == last_generation) {
+                std::this_thread::yield();
+            }
+        }
+
+        if (generation == last_generation) {
+            std::unique_lock<std::mutex> lock(pool_mutex);
+            work_available.wait(lock, [this, &last_generation]() {
+                return is_stopping ||
+                    static_cast<std::uint32_t>(work_state.load(std::memory_order_acquire) >> 32) != last_generation;
+            });
+            if (is_stopping) {
+                return;
+            }
+            generation = static_cast<std::uint32_t>(work_state.load(std::memory_order_acquire) >> 32);
+        }
+
+        last_generation = generation;
+        run_available_chunks(generation);
+    }
+}
@@ -0,0 +1,46 @@
+// thread_pool.h (last modified: 18/10/26)
+// header file for the thread_pool class definition and class member declarations
+// the pool keeps its worker threads alive between jobs, so starting a job only costs a wake-up
+
+#ifndef THREAD_POOL_H
+#define THREAD_POOL_H
+
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <functional>
+#include <cstdint>
+
+
+class thread_pool
+{
+private:
+    std::vector<std::thread> workers;
+    std::mutex pool_mutex;
+    std::condition_variable work_available;
+    bool is_stopping;
+
+    // high 32 bits hold the job generation, low 32 bits the number of unclaimed chunks
+    // claiming a chunk and checking it belongs to the current job is then a single compare-exchange
+    std::atomic<std::uint64_t> work_state;
+    std::atomic<int> chunks_done;
+    const std::function<void(int)>* current_task;
+    std::uint32_t job_generation;
+
+    void worker_loop();
+    void run_available_chunks(const std::uint32_t& generation);
+
+public:
+    thread_pool(const int& number_of_threads);
+    ~thread_pool();
+
+    thread_pool(const thread_pool&) = delete;
+    thread_pool& operator=(const thread_pool&) = delete;
+
+    int get_number_of_threads() const;
+    void run_chunks(const int& number_of_chunks, const std::function<void(int)>& task);
+};
+
+#endif
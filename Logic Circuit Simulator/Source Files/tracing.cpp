@@ -0,0 +1,213 @@
+// tracing.cpp (last modified: 18/10/26)
+// Contains definition of the tracing functions declared in tracing.h
+
+#include <iostream>
+#include <fstream>
+#include <iomanip>
+#include <vector>
+#include <string>
+#include <memory>
+#include <mutex>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include "tracing.h"
+
+
+// events kept per thread; once a buffer is full the oldest events are overwritten
+const std::uint64_t trace_buffer_size{ 1 << 16 };
+
+struct trace_event
+{
+    const char* name;
+    const char* argument_name;
+    std::int64_t argument;
+    std::uint64_t start_time;
+    std::uint64_t end_time;
+};
+
+// a place in a ring buffer. a scope that was open when tracing stopped can still overwrite the oldest
+// event while write_trace copies it, so every field is atomic (stored and loaded relaxed), and
+// write_trace drops any event the buffer's thread may have started overwriting while it was copied
+struct trace_slot
+{
+    std::atomic<const char*> name;
+    std::atomic<const char*> argument_name;
+    std::atomic<std::int64_t> argument;
+    std::atomic<std::uint64_t> start_time;
+    std::atomic<std::uint64_t> end_time;
+};
+
+// one thread's ring buffer. only its own thread writes events; events_written is published
+// with release ordering, so write_trace sees every event counted in it completely written.
+// start_tracing does not clear the buffers itself, as that would race with their threads' own updates:
+// it starts a new trace generation, and each thread empties its buffer when it records its first
+// event of the new generation. a buffer still holding an older generation has no events in this trace
+struct trace_buffer
+{
+    int thread_number;
+    std::unique_ptr<trace_slot[]> events;
+    std::atomic<std::uint64_t> events_written;
+    std::atomic<std::uint64_t> generation;
+};
+
+static std::atomic<bool> tracing_enabled{ false };
+static std::atomic<int> tracing_thread_number{ 0 };    // the thread that started tracing
+static std::atomic<std::uint64_t> trace_generation{ 0 };
+static std::atomic<std::int64_t> trace_start_time{ std::chrono::steady_clock::now().time_since_epoch().count() };   // in clock ticks
+static std::mutex trace_registry_mutex;
+
+static std::vector<std::unique_ptr<trace_buffer>>& get_trace_registry()
+{
+    static std::vector<std::unique_ptr<trace_buffer>> registry;
+    return registry;
+}
+
+// the calling thread's ring buffer, created and registered on its first event
+static trace_buffer& get_trace_buffer()
+{
+    thread_local trace_buffer* local_buffer{ nullptr };
+
+    if (local_buffer == nullptr) {
+        std::unique_ptr<trace_buffer> new_buffer(new trace_buffer);
+        new_buffer->events.reset(new trace_slot[trace_buffer_size]);
+        new_buffer->events_written.store(0, std::memory_order_relaxed);
+        new_buffer->generation.store(trace_generation.load(), std::memory_order_relaxed);
+        local_buffer = new_buffer.get();
+
+        std::lock_guard<std::mutex> lock(trace_registry_mutex);
+        new_buffer->thread_number = static_cast<int>(get_trace_registry().size());
+        get_trace_registry().push_back(std::move(new_buffer));
+    }
+    return *local_buffer;
+}
+
+
+// discards every recorded event and starts recording, with times measured from now
+void start_tracing()
+{
+    tracing_enabled.store(false);
+    tracing_thread_number.store(get_trace_buffer().thread_number);
+    trace_generation.fetch_add(1);
+    trace_start_time.store(std::chrono::steady_clock::now().time_since_epoch().count());
+    tracing_enabled.store(true);
+}
+
+void stop_tracing()
+{
+    tracing_enabled.store(false);
+}
+
+bool is_tracing()
+{
+    return tracing_enabled.load(std::memory_order_relaxed);
+}
+
+// nanoseconds since tracing started
+std::uint64_t get_trace_time()
+{
+    std::chrono::steady_clock::duration start_time{ trace_start_time.load(std::memory_order_relaxed) };
+    return static_cast<std::uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch() - start_time).count());
+}
+
+void record_trace_event(const char* name, const char* argument_name, const std::int64_t& argument,
+    const std::uint64_t& start_time, const std::uint64_t& end_time)
+{
+    // a scope that was open when tracing restarted has no place on the new timeline
+    if (end_time < start_time) {
+        return;
+    }
+    trace_buffer& buffer{ get_trace_buffer() };
+    std::uint64_t generation{ trace_generation.load(std::memory_order_relaxed) };
+    if (buffer.generation.load(std::memory_order_relaxed) != generation) {
+        buffer.events_written.store(0, std::memory_order_relaxed);
+        buffer.generation.store(generation, std::memory_order_release);
+    }
+    std::uint64_t event_number{ buffer.events_written.load(std::memory_order_relaxed) };
+
+    // the fence keeps the count of events written so far ahead of the slot's new fields, so a write_trace
+    // that copies any of them also sees that this event has started (see copy_trace_event)
+    std::atomic_thread_fence(std::memory_order_release);
+    trace_slot& slot{ buffer.events[event_number & (trace_buffer_size - 1)] };
+    slot.name.store(name, std::memory_order_relaxed);
+    slot.argument_name.store(argument_name, std::memory_order_relaxed);
+    slot.argument.store(argument, std::memory_order_relaxed);
+    slot.start_time.store(start_time, std::memory_order_relaxed);
+    slot.end_time.store(end_time, std::memory_order_relaxed);
+    buffer.events_written.store(event_number + 1, std::memory_order_release);
+}
+
+
+// copies event number event_number out of a buffer, returning false if the buffer's thread may have
+// overwritten it meanwhile: it has if it has since started an event trace_buffer_size later, or a new trace
+static bool copy_trace_event(const trace_buffer& buffer, const std::uint64_t& event_number, trace_event& event)
+{
+    const trace_slot& slot{ buffer.events[event_number & (trace_buffer_size - 1)] };
+    event.name = slot.name.load(std::memory_order_relaxed);
+    event.argument_name = slot.argument_name.load(std::memory_order_relaxed);
+    event.argument = slot.argument.load(std::memory_order_relaxed);
+    event.start_time = slot.start_time.load(std::memory_order_relaxed);
+    event.end_time = slot.end_time.load(std::memory_order_relaxed);
+
+    std::atomic_thread_fence(std::memory_order_acquire);
+    return buffer.events_written.load(std::memory_order_relaxed) < event_number + trace_buffer_size
+        && buffer.generation.load(std::memory_order_relaxed) == trace_generation.load(std::memory_order_relaxed);
+}
+
+
+// writes a nanosecond time in the microseconds that trace-event files use
+static void write_trace_time(std::ostream& trace_file, const std::uint64_t& nanoseconds)
+{
+    trace_file << nanoseconds / 1000 << "." << std::setw(3) << std::setfill('0') << nanoseconds % 1000;
+}
+
+// stops tracing and writes every recorded event as a Chrome trace-event ("X", complete) event,
+// plus a name for each thread's timeline. returns false if the file cannot be written
+bool write_trace(const std::string& file_name)
+{
+    stop_tracing();
+    std::ofstream trace_file(file_name);
+    if (!trace_file) {
+        std::cerr << "\nError: could not write to '" << file_name << "'\n";
+        return false;
+    }
+
+    std::lock_guard<std::mutex> lock(trace_registry_mutex);
+    std::uint64_t events_lost{};
+    bool is_first_event{ true };
+    trace_file << "{\"traceEvents\":[";
+
+    for (const std::unique_ptr<trace_buffer>& buffer : get_trace_registry()) {
+        bool is_current{ buffer->generation.load(std::memory_order_acquire) == trace_generation.load() };
+        std::uint64_t events_written{ is_current ? buffer->events_written.load(std::memory_order_acquire) : 0 };
+        std::uint64_t first_event{ events_written > trace_buffer_size ? events_written - trace_buffer_size : 0 };
+        events_lost += first_event;
+
+        std::string thread_name{ buffer->thread_number == tracing_thread_number.load() ?
+            "main thread" : "thread " + std::to_string(buffer->thread_number) };
+        trace_file << (is_first_event ? "\n" : ",\n") << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":"
+            << buffer->thread_number << ",\"args\":{\"name\":\"" << thread_name << "\"}}";
+        is_first_event = false;
+
+        for (std::uint64_t i{ first_event }; i < events_written; i++) {
+            trace_event event;
+            if (!copy_trace_event(*buffer, i, event)) {
+                events_lost++;
+                continue;
+            }
+
+            trace_file << ",\n{\"name\":\"" << event.name << "\",\"cat\":\"simulation\",\"ph\":\"X\",\"pid\":1,\"tid\":"
+                << buffer->thread_number << ",\"ts\":";
+            write_trace_time(trace_file, event.start_time);
+            trace_file << ",\"dur\":";
+            write_trace_time(trace_file, event.end_time - event.start_time);
+            if (event.argument_name != nullptr) {
+                trace_file << ",\"args\":{\"" << event.argument_name << "\":" << event.argument << "}";
+            }
+            trace_file << "}";
+        }
+    }
+    trace_file << "\n],\"displayTimeUnit\":\"ns\",\"otherData\":{\"events_lost\":" << events_lost << "}}\n";
+    return static_cast<bool>(trace_file);
+}
@@ -0,0 +1,67 @@
+// tracing.h (last modified: 18/10/26)
+// header file for timeline tracing of simulation phases
+// while tracing is on, each TRACE_SCOPE records when it started and how long it took into a ring buffer
+// owned by the current thread, so recording takes no locks. write_trace saves the buffers as
+// Chrome trace-event JSON, which chrome://tracing and ui.perfetto.dev show as one timeline per thread.
+// like the counters in instrumentation.h, building with LCS_NO_INSTRUMENTATION removes every TRACE_SCOPE
+
+#ifndef TRACING_H
+#define TRACING_H
+
+#include <string>
+#include <cstdint>
+#include "instrumentation.h"
+
+
+void start_tracing();
+void stop_tracing();
+bool is_tracing();
+bool write_trace(const std::string& file_name);
+
+std::uint64_t get_trace_time();
+void record_trace_event(const char* name, const char* argument_name, const std::int64_t& argument,
+    const std::uint64_t& start_time, const std::uint64_t& end_time);
+
+
+// records the time between its construction and destruction as one event
+// name and argument_name must be string literals, as only the pointers are kept
+class scoped_trace
+{
+private:
+    const char* name;
+    const char* argument_name;
+    std::int64_t argument;
+    std::uint64_t start_time;
+    bool is_recording;
+
+public:
+    scoped_trace(const char* set_name, const char* set_argument_name = nullptr, const std::int64_t& set_argument = 0) :
+        name{ set_name }, argument_name{ set_argument_name }, argument{ set_argument },
+        start_time{}, is_recording{ is_tracing() }
+    {
+        if (is_recording) {
+            start_time = get_trace_time();
+        }
+    }
+    ~scoped_trace()
+    {
+        if (is_recording) {
+            record_trace_event(name, argument_name, argument, start_time, get_trace_time());
+        }
+    }
+};
+
+
+#define TRACE_JOIN_NAMES(name1, name2) name1##name2
+#define TRACE_SCOPE_NAME(line) TRACE_JOIN_NAMES(trace_scope_, line)
+
+#ifdef LCS_INSTRUMENTATION
+#define TRACE_SCOPE(name) scoped_trace TRACE_SCOPE_NAME(__LINE__)(name)
+#define TRACE_SCOPE_ARGUMENT(name, argument_name, argument) \
+    scoped_trace TRACE_SCOPE_NAME(__LINE__)(name, argument_name, (argument))
+#else
+#define TRACE_SCOPE(name) ((void)0)
+#define TRACE_SCOPE_ARGUMENT(name, argument_name, argument) ((void)0)
+#endif
+
+#endif
@@ -0,0 +1,317 @@
+// tree_balancing.cpp (last modified: 18/10/26)
+// Contains definition of all tree_balancer class members not defined in tree_balancing.h
+// each tree is rebuilt as a Huffman tree on the arrival times of its leaves: joining the two
+// earliest signals first gives the least depth possible for two-input gates
+
+#include <iostream>
+#include <vector>
+#include <string>
+#include <queue>
+#include <unordered_set>
+#include <algorithm>
+#include <functional>
+#include <utility>
+#include "tree_balancing.h"
+#include "circuit.h"
+#include "differential_simulation.h"
+#include "bit_matrix.h"
+#include "tracing.h"
+#include "universal_functions.h"
+
+
+// the associative operation a gate applies before any inversion, or the gate's own code if it has none
+static gate_code get_tree_operation(const gate_code& code)
+{
+    switch (code) {
+        case gate_code::nand_gate: return gate_code::and_gate;
+        case gate_code::nor_gate: return gate_code::or_gate;
+        case gate_code::xnor_gate: return gate_code::xor_gate;
+        default: return code;
+    }
+}
+
+static bool is_tree_operation(const gate_code& code)
+{
+    gate_code operation{ get_tree_operation(code) };
+    return operation == gate_code::and_gate || operation == gate_code::or_gate || operation == gate_code::xor_gate;
+}
+
+static std::string get_two_input_gate_type(const gate_code& operation, const bool& is_inverted)
+{
+    switch (operation) {
+        case gate_code::and_gate: return is_inverted ? "NAND" : "AND";
+        case gate_code::or_gate: return is_inverted ? "NOR" : "OR";
+        default: return is_inverted ? "XNOR" : "XOR";
+    }
+}
+
+
+// depth statistics of a circuit given each element's inputs (none for circuit inputs),
+// and an order of its elements in which every element comes after its inputs
+static tree_balancer::depth_statistics get_depth_statistics(const std::vector<std::vector<int>>& element_inputs,
+    const std::vector<int>& topological_order)
+{
+    int number_of_elements{ static_cast<int>(element_inputs.size()) };
+    std::vector<int> arrival_times(number_of_elements, 0);
+    std::vector<int> fanout_counts(number_of_elements, 0);
+    int depth{};
+    for (const int& position : topological_order) {
+        for (const int& input : element_inputs[position]) {
+            arrival_times[position] = std::max(arrival_times[position], arrival_times[input] + 1);
+            fanout_counts[input]++;
+        }
+        depth = std::max(depth, arrival_times[position]);
+    }
+
+    // longest path from each element to an output, worked out from the outputs back
+    std::vector<int> remaining_depths(number_of_elements, 0);
+    for (auto position = topological_order.rbegin(); position != topological_order.rend(); position++) {
+        for (const int& input : element_inputs[*position]) {
+            remaining_depths[input] = std::max(remaining_depths[input], remaining_depths[*position] + 1);
+        }
+    }
+
+    tree_balancer::depth_statistics statistics{ depth, 0, 0 };
+    for (int position{}; position < number_of_elements; position++) {
+        if (arrival_times[position] + remaining_depths[position] == depth) {
+            statistics.critical_elements++;
+            if (fanout_counts[position] == 0) {
+                statistics.critical_outputs++;
+            }
+        }
+    }
+    return statistics;
+}
+
+
+tree_balancer::tree_balancer() : balanced_elements{}, number_of_rebuilt_trees{},
+    source_statistics{ 0, 0, 0 }, balanced_statistics{ 0, 0, 0 } {}
+
+
+// works out the balanced circuit. a gate is absorbed into the tree of the gate it feeds if it is an
+// uninverted AND, OR or XOR gate (of any width) whose only fanout applies the same operation,
+// so that no other element needs its value; the gate at the top of a tree keeps its name and inversion.
+// returns false if the circuit has no gates
+bool tree_balancer::balance(const circuit& source)
+{
+    TRACE_SCOPE("tree_balancing");
+    int number_of_elements{ source.get_circuit_size() };
+    if (number_of_elements == static_cast<int>(source.get_input_positions().size())) {
+        std::cerr << "\nError: the circuit has no gates to balance\n";
+        return false;
+    }
+    balanced_elements.clear();
+    number_of_rebuilt_trees = 0;
+
+    std::vector<int> topological_order(number_of_elements);
+    for (int position{}; position < number_of_elements; position++) {
+        topological_order[position] = position;
+    }
+    std::stable_sort(topological_order.begin(), topological_order.end(), [&source](const int& a, const int& b) {
+        return source.get_element_level(a) < source.get_element_level(b);
+    });
+
+    std::vector<gate_code> gate_codes(number_of_elements);
+    std::vector<std::vector<int>> element_inputs(number_of_elements);
+    std::vector<int> fanout_counts(number_of_elements, 0);
+    std::vector<int> last_fanouts(number_of_elements, -1);
+    for (int position{}; position < number_of_elements; position++) {
+        gate_codes[position] = get_gate_code(source.get_element_gate_type(position));
+        if (gate_codes[position] != gate_code::input) {
+            element_inputs[position] = source.get_element_input_positions(position);
+        }
+        for (const int& input : element_inputs[position]) {
+            fanout_counts[input]++;
+            last_fanouts[input] = position;
+        }
+    }
+    source_statistics = get_depth_statistics(element_inputs, topological_order);
+
+    std::vector<char> is_absorbed(number_of_elements, false);
+    for (int position{}; position < number_of_elements; position++) {
+        is_absorbed[position] = is_tree_operation(gate_codes[position])
+            && get_tree_operation(gate_codes[position]) == gate_codes[position] && fanout_counts[position] == 1
+            && get_tree_operation(gate_codes[last_fanouts[position]]) == gate_codes[position];
+    }
+
+    // balanced positions of the source elements that are kept, and arrival times by balanced position
+    std::vector<int> balanced_positions(number_of_elements, -1);
+    std::vector<int> arrival_times;
+    std::vector<std::vector<int>> balanced_inputs;
+    std::unordered_set<std::string> added_names;
+    auto add_balanced_element = [&](const std::string& name, const std::string& gate_type,
+            const std::vector<int>& input_positions, const bool& input_value) {
+        int arrival_time{};
+        for (const int& input : input_positions) {
+            arrival_time = std::max(arrival_time, arrival_times[input] + 1);
+        }
+        balanced_elements.push_back(balanced_element{ name, gate_type, input_positions, input_value });
+        balanced_inputs.push_back(input_positions);
+        arrival_times.push_back(arrival_time);
+        return static_cast<int>(balanced_elements.size()) - 1;
+    };
+    auto add_source_element = [&](const int& position) {
+        std::vector<int> inputs;
+        for (const int& input : element_inputs[position]) {
+            inputs.push_back(balanced_positions[input]);
+        }
+        balanced_positions[position] = add_balanced_element(source.get_element_name(position),
+            source.get_element_gate_type(position), inputs, source.get_element_output(position));
+    };
+
+    // arrival times absorbed gates would have if their tree were kept as it is
+    std::vector<int> absorbed_arrival_times(number_of_elements, 0);
+    auto get_arrival_time = [&](const int& position) {
+        return is_absorbed[position] ? absorbed_arrival_times[position] : arrival_times[balanced_positions[position]];
+    };
+
+    for (const int& position : topological_order) {
+        bool is_tree_root{ false };
+        int kept_arrival_time{};
+        for (const int& input : element_inputs[position]) {
+            is_tree_root = is_tree_root || is_absorbed[input];
+            kept_arrival_time = std::max(kept_arrival_time, get_arrival_time(input) + 1);
+        }
+        if (is_absorbed[position]) {
+            absorbed_arrival_times[position] = kept_arrival_time;
+            continue;
+        }
+        if (!is_tree_root || !is_tree_operation(gate_codes[position])) {
+            add_source_element(position);
+            continue;
+        }
+
+        // the tree's leaves are the inputs of its gates that are not absorbed gates themselves
+        std::vector<int> leaves;
+        std::vector<int> absorbed_gates;
+        std::vector<int> unvisited{ element_inputs[position] };
+        while (!unvisited.empty()) {
+            int input{ unvisited.back() };
+            unvisited.pop_back();
+            if (is_absorbed[input]) {
+                absorbed_gates.push_back(input);
+                unvisited.insert(unvisited.end(), element_inputs[input].begin(), element_inputs[input].end());
+            }
+            else {
+                leaves.push_back(balanced_positions[input]);
+            }
+        }
+
+        // joins the two earliest signals until one is left; earliest arrival first, then lowest position,
+        // so the result does not depend on the heap. a tree of wide gates can come out deeper than it was,
+        // so it is only rebuilt if that makes it shallower
+        typedef std::pair<int, int> timed_signal;
+        std::priority_queue<timed_signal, std::vector<timed_signal>, std::greater<timed_signal>> signals;
+        for (const int& leaf : leaves) {
+            signals.push(timed_signal{ arrival_times[leaf], leaf });
+        }
+        std::priority_queue<int, std::vector<int>, std::greater<int>> balanced_arrival_times;
+        for (const int& leaf : leaves) {
+            balanced_arrival_times.push(arrival_times[leaf]);
+        }
+        while (balanced_arrival_times.size() > 1) {
+            balanced_arrival_times.pop();
+            int later_arrival_time{ balanced_arrival_times.top() };
+            balanced_arrival_times.pop();
+            balanced_arrival_times.push(later_arrival_time + 1);
+        }
+        if (balanced_arrival_times.top() >= kept_arrival_time) {
+            std::sort(absorbed_gates.begin(), absorbed_gates.end(), [&source](const int& a, const int& b) {
+                return source.get_element_level(a) < source.get_element_level(b);
+            });
+            for (const int& gate : absorbed_gates) {
+                add_source_element(gate);
+            }
+            add_source_element(position);
+            continue;
+        }
+
+        std::string name{ source.get_element_name(position) };
+        gate_code operation{ get_tree_operation(gate_codes[position]) };
+        int number_of_new_gates{ static_cast<int>(leaves.size()) - 1 };
+        for (int gate{}; gate < number_of_new_gates; gate++) {
+            int first_input{ signals.top().second };
+            signals.pop();
+            int second_input{ signals.top().second };
+            signals.pop();
+
+            // the new gates below the top one combine different signals than the gates absorbed,
+            // so they are given new names rather than names that meant something else in the source
+            bool is_root{ gate == number_of_new_gates - 1 };
+            std::string gate_name{ is_root ? name : "" };
+            for (int suffix{ 1 }; gate_name.empty(); suffix++) {
+                std::string new_name{ name + "_" + std::to_string(suffix) };
+                if (source.find_element(new_name) == -1 && added_names.insert(new_name).second) {
+                    gate_name = new_name;
+                }
+            }
+
+            int new_gate{ add_balanced_element(gate_name,
+                get_two_input_gate_type(operation, is_root && operation != gate_codes[position]),
+                std::vector<int>{ first_input, second_input }, false) };
+            signals.push(timed_signal{ arrival_times[new_gate], new_gate });
+        }
+        balanced_positions[position] = signals.top().second;
+        number_of_rebuilt_trees++;
+    }
+
+    std::vector<int> balanced_order(balanced_elements.size());
+    for (size_t i{}; i < balanced_order.size(); i++) {
+        balanced_order[i] = static_cast<int>(i);
+    }
+    balanced_statistics = get_depth_statistics(balanced_inputs, balanced_order);
+    return true;
+}
+
+
+// adds the balanced circuit to target, which should be empty
+void tree_balancer::build_balanced_circuit(circuit& target) const
+{
+    for (size_t i{}; i < balanced_elements.size(); i++) {
+        target.set_element_name(static_cast<int>(i), balanced_elements[i].name);
+    }
+    target.begin_netlist();
+    for (size_t i{}; i < balanced_elements.size(); i++) {
+        const balanced_element& element{ balanced_elements[i] };
+        if (get_gate_code(element.gate_type) == gate_code::input) {
+            target.add_netlist_element(static_cast<int>(i), element.input_value);
+        }
+        else {
+            target.add_netlist_element(static_cast<int>(i), element.gate_type, element.input_positions);
+        }
+    }
+    target.finish_netlist(std::cerr);
+}
+
+
+// checks every output of the balanced circuit against the source circuit; only the rebuilt trees
+// need simulating, as the rest of the balanced circuit matches the source
+bool tree_balancer::verify_balancing(const circuit& source, const circuit& balanced) const
+{
+    differential_simulator differences;
+    if (!differences.match(source, balanced)
+            || !differences.simulate(source, get_comparison_vectors(static_cast<int>(source.get_input_positions().size())))) {
+        return false;
+    }
+    if (!differences.are_outputs_equal()) {
+        std::cerr << "\nError: the balanced circuit differs from the original circuit\n";
+        return false;
+    }
+    return true;
+}
+
+
+int tree_balancer::get_number_of_rebuilt_trees() const
+{
+    return number_of_rebuilt_trees;
+}
+
+const tree_balancer::depth_statistics& tree_balancer::get_source_statistics() const
+{
+    return source_statistics;
+}
+
+const tree_balancer::depth_statistics& tree_balancer::get_balanced_statistics() const
+{
+    return balanced_statistics;
+}
@@ -0,0 +1,56 @@
+// tree_balancing.h (last modified: 18/10/26)
+// header file for the tree_balancer class definition and class member declarations
+// a tree_balancer rebuilds a circuit with less logic depth: a gate whose AND, OR or XOR inputs only
+// feed it (a chain or tree of the same associative gate, such as one entered two inputs at a time)
+// is replaced by a tree of two-input gates that combines the earliest-arriving signals first.
+// every other element is kept as it is, and every element the balanced circuit keeps keeps its name;
+// the top gate of a rebuilt tree keeps the name of the gate it replaces, and the gates below it are named <top>_<n>
+
+#ifndef TREE_BALANCING_H
+#define TREE_BALANCING_H
+
+#include <vector>
+#include <string>
+#include "circuit.h"
+
+
+class tree_balancer
+{
+public:
+    // logic depth of a circuit, and how much of it lies on its longest (critical) paths
+    struct depth_statistics
+    {
+        int depth;                  // levels of gates between the inputs and the deepest output
+        int critical_elements;      // elements on at least one path as long as the depth
+        int critical_outputs;       // outputs at the full depth
+    };
+
+private:
+    // the balanced circuit, in an order where every element comes after its inputs
+    struct balanced_element
+    {
+        std::string name;
+        std::string gate_type;
+        std::vector<int> input_positions;
+        bool input_value;
+    };
+    std::vector<balanced_element> balanced_elements;
+
+    int number_of_rebuilt_trees;
+    depth_statistics source_statistics;
+    depth_statistics balanced_statistics;
+
+public:
+    tree_balancer();
+    ~tree_balancer() {};
+
+    bool balance(const circuit&);
+    void build_balanced_circuit(circuit&) const;
+    bool verify_balancing(const circuit& source, const circuit& balanced) const;
+
+    int get_number_of_rebuilt_trees() const;
+    const depth_statistics& get_source_statistics() const;
+    const depth_statistics& get_balanced_statistics() const;
+};
+
+#endif
@@ -1,13 +1,28 @@
-// universal_functions.cpp (last modified: 03/07/22)
+// universal_functions.cpp (last modified: 18/10/26)
 // definition of functions declared in universal_functions.h
 
 #include <vector>
 #include <iostream>
 #include <cmath>
 #include <string>
+#include <sstream>
+#include <memory>
+#include <algorithm>
+#include <cstdint>
 #include "universal_functions.h"
+#include "module_definition.h"
 
 
+// number of inputs giving a shift cell's shift amount, enough to count up to width - 1
+static int get_shift_amount_bits(const int& width)
+{
+    int bits{ 1 };
+    while ((1 << bits) < width) {
+        bits++;
+    }
+    return bits;
+}
+
 // creates all truth table input value combinations for n inputs
 // (eg. 00, 01, 10, 11 for n = 2)
 // uses a vector for each input, which are all stored in one vector of vectors.
@@ -39,37 +54,106 @@ std::vector<std::vector<bool>> truth_table_inputs_generator(const int& number_of
 }
 
 
+// 64 rows of the truth table column of the input that is the given bit of the row number
+// (bit 0 for the last input), starting at row 64 * word, with one row per bit of the word
+std::uint64_t get_truth_table_input_word(const int& bit, const std::uint64_t& word)
+{
+    // word with bit r set when bit b of r is set
+    const std::uint64_t row_bit_words[]{
+        0xAAAAAAAAAAAAAAAA, 0xCCCCCCCCCCCCCCCC, 0xF0F0F0F0F0F0F0F0,
+        0xFF00FF00FF00FF00, 0xFFFF0000FFFF0000, 0xFFFFFFFF00000000 };
+
+    if (bit < 6) {
+        return row_bit_words[bit];
+    }
+    return ((word >> (bit - 6)) & 1) != 0 ? ~std::uint64_t{ 0 } : 0;
+}
+
+
 // prints columns for each input and output elements of the circuit
 void print_truth_table(const std::vector< std::vector<bool>>& inputs, const std::vector<std::vector<bool>>& outputs)
+{
+    print_truth_table_header(static_cast<int>(inputs.size()), static_cast<int>(outputs.size()));
+
+    std::vector<bool> input_values(inputs.size());
+    std::vector<bool> output_values(outputs.size());
+    for (size_t i{}; i < inputs[0].size(); i++) {
+        for (size_t j{}; j < inputs.size(); j++) {
+            input_values[j] = inputs[j][i];
+        }
+        for (size_t j{}; j < outputs.size(); j++) {
+            output_values[j] = outputs[j][i];
+        }
+        print_truth_table_row(input_values, output_values);
+    }
+}
+
+
+// prints columns for each input and output like print_truth_table, showing x and z values
+void print_four_valued_truth_table(const std::vector<std::vector<logic_value>>& inputs,
+    const std::vector<std::vector<logic_value>>& outputs)
+{
+    print_truth_table_header(static_cast<int>(inputs.size()), static_cast<int>(outputs.size()));
+
+    std::vector<logic_value> input_values(inputs.size());
+    std::vector<logic_value> output_values(outputs.size());
+    for (size_t i{}; i < inputs[0].size(); i++) {
+        for (size_t j{}; j < inputs.size(); j++) {
+            input_values[j] = inputs[j][i];
+        }
+        for (size_t j{}; j < outputs.size(); j++) {
+            output_values[j] = outputs[j][i];
+        }
+        print_four_valued_truth_table_row(input_values, output_values);
+    }
+}
+
+
+// the numbered column headings and the line under them
+// split out of the printing functions, so tables too large to hold in memory can be printed row by row
+void print_truth_table_header(const int& number_of_inputs, const int& number_of_outputs)
 {
     using namespace std;
-    for (int i{}; i < inputs.size(); i++) {
+    for (int i{}; i < number_of_inputs; i++) {
         cout << "Input " << i + 1 << "|";
     }
 
-    for (int i{}; i < outputs.size(); i++) {
+    for (int i{}; i < number_of_outputs; i++) {
         cout << "Output " << i + 1 << "|";
     }
     cout << "\n";
 
-    for (int i{}; i < inputs.size(); i++) {
+    for (int i{}; i < number_of_inputs; i++) {
         cout << "-------|";
     }
 
-    for (int i{}; i < outputs.size(); i++) {
+    for (int i{}; i < number_of_outputs; i++) {
         cout << "--------|";
     }
     cout << "\n";
+}
 
-    for (int i{}; i < inputs[0].size(); i++) {
-        for (int j{}; j < inputs.size(); j++) {
-            cout << "   " << inputs[j][i] << "   |";
-        }
-        for (int j{}; j < outputs.size(); j++) {
-            cout << "    " << outputs[j][i] << "   |";
-        }
-        cout << "\n";
+void print_truth_table_row(const std::vector<bool>& input_values, const std::vector<bool>& output_values)
+{
+    for (const bool& value : input_values) {
+        std::cout << "   " << value << "   |";
+    }
+    for (const bool& value : output_values) {
+        std::cout << "    " << value << "   |";
+    }
+    std::cout << "\n";
+}
+
+void print_four_valued_truth_table_row(const std::vector<logic_value>& input_values,
+    const std::vector<logic_value>& output_values)
+{
+    for (const logic_value& value : input_values) {
+        std::cout << "   " << get_logic_value_symbol(value) << "   |";
     }
+    for (const logic_value& value : output_values) {
+        std::cout << "    " << get_logic_value_symbol(value) << "   |";
+    }
+    std::cout << "\n";
 }
 
 
@@ -89,31 +173,47 @@ std::string get_element_letter(const int& element_position)
 }
 
 
-// gets element type (input, unary or binary) for various formats of gate_type
+// names of the built-in gate types that are not sized or look-up table types
+static const std::vector<std::string> input_element_names{ "input","Input" };
+static const std::vector<std::string> unary_element_names{ "not", "NOT", "buffer", "BUFFER" };
+static const std::vector<std::string> binary_element_names{
+    "and","AND","or","OR","nand","NAND","nor","NOR","xor","XOR","xnor","XNOR" };
+
+static bool is_name_in(const std::vector<std::string>& names, const std::string& gate_type)
+{
+    return std::find(names.begin(), names.end(), gate_type) != names.end();
+}
+
+
+// gets element type (input, unary, binary, lut, wide, bus, bit or module) for various formats of gate_type
+// gate types that are not built in are looked up as modules, in the module libraries in scope
 std::string get_element_type(const std::string& gate_type)
 {
-    std::vector<std::string> input_element_names{ "input","Input" };
-    std::vector<std::string> unary_element_names{ "not", "NOT", "buffer", "BUFFER" };
-    std::vector<std::string> binary_element_names{
-        "and","AND","or","OR","nand","NAND","nor","NOR","xor","XOR","xnor","XNOR" };
+    int lut_inputs{};
+    std::uint64_t lut_mask{};
+    if (parse_lut_gate_type(gate_type, lut_inputs, lut_mask)) {
+        return "lut";
+    }
 
-    auto check_names = [&gate_type](std::vector<std::string> names)
-    {
-        for (const std::string& name : names) {
-            if (name == gate_type) {
-                return true;
-            }
+    std::string base_type;
+    int size{};
+    if (parse_sized_gate_type(gate_type, base_type, size)) {
+        if (base_type == "BIT") {
+            return "bit";
         }
-        return false;
-    };
+        return (base_type == "ADD" || base_type == "CMP" || base_type == "MUX"
+            || base_type == "SHL" || base_type == "SHR") ? "bus" : "wide";
+    }
 
     try {
-        if (check_names(input_element_names)) {
+        if (is_name_in(input_element_names, gate_type)) {
             return "input";
-        } else if (check_names(unary_element_names)) {
+        } else if (is_name_in(unary_element_names, gate_type)) {
             return "unary";
-        } else if (check_names(binary_element_names)) {
+        } else if (is_name_in(binary_element_names, gate_type)) {
             return "binary";
+        } else if (find_module(gate_type)) {
+            return "module";
         } else {
             throw - 1;
         }
@@ -130,47 +230,545 @@ std::string get_element_type(const std::string& gate_type)
 }
 
 
+// whether a name is a built-in gate type in any spelling get_element_type accepts,
+// so cannot be given to a module
+bool is_builtin_gate_type(const std::string& gate_type)
+{
+    int lut_inputs{};
+    std::uint64_t lut_mask{};
+    std::string base_type;
+    int size{};
+
+    return parse_lut_gate_type(gate_type, lut_inputs, lut_mask) || parse_sized_gate_type(gate_type, base_type, size)
+        || is_name_in(input_element_names, gate_type) || is_name_in(unary_element_names, gate_type)
+        || is_name_in(binary_element_names, gate_type);
+}
+
+
+// whether elements of a gate type have more than one output, packed into their output word
+// and shown in a circuit by bit selects: bus cells and module instances
+bool is_multi_output_type(const std::string& gate_type)
+{
+    std::string element_type{ get_element_type(gate_type) };
+    return element_type == "bus" || element_type == "module";
+}
+
+
+// checks a gate type without exiting on unknown ones, as get_element_type would
+// bit selects are left out, since netlists name bus cell outputs rather than listing them
+bool is_gate_type(const std::string& gate_type)
+{
+    int lut_inputs{};
+    std::uint64_t lut_mask{};
+    std::string base_type;
+    int size{};
+
+    if (parse_lut_gate_type(gate_type, lut_inputs, lut_mask)) {
+        return true;
+    }
+    if (parse_sized_gate_type(gate_type, base_type, size)) {
+        return base_type != "BIT";
+    }
+
+    const std::vector<std::string> gate_names{ "NOT","BUFFER","AND","OR","NAND","NOR","XOR","XNOR" };
+    for (const std::string& gate_name : gate_names) {
+        if (gate_type == gate_name) {
+            return true;
+        }
+    }
+    return find_module(gate_type) != nullptr;
+}
+
+
 // handles all available logic operations, specified by gate_type
+// the gate type is classified once, by get_gate_code, which exits on types that do not exist
 bool logic_operation(const std::string gate_type, const std::vector<bool>& input_values)
 {
-    using namespace std;
+    gate_code code{ get_gate_code(gate_type) };
+
+    switch (code) {
+        case gate_code::lut: {
+            // the first input is the most significant bit of the truth table row,
+            // as in truth_table_inputs_generator
+            int lut_inputs{};
+            std::uint64_t lut_mask{};
+            parse_lut_gate_type(gate_type, lut_inputs, lut_mask);
+            int row{};
+            for (int i{}; i < lut_inputs; i++) {
+                row = (row << 1) | (input_values[i] ? 1 : 0);
+            }
+            return ((lut_mask >> row) & 1) != 0;
+        }
+        case gate_code::add_cell:
+        case gate_code::compare_cell:
+        case gate_code::mux_cell:
+        case gate_code::shift_left_cell:
+        case gate_code::shift_right_cell:
+            return (bus_cell_operation(gate_type, input_values) & 1) != 0;
+        case gate_code::module_instance:
+            return (module_operation(gate_type, input_values) & 1) != 0;
+        case gate_code::not_gate:
+            return !input_values[0];
+        case gate_code::buffer_gate:
+            return input_values[0];
+        case gate_code::and_gate:
+        case gate_code::or_gate:
+        case gate_code::nand_gate:
+        case gate_code::nor_gate:
+        case gate_code::xor_gate:
+        case gate_code::xnor_gate: {
+            // and/or/xor of every input (two for binary gates), inverted for nand/nor/xnor
+            bool result{ input_values[0] };
+            for (std::size_t i{ 1 }; i < input_values.size(); i++) {
+                if (code == gate_code::and_gate || code == gate_code::nand_gate) {
+                    result = result && input_values[i];
+                }
+                else if (code == gate_code::or_gate || code == gate_code::nor_gate) {
+                    result = result || input_values[i];
+                }
+                else {
+                    result = result != input_values[i];
+                }
+            }
+            bool is_inverted{ code == gate_code::nand_gate || code == gate_code::nor_gate || code == gate_code::xnor_gate };
+            return result != is_inverted;
+        }
+        default:
+            std::cerr << "\nError: element type does not exist\n";
+            exit(-1);
+    }
+}
+
+
+// converts a gate_type string into its gate_code
+// accepts the same names as get_element_type
+gate_code get_gate_code(const std::string& gate_type)
+{
+    int lut_inputs{};
+    std::uint64_t lut_mask{};
+
     try {
-        if (gate_type == "NOT") {
-            return input_values[0] ? false : true;
-        } 
-        else if (gate_type == "BUFFER") {
-            return input_values[0] ? true : false;
-        } 
-        else if (gate_type == "AND") {
-            return (input_values[0] && input_values[1]) ? true : false;
-        } 
-        else if (gate_type == "OR") {
-            return (input_values[0] || input_values[1]) ? true : false;
-        } 
-        else if (gate_type == "NAND") {
-            return (input_values[0] && input_values[1]) ? false : true;
-        } 
-        else if (gate_type == "NOR") {
-            return (input_values[0] || input_values[1]) ? false : true;
-        } 
-        else if (gate_type == "XOR") {
-            return ((input_values[0] || input_values[1]) && (input_values[0] != input_values[1])) ? true : false;
-        } 
-        else if (gate_type == "XNOR") {
-            return (input_values[0] == input_values[1]) ? true : false;
-        } 
+        std::string base_type;
+        int size{};
+
+        if (parse_lut_gate_type(gate_type, lut_inputs, lut_mask)) {
+            return gate_code::lut;
+        }
+        else if (parse_sized_gate_type(gate_type, base_type, size)) {
+            if (base_type == "BIT") {
+                return gate_code::bit_select;
+            }
+            else if (base_type == "ADD") {
+                return gate_code::add_cell;
+            }
+            else if (base_type == "CMP") {
+                return gate_code::compare_cell;
+            }
+            else if (base_type == "MUX") {
+                return gate_code::mux_cell;
+            }
+            else if (base_type == "SHL") {
+                return gate_code::shift_left_cell;
+            }
+            else if (base_type == "SHR") {
+                return gate_code::shift_right_cell;
+            }
+            return get_gate_code(base_type);
+        }
+        else if (gate_type == "Input" || gate_type == "input") {
+            return gate_code::input;
+        }
+        else if (gate_type == "NOT" || gate_type == "not") {
+            return gate_code::not_gate;
+        }
+        else if (gate_type == "BUFFER" || gate_type == "buffer") {
+            return gate_code::buffer_gate;
+        }
+        else if (gate_type == "AND" || gate_type == "and") {
+            return gate_code::and_gate;
+        }
+        else if (gate_type == "OR" || gate_type == "or") {
+            return gate_code::or_gate;
+        }
+        else if (gate_type == "NAND" || gate_type == "nand") {
+            return gate_code::nand_gate;
+        }
+        else if (gate_type == "NOR" || gate_type == "nor") {
+            return gate_code::nor_gate;
+        }
+        else if (gate_type == "XOR" || gate_type == "xor") {
+            return gate_code::xor_gate;
+        }
+        else if (gate_type == "XNOR" || gate_type == "xnor") {
+            return gate_code::xnor_gate;
+        }
+        else if (find_module(gate_type)) {
+            return gate_code::module_instance;
+        }
         else {
             throw - 1;
         }
     }
-
     catch (int error) {
         if (error == -1) {
             std::cerr << "\nError: element type does not exist\n";
             exit(error);
         }
     }
-    return 0;
-// try-catch statement means program will exit if gate_type does not exist,
-// instead of returning 0 for the logic operation
-}
\ No newline at end of file
+    return gate_code::input;
+}
+
+
+// handles all available logic operations for four-valued inputs
+// an output is only 0 or 1 if it is the same for every possible value of the unknown inputs
+logic_value four_valued_logic_operation(const std::string gate_type, const std::vector<logic_value>& input_values)
+{
+    std::vector<logic_value> inputs;
+    for (const logic_value& value : input_values) {
+        inputs.push_back(value == logic_value::z ? logic_value::x : value);
+    }
+
+    auto invert = [](const logic_value& value) {
+        if (value == logic_value::x) {
+            return logic_value::x;
+        }
+        return value == logic_value::one ? logic_value::zero : logic_value::one;
+    };
+
+    // result of and/or: the controlling value wins, otherwise any unknown input makes it unknown
+    auto controlled = [&inputs](const logic_value& controlling_value) {
+        logic_value result{ controlling_value == logic_value::zero ? logic_value::one : logic_value::zero };
+        for (const logic_value& value : inputs) {
+            if (value == controlling_value) {
+                return controlling_value;
+            }
+            if (value == logic_value::x) {
+                result = logic_value::x;
+            }
+        }
+        return result;
+    };
+
+    auto exclusive_or = [&inputs]() {
+        bool result{ false };
+        for (const logic_value& value : inputs) {
+            if (value == logic_value::x) {
+                return logic_value::x;
+            }
+            result = result != (value == logic_value::one);
+        }
+        return result ? logic_value::one : logic_value::zero;
+    };
+
+    // a lut output is known if every row the unknown inputs could select gives the same value
+    auto look_up = [&inputs, &gate_type]() {
+        int lut_inputs{};
+        std::uint64_t lut_mask{};
+        parse_lut_gate_type(gate_type, lut_inputs, lut_mask);
+
+        bool could_be_zero{ false };
+        bool could_be_one{ false };
+        for (int row{}; row < (1 << lut_inputs); row++) {
+            bool is_possible_row{ true };
+            for (int i{}; i < lut_inputs; i++) {
+                bool row_value{ ((row >> (lut_inputs - 1 - i)) & 1) != 0 };
+                if (inputs[i] == (row_value ? logic_value::zero : logic_value::one)) {
+                    is_possible_row = false;
+                }
+            }
+            if (is_possible_row) {
+                could_be_one = could_be_one || ((lut_mask >> row) & 1) != 0;
+                could_be_zero = could_be_zero || ((lut_mask >> row) & 1) == 0;
+            }
+        }
+        return (could_be_zero && could_be_one) ? logic_value::x : (could_be_one ? logic_value::one : logic_value::zero);
+    };
+
+    // a bus cell's output is only known if all of its inputs are
+    auto bus_cell = [&inputs, &gate_type]() {
+        std::vector<bool> known_inputs;
+        for (const logic_value& value : inputs) {
+            if (value == logic_value::x) {
+                return logic_value::x;
+            }
+            known_inputs.push_back(value == logic_value::one);
+        }
+        return (bus_cell_operation(gate_type, known_inputs) & 1) ? logic_value::one : logic_value::zero;
+    };
+
+    // a module's output is found by evaluating its body on one dual-rail pattern
+    auto module_instance = [&inputs, &gate_type]() {
+        std::shared_ptr<const module_definition> definition{ find_module(gate_type) };
+        std::vector<std::uint64_t> inputs_can_be_zero;
+        std::vector<std::uint64_t> inputs_can_be_one;
+        for (const logic_value& value : inputs) {
+            inputs_can_be_zero.push_back(value != logic_value::one ? 1 : 0);
+            inputs_can_be_one.push_back(value != logic_value::zero ? 1 : 0);
+        }
+        std::vector<std::uint64_t> outputs_can_be_zero(definition->get_number_of_outputs());
+        std::vector<std::uint64_t> outputs_can_be_one(definition->get_number_of_outputs());
+        std::vector<std::uint64_t> body_can_be_zero;
+        std::vector<std::uint64_t> body_can_be_one;
+        definition->evaluate_dual_rail(inputs_can_be_zero.data(), inputs_can_be_one.data(),
+            outputs_can_be_zero.data(), outputs_can_be_one.data(), body_can_be_zero, body_can_be_one);
+
+        if ((outputs_can_be_zero[0] & outputs_can_be_one[0] & 1) != 0) {
+            return logic_value::x;
+        }
+        return (outputs_can_be_one[0] & 1) ? logic_value::one : logic_value::zero;
+    };
+
+    switch (get_gate_code(gate_type)) {
+        case gate_code::lut:
+            return look_up();
+        case gate_code::add_cell:
+        case gate_code::compare_cell:
+        case gate_code::mux_cell:
+        case gate_code::shift_left_cell:
+        case gate_code::shift_right_cell:
+            return bus_cell();
+        case gate_code::module_instance:
+            return module_instance();
+        case gate_code::not_gate:
+            return invert(inputs[0]);
+        case gate_code::buffer_gate:
+            return inputs[0];
+        case gate_code::and_gate:
+            return controlled(logic_value::zero);
+        case gate_code::or_gate:
+            return controlled(logic_value::one);
+        case gate_code::nand_gate:
+            return invert(controlled(logic_value::zero));
+        case gate_code::nor_gate:
+            return invert(controlled(logic_value::one));
+        case gate_code::xor_gate:
+            return exclusive_or();
+        case gate_code::xnor_gate:
+            return invert(exclusive_or());
+        default:
+            return input_values[0];
+    }
+}
+
+
+// character used to show a logic_value in tables and formulae
+char get_logic_value_symbol(const logic_value& value)
+{
+    switch (value) {
+        case logic_value::zero:
+            return '0';
+        case logic_value::one:
+            return '1';
+        case logic_value::x:
+            return 'X';
+        default:
+            return 'Z';
+    }
+}
+
+
+// number of inputs an element of this gate type takes
+int get_number_of_gate_inputs(const std::string& gate_type)
+{
+    std::string element_type{ get_element_type(gate_type) };
+
+    if (element_type == "lut") {
+        int lut_inputs{};
+        std::uint64_t lut_mask{};
+        parse_lut_gate_type(gate_type, lut_inputs, lut_mask);
+        return lut_inputs;
+    }
+    if (element_type == "wide" || element_type == "bus") {
+        std::string base_type;
+        int size{};
+        parse_sized_gate_type(gate_type, base_type, size);
+
+        if (element_type == "wide") {
+            return size;
+        }
+        if (base_type == "MUX") {
+            return 2 * size + 1;
+        }
+        return (base_type == "SHL" || base_type == "SHR") ? size + get_shift_amount_bits(size) : 2 * size;
+    }
+    if (element_type == "bit") {
+        return 1;
+    }
+    if (element_type == "module") {
+        return find_module(gate_type)->get_number_of_inputs();
+    }
+    return element_type == "input" ? 0 : (element_type == "unary" ? 1 : 2);
+}
+
+
+// user-defined gates store their truth table in their gate_type, eg. "LUT3:e8" for a 3-input majority gate
+// the bits of a look-up table mask that hold a truth table row, one per row
+static std::uint64_t get_lut_mask_bits(const int& number_of_inputs)
+{
+    return number_of_inputs == maximum_lut_inputs ? ~std::uint64_t{ 0 } : (std::uint64_t{ 1 } << (1 << number_of_inputs)) - 1;
+}
+
+// bit r of the mask is the output for truth table row r (rows ordered as in truth_table_inputs_generator)
+std::string make_lut_gate_type(const int& number_of_inputs, const std::uint64_t& truth_table_mask)
+{
+    std::stringstream gate_type;
+    gate_type << "LUT" << number_of_inputs << ":" << std::hex << (truth_table_mask & get_lut_mask_bits(number_of_inputs));
+    return gate_type.str();
+}
+
+// reads the number of inputs and truth table back out of a user-defined gate_type
+// returns false for any other gate_type, including masks with bits set beyond the last truth table row
+bool parse_lut_gate_type(const std::string& gate_type, int& number_of_inputs, std::uint64_t& truth_table_mask)
+{
+    if (gate_type.size() < 6 || gate_type.compare(0, 3, "LUT") != 0 || gate_type[4] != ':'
+        || gate_type[3] < '1' || gate_type[3] > '0' + maximum_lut_inputs) {
+        return false;
+    }
+    std::string mask_digits{ gate_type.substr(5) };
+    if (mask_digits.size() > 16 || mask_digits.find_first_not_of("0123456789abcdef") != std::string::npos) {
+        return false;
+    }
+
+    int lut_inputs{ gate_type[3] - '0' };
+    std::uint64_t mask{ std::stoull(mask_digits, nullptr, 16) };
+    if ((mask & ~get_lut_mask_bits(lut_inputs)) != 0) {
+        return false;
+    }
+    number_of_inputs = lut_inputs;
+    truth_table_mask = mask;
+    return true;
+}
+
+
+// splits gate types such as AND8 or ADD16 into their base type and size
+// returns false unless the base type is a wide gate, a bus cell or a bit select, and the size suits it:
+// wide gates (AND, OR, NAND, NOR, XOR, XNOR) have 2 to maximum_wide_gate_inputs inputs,
+// bus cells (ADD, CMP, MUX, SHL, SHR) have operands 1 to maximum_bus_width bits wide,
+// and bit selects (BIT) pick one of the 64 bits of a bus cell's output
+bool parse_sized_gate_type(const std::string& gate_type, std::string& base_type, int& size)
+{
+    size_t digits_start{ gate_type.find_first_of("0123456789") };
+    if (digits_start == std::string::npos || digits_start == 0 || gate_type.size() - digits_start > 2
+        || gate_type.find_first_not_of("0123456789", digits_start) != std::string::npos
+        || (gate_type[digits_start] == '0' && gate_type.size() - digits_start > 1)) {
+        return false;
+    }
+
+    std::string base{ gate_type.substr(0, digits_start) };
+    int number{ std::stoi(gate_type.substr(digits_start)) };
+    bool is_valid{ false };
+
+    if (base == "AND" || base == "OR" || base == "NAND" || base == "NOR" || base == "XOR" || base == "XNOR") {
+        is_valid = number >= 2 && number <= maximum_wide_gate_inputs;
+    }
+    else if (base == "ADD" || base == "CMP" || base == "MUX" || base == "SHL" || base == "SHR") {
+        is_valid = number >= 1 && number <= maximum_bus_width;
+    }
+    else if (base == "BIT") {
+        is_valid = number < 64;
+    }
+
+    if (is_valid) {
+        base_type = base;
+        size = number;
+    }
+    return is_valid;
+}
+
+
+// number of output bits of a bus cell (sum and carry, equal/less/greater flags, or the selected
+// or shifted operand) or module instance; every other element has one output
+int get_number_of_gate_outputs(const std::string& gate_type)
+{
+    std::string element_type{ get_element_type(gate_type) };
+    if (element_type == "module") {
+        return find_module(gate_type)->get_number_of_outputs();
+    }
+    if (element_type != "bus") {
+        return 1;
+    }
+
+    std::string base_type;
+    int size{};
+    parse_sized_gate_type(gate_type, base_type, size);
+
+    if (base_type == "ADD") {
+        return size + 1;
+    }
+    return base_type == "CMP" ? 3 : size;
+}
+
+
+// evaluates a bus cell on whole machine words, bit i of the result being output i:
+// ADD gives operand1 + operand2 with the carry as the top bit, CMP gives (equal, less, greater),
+// MUX gives operand2 if select is 1 and operand1 otherwise, and SHL/SHR shift operand1 by operand2
+std::uint64_t bus_cell_operation(const gate_code& code, const int& width,
+    const std::uint64_t& operand1, const std::uint64_t& operand2, const std::uint64_t& select)
+{
+    std::uint64_t width_mask{ (std::uint64_t{ 1 } << width) - 1 };
+
+    switch (code) {
+        case gate_code::add_cell:
+            return (operand1 + operand2) & ((width_mask << 1) | 1);
+        case gate_code::compare_cell:
+            return (operand1 == operand2 ? 1 : 0) | (operand1 < operand2 ? 2 : 0) | (operand1 > operand2 ? 4 : 0);
+        case gate_code::mux_cell:
+            return (select & 1) ? operand2 : operand1;
+        case gate_code::shift_left_cell:
+            return operand2 >= static_cast<std::uint64_t>(width) ? 0 : (operand1 << operand2) & width_mask;
+        case gate_code::shift_right_cell:
+            return operand2 >= static_cast<std::uint64_t>(width) ? 0 : operand1 >> operand2;
+        default:
+            return 0;
+    }
+}
+
+// packs a bus cell's inputs into operands, least significant bit first:
+// the first width inputs are operand1, up to width more are operand2, and any left is the select
+std::uint64_t bus_cell_operation(const std::string& gate_type, const std::vector<bool>& input_values)
+{
+    std::string base_type;
+    int width{};
+    parse_sized_gate_type(gate_type, base_type, width);
+
+    std::uint64_t operands[3]{};
+    for (size_t i{}; i < input_values.size(); i++) {
+        int operand{ std::min(static_cast<int>(i) / width, 2) };
+        int bit{ static_cast<int>(i) - operand * width };
+        operands[operand] |= static_cast<std::uint64_t>(input_values[i] ? 1 : 0) << bit;
+    }
+    return bus_cell_operation(get_gate_code(gate_type), width, operands[0], operands[1], operands[2]);
+}
+
+
+// evaluates a module instance with its inputs packed into a word, first input as bit 0
+// bit k of the result is output k
+std::uint64_t module_operation(const std::string& gate_type, const std::vector<bool>& input_values)
+{
+    std::uint64_t input_word{};
+    for (size_t i{}; i < input_values.size(); i++) {
+        input_word |= static_cast<std::uint64_t>(input_values[i] ? 1 : 0) << i;
+    }
+    return find_module(gate_type)->evaluate(input_word);
+}
+
+
+// writes a string as a JSON string literal
+std::string get_json_string(const std::string& text)
+{
+    std::stringstream json_string;
+    json_string << "\"";
+    for (const char& character : text) {
+        if (character == '"' || character == '\\') {
+            json_string << "\\" << character;
+        }
+        else if (static_cast<unsigned char>(character) < 0x20) {
+            json_string << "\\u00" << "0123456789abcdef"[character >> 4] << "0123456789abcdef"[character & 15];
+        }
+        else {
+            json_string << character;
+        }
+    }
+    json_string << "\"";
+    return json_string.str();
+}
@@ -1,4 +1,4 @@
-// universal_functions.h (last modified: 02/07/22)
+// universal_functions.h (last modified: 18/10/26)
 // header file for declaration of functions and a constant needed in several parts of the program
 
 #ifndef UNIVERSAL_FUNCTIONS_H
@@ -6,21 +6,92 @@
 
 #include <vector>
 #include <string>
+#include <cstdint>
 
 
 // definition of constants
 const std::string alphabet{ "abcdefghijklmnopqrstuwvxyz" };
 
+// largest number of inputs of a user-defined (look-up table) gate, so its truth table fits in 64 bits
+const int maximum_lut_inputs{ 6 };
+
+// largest number of inputs of a wide (N-input) and/or/xor gate, and widest operand of a bus cell,
+// so a bus cell's inputs and outputs each fit in a 64-bit word
+const int maximum_wide_gate_inputs{ 64 };
+const int maximum_bus_width{ 32 };
+
+
+// compact identifiers for gate types, used by the compiled evaluation routines
+// instead of comparing gate_type strings for every evaluated element
+enum class gate_code : unsigned char
+{
+    input, not_gate, buffer_gate, and_gate, or_gate, nand_gate, nor_gate, xor_gate, xnor_gate, lut,
+    add_cell, compare_cell, mux_cell, shift_left_cell, shift_right_cell, bit_select, module_instance,
+    bus_output  // an extra output of a bus cell or module instance in an evaluation_plan, written by the cell itself
+};
+
+
+// values used by four-valued simulation
+// x is an unknown value (eg. an uninitialised input), z is an undriven net
+// gates treat a z input as unknown, so gate outputs are only ever 0, 1 or x
+enum class logic_value : unsigned char
+{
+    zero, one, x, z
+};
+
 
 // declaration of functions
 std::vector<std::vector<bool>> truth_table_inputs_generator(const int& number_of_inputs);
 
+std::uint64_t get_truth_table_input_word(const int& bit, const std::uint64_t& word);
+
 void print_truth_table(const std::vector< std::vector<bool>>&, const std::vector<std::vector<bool>>&);
 
+void print_four_valued_truth_table(const std::vector<std::vector<logic_value>>&,
+    const std::vector<std::vector<logic_value>>&);
+
+void print_truth_table_header(const int& number_of_inputs, const int& number_of_outputs);
+
+void print_truth_table_row(const std::vector<bool>& input_values, const std::vector<bool>& output_values);
+
+void print_four_valued_truth_table_row(const std::vector<logic_value>& input_values,
+    const std::vector<logic_value>& output_values);
+
 std::string get_element_letter(const int&);
 
 std::string get_element_type(const std::string&);
 
+bool is_gate_type(const std::string& gate_type);
+
+bool is_builtin_gate_type(const std::string& gate_type);
+
+bool is_multi_output_type(const std::string& gate_type);
+
 bool logic_operation(const std::string gate_type, const std::vector<bool>& input_values);
 
+gate_code get_gate_code(const std::string& gate_type);
+
+int get_number_of_gate_inputs(const std::string& gate_type);
+
+std::string make_lut_gate_type(const int& number_of_inputs, const std::uint64_t& truth_table_mask);
+
+bool parse_lut_gate_type(const std::string& gate_type, int& number_of_inputs, std::uint64_t& truth_table_mask);
+
+bool parse_sized_gate_type(const std::string& gate_type, std::string& base_type, int& size);
+
+int get_number_of_gate_outputs(const std::string& gate_type);
+
+std::uint64_t bus_cell_operation(const gate_code& code, const int& width,
+    const std::uint64_t& operand1, const std::uint64_t& operand2, const std::uint64_t& select);
+
+std::uint64_t bus_cell_operation(const std::string& gate_type, const std::vector<bool>& input_values);
+
+std::uint64_t module_operation(const std::string& gate_type, const std::vector<bool>& input_values);
+
+logic_value four_valued_logic_operation(const std::string gate_type, const std::vector<logic_value>& input_values);
+
+char get_logic_value_symbol(const logic_value& value);
+
+std::string get_json_string(const std::string& text);
+
 #endif
\ No newline at end of file
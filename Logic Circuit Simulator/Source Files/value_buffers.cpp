@@ -0,0 +1,270 @@
+// value_buffers.cpp (last modified: 18/10/26)
+// Contains definition of all value_buffers and value_reader class members
+
+#include <iostream>
+#include <vector>
+#include <memory>
+#include <atomic>
+#include <functional>
+#include <algorithm>
+#include <cstdint>
+#include <cstddef>
+#include "value_buffers.h"
+#include "circuit.h"
+#include "memory_usage.h"
+
+
+value_buffers::value_buffers() : reader_slots{}, number_of_readers{ 0 }, global_epoch{ 1 }, current_values{ nullptr },
+    all_buffers{}, retired_buffers{}, free_buffers{}, changed_positions{}, are_all_changed{ true },
+    is_publishing{ false }, next_version{ 1 }
+{
+    for (reader_slot& slot : reader_slots) {
+        slot.pinned_epoch.store(0);
+        slot.is_used.store(false);
+    }
+}
+
+value_buffers::~value_buffers() {}
+
+
+bool value_buffers::is_recording() const
+{
+    return is_publishing;
+}
+
+void value_buffers::record_change(const int& position)
+{
+    if (is_publishing && !are_all_changed) {
+        changed_positions.push_back(position);
+    }
+}
+
+// for changes to many elements at once (eg. whole-circuit evaluation): the next publish copies every value
+void value_buffers::mark_all_changed()
+{
+    are_all_changed = true;
+    changed_positions.clear();
+}
+
+
+// copies the values changed since the last publish into a spare buffer, then makes it the one readers see
+// while no reader exists nothing is copied, and the next publish after one appears copies every value
+void value_buffers::publish(const int& number_of_values, const std::function<bool(const int&)>& get_value)
+{
+    if (number_of_readers.load() == 0) {
+        if (is_publishing) {
+            retire_values(current_values.exchange(nullptr));
+            is_publishing = false;
+        }
+        mark_all_changed();
+        return;
+    }
+    if (!is_publishing) {
+        is_publishing = true;
+        mark_all_changed();
+    }
+    published_values* published{ current_values.load() };
+    if (!are_all_changed && changed_positions.empty() && published != nullptr
+            && published->number_of_values == number_of_values) {
+        return;
+    }
+
+    // every buffer must catch up with these changes before it is next written;
+    // one that has fallen too far behind is copied in full instead
+    std::size_t maximum_stale_positions{ std::max<std::size_t>(number_of_values / 8, 64) };
+    for (const auto& buffer : all_buffers) {
+        if (buffer->needs_full_copy) {
+            continue;
+        }
+        if (are_all_changed || buffer->number_of_values != number_of_values
+                || buffer->stale_positions.size() + changed_positions.size() > maximum_stale_positions) {
+            buffer->needs_full_copy = true;
+            buffer->stale_positions.clear();
+        }
+        else {
+            buffer->stale_positions.insert(buffer->stale_positions.end(), changed_positions.begin(), changed_positions.end());
+        }
+    }
+    changed_positions.clear();
+    are_all_changed = false;
+
+    published_values* buffer{ get_spare_buffer() };
+    if (buffer->needs_full_copy) {
+        buffer->words.assign((number_of_values + 63) / 64, 0);
+        buffer->number_of_values = number_of_values;
+        for (int position{}; position < number_of_values; position++) {
+            if (get_value(position)) {
+                buffer->words[position / 64] |= std::uint64_t{ 1 } << (position % 64);
+            }
+        }
+    }
+    else {
+        for (const int& position : buffer->stale_positions) {
+            std::uint64_t bit{ std::uint64_t{ 1 } << (position % 64) };
+            buffer->words[position / 64] = get_value(position) ? (buffer->words[position / 64] | bit)
+                : (buffer->words[position / 64] & ~bit);
+        }
+    }
+    buffer->stale_positions.clear();
+    buffer->needs_full_copy = false;
+    buffer->version = next_version++;
+
+    retire_values(current_values.exchange(buffer));
+}
+
+
+// keeps values that have just been replaced until no reader can still be using them
+void value_buffers::retire_values(published_values* replaced)
+{
+    if (replaced == nullptr) {
+        return;
+    }
+    // readers pinned at this epoch or later took their snapshot after the values were replaced
+    replaced->retired_epoch = global_epoch.fetch_add(1) + 1;
+    retired_buffers.push_back(replaced);
+}
+
+// moves retired buffers that no reader can still be using to the free list
+void value_buffers::reclaim_buffers()
+{
+    std::uint64_t oldest_pinned_epoch{ UINT64_MAX };
+    for (const reader_slot& slot : reader_slots) {
+        std::uint64_t epoch{ slot.pinned_epoch.load() };
+        if (epoch != 0) {
+            oldest_pinned_epoch = std::min(oldest_pinned_epoch, epoch);
+        }
+    }
+
+    auto is_reclaimable = [oldest_pinned_epoch](const published_values* buffer) {
+        return oldest_pinned_epoch >= buffer->retired_epoch;
+    };
+    for (published_values* buffer : retired_buffers) {
+        if (is_reclaimable(buffer)) {
+            free_buffers.push_back(buffer);
+        }
+    }
+    retired_buffers.erase(std::remove_if(retired_buffers.begin(), retired_buffers.end(), is_reclaimable),
+        retired_buffers.end());
+}
+
+// a buffer no reader is using; a new one is made rather than waiting for readers to let one go
+value_buffers::published_values* value_buffers::get_spare_buffer()
+{
+    if (free_buffers.empty()) {
+        reclaim_buffers();
+    }
+    if (free_buffers.empty()) {
+        all_buffers.emplace_back(new published_values{ {}, 0, 0, 0, {}, true });
+        return all_buffers.back().get();
+    }
+    published_values* buffer{ free_buffers.back() };
+    free_buffers.pop_back();
+    return buffer;
+}
+
+
+std::size_t value_buffers::get_memory_used() const
+{
+    std::size_t memory{ get_vector_memory(all_buffers) + get_vector_memory(retired_buffers)
+        + get_vector_memory(free_buffers) + get_vector_memory(changed_positions) };
+    for (const auto& buffer : all_buffers) {
+        memory += sizeof(published_values) + get_vector_memory(buffer->words) + get_vector_memory(buffer->stale_positions);
+    }
+    return memory;
+}
+
+
+// returns -1 if every slot is taken
+int value_buffers::claim_reader_slot()
+{
+    for (int slot{}; slot < maximum_value_readers; slot++) {
+        bool is_used{ false };
+        if (reader_slots[slot].is_used.compare_exchange_strong(is_used, true)) {
+            number_of_readers.fetch_add(1);
+            return slot;
+        }
+    }
+    return -1;
+}
+
+void value_buffers::release_reader_slot(const int& slot)
+{
+    unpin(slot);
+    reader_slots[slot].is_used.store(false);
+    number_of_readers.fetch_sub(1);
+}
+
+// announces the epoch before reading the published values, so the simulation thread will not
+// reuse whatever is read until the slot is unpinned or pinned again
+const value_buffers::published_values* value_buffers::pin(const int& slot)
+{
+    reader_slots[slot].pinned_epoch.store(global_epoch.load());
+    return current_values.load();
+}
+
+void value_buffers::unpin(const int& slot)
+{
+    reader_slots[slot].pinned_epoch.store(0);
+}
+
+
+value_reader::value_reader(const circuit& target) : source{ &target.get_value_buffers() }, slot{ -1 }, snapshot{ nullptr }
+{
+    slot = source->claim_reader_slot();
+    if (slot == -1) {
+        std::cerr << "\nError: a circuit can only have " << maximum_value_readers << " value readers at once\n";
+    }
+}
+
+value_reader::~value_reader()
+{
+    if (slot != -1) {
+        source->release_reader_slot(slot);
+    }
+}
+
+
+// replaces this reader's snapshot with the values last published by the circuit
+// returns false if there are none yet: values are published after each update once a reader
+// exists, so a new reader may have to wait for the next update (or a call to publish_values)
+bool value_reader::take_snapshot()
+{
+    if (slot == -1) {
+        return false;
+    }
+    snapshot = source->pin(slot);
+    if (snapshot == nullptr) {
+        source->unpin(slot);
+        return false;
+    }
+    return true;
+}
+
+// lets the circuit reuse the snapshot's buffer; readers that hold snapshots for long make it use more memory
+void value_reader::release_snapshot()
+{
+    if (snapshot != nullptr) {
+        source->unpin(slot);
+        snapshot = nullptr;
+    }
+}
+
+
+bool value_reader::get_value(const int& position) const
+{
+    if (snapshot == nullptr || position < 0 || position >= snapshot->number_of_values) {
+        return false;
+    }
+    return ((snapshot->words[position / 64] >> (position % 64)) & 1) != 0;
+}
+
+int value_reader::get_size() const
+{
+    return snapshot == nullptr ? 0 : snapshot->number_of_values;
+}
+
+// publishes happen in increasing version order, so readers can tell whether anything has changed
+std::uint64_t value_reader::get_version() const
+{
+    return snapshot == nullptr ? 0 : snapshot->version;
+}
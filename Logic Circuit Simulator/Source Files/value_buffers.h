@@ -0,0 +1,117 @@
+// value_buffers.h (last modified: 18/10/26)
+// header file for the value_buffers and value_reader class definitions and class member declarations
+// a circuit updates its element values in place, so other threads cannot read them while an input
+// change propagates. instead, after each update the simulation thread copies the values that changed
+// into a spare buffer and publishes it with a single atomic store. value_readers on other threads
+// take snapshots of the latest published buffer without locks or waiting (wait-free), and a buffer is
+// only reused once every reader that might still be looking at it has moved on (epoch-based reclamation)
+
+#ifndef VALUE_BUFFERS_H
+#define VALUE_BUFFERS_H
+
+#include <vector>
+#include <memory>
+#include <atomic>
+#include <functional>
+#include <cstdint>
+#include <cstddef>
+
+
+// largest number of value_readers of one circuit at once
+const int maximum_value_readers{ 64 };
+
+
+class value_buffers
+{
+public:
+    // one published copy of every element's value, one bit per element
+    struct published_values
+    {
+        std::vector<std::uint64_t> words;
+        int number_of_values;
+        std::uint64_t version;
+
+        // epoch from which no new reader can see these values, once they are replaced
+        std::uint64_t retired_epoch;
+
+        // positions changed since this buffer was last written, unless it must be copied in full
+        std::vector<int> stale_positions;
+        bool needs_full_copy;
+    };
+
+private:
+    // each reader's slot holds the epoch it was pinned at while it holds a snapshot, or 0.
+    // slots are padded to separate cache lines, so readers do not slow each other down
+    struct reader_slot
+    {
+        std::atomic<std::uint64_t> pinned_epoch;
+        std::atomic<bool> is_used;
+        char padding[64 - sizeof(std::atomic<std::uint64_t>) - sizeof(std::atomic<bool>)];
+    };
+    reader_slot reader_slots[maximum_value_readers];
+    std::atomic<int> number_of_readers;
+    std::atomic<std::uint64_t> global_epoch;
+    std::atomic<published_values*> current_values;
+
+    // used by the simulation thread only
+    std::vector<std::unique_ptr<published_values>> all_buffers;
+    std::vector<published_values*> retired_buffers;
+    std::vector<published_values*> free_buffers;
+    std::vector<int> changed_positions;
+    bool are_all_changed;
+    bool is_publishing;
+    std::uint64_t next_version;
+
+    published_values* get_spare_buffer();
+    void reclaim_buffers();
+    void retire_values(published_values* replaced);
+
+public:
+    value_buffers();
+    ~value_buffers();
+
+    value_buffers(const value_buffers&) = delete;
+    value_buffers& operator=(const value_buffers&) = delete;
+
+    // simulation thread: changes are only recorded while some reader exists
+    bool is_recording() const;
+    void record_change(const int& position);
+    void mark_all_changed();
+    void publish(const int& number_of_values, const std::function<bool(const int&)>& get_value);
+    std::size_t get_memory_used() const;
+
+    // readers
+    int claim_reader_slot();
+    void release_reader_slot(const int& slot);
+    const published_values* pin(const int& slot);
+    void unpin(const int& slot);
+};
+
+
+class circuit;
+
+// takes snapshots of a circuit's values from another thread; each reading thread needs its own reader.
+// a reader holds one snapshot at a time, and must not outlive the circuit
+class value_reader
+{
+private:
+    value_buffers* source;
+    int slot;
+    const value_buffers::published_values* snapshot;
+
+public:
+    value_reader(const circuit& target);
+    ~value_reader();
+
+    value_reader(const value_reader&) = delete;
+    value_reader& operator=(const value_reader&) = delete;
+
+    bool take_snapshot();
+    void release_snapshot();
+
+    bool get_value(const int& position) const;
+    int get_size() const;
+    std::uint64_t get_version() const;
+};
+
+#endif
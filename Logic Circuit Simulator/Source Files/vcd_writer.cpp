@@ -0,0 +1,313 @@
+// vcd_writer.cpp (last modified: 18/10/26)
+// Contains definition of all vcd_writer class members not defined in vcd_writer.h
+
+#include <iostream>
+#include <fstream>
+#include <vector>
+#include <string>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <ctime>
+#include <cstdint>
+#include <cstddef>
+#include "vcd_writer.h"
+#include "circuit.h"
+#include "bit_matrix.h"
+#include "universal_functions.h"
+#include "tracing.h"
+
+
+// text gathered before it is written to the file
+const std::size_t vcd_buffer_size{ 4 * 1024 * 1024 };
+
+
+vcd_writer::vcd_writer() : vcd_file{}, source{ nullptr }, change_log{},
+    signal_positions{}, signal_indices{}, signal_identifiers{}, dumped_values{},
+    current_time{ 0 }, number_of_value_changes{ 0 },
+    text_buffer{}, writing_buffer{}, background_writer{}, writer_mutex{}, writer_signal{},
+    is_buffer_waiting{ false }, is_stopping{ false }, has_write_failed{ false } {}
+
+vcd_writer::~vcd_writer()
+{
+    close();
+}
+
+
+// starts a dump of the given elements of target (all of them if none are given) at time 0.
+// bus cells and module instances are left out, as their outputs are dumped through their bit selects.
+// the values dumped afterwards are those that changed since the last dump, so target should
+// only be changed through change_input or set_input_values until the writer is closed
+bool vcd_writer::open(const std::string& file_name, circuit& target, const std::vector<int>& element_positions,
+    const bool& use_background_thread)
+{
+    if (is_open()) {
+        std::cerr << "\nError: a waveform is already being written\n";
+        return false;
+    }
+
+    std::vector<int> chosen_positions{ element_positions };
+    if (chosen_positions.empty()) {
+        for (int position{}; position < target.get_circuit_size(); position++) {
+            chosen_positions.push_back(position);
+        }
+    }
+    signal_indices.assign(target.get_circuit_size(), -1);
+    signal_positions.clear();
+
+    for (const int& position : chosen_positions) {
+        if (position < 0 || position >= target.get_circuit_size()) {
+            std::cerr << "\nError: there is no element at position " << position << " to dump\n";
+            return false;
+        }
+        if (is_multi_output_type(target.get_element_gate_type(position)) || signal_indices[position] != -1) {
+            continue;
+        }
+        signal_indices[position] = static_cast<int>(signal_positions.size());
+        signal_positions.push_back(position);
+    }
+
+    vcd_file.clear();
+    vcd_file.open(file_name, std::ios::binary);
+    if (!vcd_file) {
+        std::cerr << "\nError: could not write to '" << file_name << "'\n";
+        return false;
+    }
+
+    // identifiers are short codes made of the printable characters '!' to '~'
+    signal_identifiers.clear();
+    for (size_t signal{}; signal < signal_positions.size(); signal++) {
+        std::string identifier;
+        size_t remaining{ signal };
+        do {
+            identifier.push_back(static_cast<char>('!' + remaining % 94));
+            remaining /= 94;
+        } while (remaining > 0);
+        signal_identifiers.push_back(identifier);
+    }
+
+    source = &target;
+    current_time = 0;
+    number_of_value_changes = 0;
+    has_write_failed = false;
+    text_buffer.clear();
+    text_buffer.reserve(vcd_buffer_size + 4096);
+    write_header("circuit");
+
+    change_log.clear();
+    source->set_change_log(&change_log);
+
+    if (use_background_thread) {
+        is_stopping = false;
+        is_buffer_waiting = false;
+        background_writer = std::thread(&vcd_writer::writer_loop, this);
+    }
+    return true;
+}
+
+
+// declarations of every signal, then their starting values at time 0
+void vcd_writer::write_header(const std::string& module_name)
+{
+    char date[64]{};
+    std::time_t now{ std::time(nullptr) };
+    std::strftime(date, sizeof(date), "%d/%m/%Y %H:%M:%S", std::localtime(&now));
+
+    text_buffer += "$date\n    " + std::string(date) + "\n$end\n"
+        + "$version\n    Logic Circuit Simulator\n$end\n"
+        + "$timescale 1ns $end\n"
+        + "$scope module " + module_name + " $end\n";
+    for (size_t signal{}; signal < signal_positions.size(); signal++) {
+        text_buffer += "$var wire 1 " + signal_identifiers[signal] + " "
+            + source->get_element_name(signal_positions[signal]) + " $end\n";
+    }
+    text_buffer += "$upscope $end\n$enddefinitions $end\n#0\n$dumpvars\n";
+
+    dumped_values.clear();
+    for (size_t signal{}; signal < signal_positions.size(); signal++) {
+        bool value{ source->get_element_output(signal_positions[signal]) };
+        dumped_values.push_back(value);
+        add_value(static_cast<int>(signal), value);
+    }
+    text_buffer += "$end\n";
+}
+
+
+void vcd_writer::add_time(const std::uint64_t& time)
+{
+    char digits[24];
+    int length{};
+    std::uint64_t remaining{ time };
+    do {
+        digits[length++] = static_cast<char>('0' + remaining % 10);
+        remaining /= 10;
+    } while (remaining > 0);
+
+    text_buffer.push_back('#');
+    while (length > 0) {
+        text_buffer.push_back(digits[--length]);
+    }
+    text_buffer.push_back('\n');
+}
+
+void vcd_writer::add_value(const int& signal, const bool& value)
+{
+    text_buffer.push_back(value ? '1' : '0');
+    text_buffer += signal_identifiers[signal];
+    text_buffer.push_back('\n');
+}
+
+
+// writes the values of dumped signals that changed since the last dump, at the given time
+// times cannot go back; a dump at the same time as the last one adds to it
+void vcd_writer::dump(const std::uint64_t& time)
+{
+    if (!is_open()) {
+        return;
+    }
+    if (time < current_time) {
+        std::cerr << "\nError: waveform time " << time << " is before the last time dumped (" << current_time << ")\n";
+        return;
+    }
+
+    for (const int& position : change_log) {
+        if (position >= static_cast<int>(signal_indices.size()) || signal_indices[position] == -1) {
+            continue;
+        }
+        int signal{ signal_indices[position] };
+        char value{ source->get_element_output(position) };
+
+        if (value != dumped_values[signal]) {
+            if (time != current_time) {
+                add_time(time);
+                current_time = time;
+            }
+            dumped_values[signal] = value;
+            add_value(signal, value != 0);
+            number_of_value_changes++;
+        }
+    }
+    change_log.clear();
+
+    if (text_buffer.size() >= vcd_buffer_size) {
+        flush_buffer();
+    }
+}
+
+
+// applies each column of input_vectors (one row per input, in get_input_positions() order) in turn,
+// changing only the inputs that differ from the previous column, and dumps after each one
+void vcd_writer::dump_input_vectors(const bit_matrix& input_vectors, const std::uint64_t& first_time,
+    const std::uint64_t& time_step)
+{
+    if (!is_open()) {
+        return;
+    }
+    TRACE_SCOPE("dump_input_vectors");
+    std::vector<int> input_positions{ source->get_input_positions() };
+    if (input_vectors.get_number_of_rows() != static_cast<int>(input_positions.size())) {
+        std::cerr << "\nError: the input vectors have " << input_vectors.get_number_of_rows()
+            << " rows but the circuit has " << input_positions.size() << " inputs\n";
+        return;
+    }
+
+    for (int column{}; column < input_vectors.get_number_of_columns(); column++) {
+        for (size_t i{}; i < input_positions.size(); i++) {
+            if (input_vectors.get_bit(static_cast<int>(i), column) != source->get_element_output(input_positions[i])) {
+                source->change_input(input_positions[i]);
+            }
+        }
+        dump(first_time + column * time_step);
+    }
+}
+
+
+// hands the gathered text to the background thread once it has finished the last buffer,
+// or writes it straight away without one
+void vcd_writer::flush_buffer()
+{
+    if (!background_writer.joinable()) {
+        vcd_file.write(text_buffer.data(), text_buffer.size());
+        has_write_failed = has_write_failed || !vcd_file;
+        text_buffer.clear();
+        return;
+    }
+
+    std::unique_lock<std::mutex> lock(writer_mutex);
+    writer_signal.wait(lock, [this]() { return !is_buffer_waiting; });
+    text_buffer.swap(writing_buffer);
+    is_buffer_waiting = true;
+    writer_signal.notify_all();
+    lock.unlock();
+    text_buffer.clear();
+}
+
+// writes each buffer handed over by flush_buffer, until close asks it to stop
+void vcd_writer::writer_loop()
+{
+    std::unique_lock<std::mutex> lock(writer_mutex);
+    while (true) {
+        writer_signal.wait(lock, [this]() { return is_buffer_waiting || is_stopping; });
+        if (!is_buffer_waiting) {
+            return;
+        }
+
+        lock.unlock();
+        TRACE_SCOPE("write_waveform");
+        vcd_file.write(writing_buffer.data(), writing_buffer.size());
+        bool has_failed{ !vcd_file };
+        writing_buffer.clear();
+        lock.lock();
+
+        has_write_failed = has_write_failed || has_failed;
+        is_buffer_waiting = false;
+        writer_signal.notify_all();
+    }
+}
+
+
+// writes out everything left and stops using the circuit's change log
+// returns false if any of the file could not be written
+bool vcd_writer::close()
+{
+    if (!is_open()) {
+        return true;
+    }
+    flush_buffer();
+
+    if (background_writer.joinable()) {
+        {
+            std::lock_guard<std::mutex> lock(writer_mutex);
+            is_stopping = true;
+        }
+        writer_signal.notify_all();
+        background_writer.join();
+    }
+
+    vcd_file.close();
+    has_write_failed = has_write_failed || !vcd_file;
+    source->set_change_log(nullptr);
+    source = nullptr;
+    change_log.clear();
+
+    if (has_write_failed) {
+        std::cerr << "\nError: the waveform file could not be completely written\n";
+    }
+    return !has_write_failed;
+}
+
+
+bool vcd_writer::is_open() const
+{
+    return source != nullptr;
+}
+
+std::uint64_t vcd_writer::get_current_time() const
+{
+    return current_time;
+}
+
+std::uint64_t vcd_writer::get_number_of_value_changes() const
+{
+    return number_of_value_changes;
+}
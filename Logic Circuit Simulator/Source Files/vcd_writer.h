@@ -0,0 +1,74 @@
+// vcd_writer.h (last modified: 18/10/26)
+// header file for the vcd_writer class definition and class member declarations
+// a vcd_writer records how a circuit's signals change over time as an IEEE 1364 value change dump (VCD),
+// which waveform viewers such as GTKWave can show. it reads the circuit's change log rather than
+// every signal, so each dump only costs as much as the number of signals that changed.
+// text is gathered in a large buffer, which can be written out by a background thread
+
+#ifndef VCD_WRITER_H
+#define VCD_WRITER_H
+
+#include <vector>
+#include <string>
+#include <fstream>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <cstdint>
+#include <cstddef>
+#include "circuit.h"
+#include "bit_matrix.h"
+
+
+class vcd_writer
+{
+private:
+    std::ofstream vcd_file;
+    circuit* source;
+    std::vector<int> change_log;
+
+    // dumped signals: signal_indices maps element positions to signal indices (-1 if not dumped)
+    std::vector<int> signal_positions;
+    std::vector<int> signal_indices;
+    std::vector<std::string> signal_identifiers;
+    std::vector<char> dumped_values;
+    std::uint64_t current_time;
+    std::uint64_t number_of_value_changes;
+
+    // text waiting to be written. with a background thread, a full buffer is swapped into
+    // writing_buffer and written while the simulation carries on filling text_buffer
+    std::string text_buffer;
+    std::string writing_buffer;
+    std::thread background_writer;
+    std::mutex writer_mutex;
+    std::condition_variable writer_signal;
+    bool is_buffer_waiting;
+    bool is_stopping;
+    bool has_write_failed;
+
+    void write_header(const std::string& module_name);
+    void add_time(const std::uint64_t& time);
+    void add_value(const int& signal, const bool& value);
+    void flush_buffer();
+    void writer_loop();
+
+public:
+    vcd_writer();
+    ~vcd_writer();
+
+    vcd_writer(const vcd_writer&) = delete;
+    vcd_writer& operator=(const vcd_writer&) = delete;
+
+    bool open(const std::string& file_name, circuit& target, const std::vector<int>& element_positions = {},
+        const bool& use_background_thread = false);
+    void dump(const std::uint64_t& time);
+    void dump_input_vectors(const bit_matrix& input_vectors, const std::uint64_t& first_time,
+        const std::uint64_t& time_step);
+    bool close();
+
+    bool is_open() const;
+    std::uint64_t get_current_time() const;
+    std::uint64_t get_number_of_value_changes() const;
+};
+
+#endif